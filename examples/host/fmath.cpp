@@ -0,0 +1,101 @@
+// compare exact (fs_math) and fast approximations against libm
+// prints max error and the time per call for every function
+
+#include <rpnlib.h>
+
+extern "C" {
+    #include "fs_math.h"
+}
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+struct function_type {
+    const char* name;
+    rpn_float (*libm)(rpn_float);
+    rpn_float (*exact)(rpn_float);
+    rpn_float (*fast)(rpn_float);
+    rpn_float lower;
+    rpn_float upper;
+    bool relative;
+};
+
+using callback_type = rpn_float (*)(rpn_float);
+
+constexpr size_t Samples = 1000000;
+
+// volatile sink, so the compiler does not remove the calls
+volatile rpn_float sink;
+
+double measure(const std::vector<rpn_float>& inputs, callback_type callback) {
+    auto start = std::chrono::steady_clock::now();
+    for (auto input : inputs) {
+        sink = callback(input);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / inputs.size();
+}
+
+double max_error(const std::vector<rpn_float>& inputs, callback_type expected, callback_type callback, bool relative) {
+    double result = 0.0;
+    for (auto input : inputs) {
+        double value = expected(input);
+        double error = std::fabs(callback(input) - value);
+        if (relative) {
+            error /= std::fmax(1.0, std::fabs(value));
+        }
+        result = std::fmax(result, error);
+    }
+
+    return result;
+}
+
+int main() {
+    const function_type functions[] {
+        {"sin", [](rpn_float x) -> rpn_float { return std::sin(x); },
+            [](rpn_float x) -> rpn_float { return fs_cos(x - 1.57079632679489661923); },
+            rpn_fmath_fast_sin, -1e5, 1e5, false},
+        {"cos", [](rpn_float x) -> rpn_float { return std::cos(x); },
+            [](rpn_float x) -> rpn_float { return fs_cos(x); },
+            rpn_fmath_fast_cos, -1e5, 1e5, false},
+        {"exp", [](rpn_float x) -> rpn_float { return std::exp(x); },
+            [](rpn_float x) -> rpn_float { return fs_exp(x); },
+            rpn_fmath_fast_exp, -700.0, 700.0, true},
+        {"log", [](rpn_float x) -> rpn_float { return std::log(x); },
+            [](rpn_float x) -> rpn_float { return fs_log(x); },
+            rpn_fmath_fast_log, 1e-3, 1e6, false},
+        {"log10", [](rpn_float x) -> rpn_float { return std::log10(x); },
+            [](rpn_float x) -> rpn_float { return fs_log10(x); },
+            rpn_fmath_fast_log10, 1e-3, 1e6, false},
+        {"pow(x, 2.5)", [](rpn_float x) -> rpn_float { return std::pow(x, 2.5); },
+            [](rpn_float x) -> rpn_float { return fs_pow(x, 2.5); },
+            [](rpn_float x) -> rpn_float { return rpn_fmath_fast_pow(x, 2.5); },
+            0.01, 100.0, true},
+    };
+
+    std::printf("%-12s %14s %14s %12s %12s %12s\n",
+        "function", "exact error", "fast error", "libm ns", "exact ns", "fast ns");
+
+    std::vector<rpn_float> inputs;
+    inputs.reserve(Samples);
+
+    for (const auto& function : functions) {
+        inputs.clear();
+        for (size_t index = 0; index < Samples; ++index) {
+            inputs.push_back(function.lower + (function.upper - function.lower) * index / (Samples - 1));
+        }
+
+        std::printf("%-12s %14g %14g %12.2f %12.2f %12.2f\n",
+            function.name,
+            max_error(inputs, function.libm, function.exact, function.relative),
+            max_error(inputs, function.libm, function.fast, function.relative),
+            measure(inputs, function.libm),
+            measure(inputs, function.exact),
+            measure(inputs, function.fast));
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+// time spent copying value handles between the stack and the variables
+// build twice, with and without -DRPNLIB_INTRUSIVE_REFCOUNT=1, and compare the output
+
+#include <rpnlib.h>
+
+#include <chrono>
+#include <cstdio>
+
+struct expression_type {
+    const char* name;
+    const char* text;
+};
+
+constexpr size_t Iterations = 100000;
+
+double measure(rpn_context& ctxt, const char* expression) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t index = 0; index < Iterations; ++index) {
+        rpn_process(ctxt, expression);
+        rpn_stack_clear(ctxt);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+}
+
+int main() {
+    const expression_type expressions[] {
+        {"dup / drop", "1 dup dup dup dup drop drop drop drop"},
+        {"swap / over", "1 2 swap over swap over drop drop drop drop"},
+        {"variables", "$a $b $c $a $b $c"},
+        {"references", "&a &b &c &a &b &c"},
+        {"assignment", "$a &b = $b &c = $c &a ="},
+    };
+
+    rpn_context ctxt;
+    rpn_init(ctxt);
+    rpn_variable_set(ctxt, "a", rpn_value(1.0));
+    rpn_variable_set(ctxt, "b", rpn_value(2.0));
+    rpn_variable_set(ctxt, "c", rpn_value(3.0));
+
+    std::printf("refcount: %s\n", RPNLIB_INTRUSIVE_REFCOUNT ? "intrusive" : "std::shared_ptr");
+    std::printf("%-12s %12s\n", "expression", "ns");
+
+    for (const auto& expression : expressions) {
+        std::printf("%-12s %12.2f\n", expression.name, measure(ctxt, expression.text));
+    }
+
+    rpn_clear(ctxt);
+
+    return 0;
+}
@@ -33,9 +33,18 @@ void dump_value(const rpn_value& val) {
         case rpn_value::Type::Float:
             std::cout << val.toFloat() << " (Float) ";
             break;
+        case rpn_value::Type::Fixed:
+            std::cout << val.toString().c_str() << " (Fixed) ";
+            break;
         case rpn_value::Type::String:
             std::cout << val.toString().c_str() << " (String) ";
             break;
+        case rpn_value::Type::Series:
+            std::cout << val.toString().c_str() << " (Series) ";
+            break;
+        case rpn_value::Type::Sketch:
+            std::cout << val.toString().c_str() << " (Sketch) ";
+            break;
         case rpn_value::Type::Error:
             std::cout << "error ";
             break;
@@ -81,39 +81,26 @@ void setup() {
         rpn_stack_push(ctxt, result);
         return 0;
     });
-    rpn_operator_set(ctxt, "dow", 1, [](rpn_context & ctxt) -> rpn_error {
-        rpn_value value;
-        rpn_stack_pop(ctxt, value);
-        time_t ts = value.toInt();
+    // Same callback is shared between operators, user data pointer selects the `tm` field
+    auto tm_field = [](void* data, const rpn_operator_args& args, rpn_value& out) -> rpn_error {
+        time_t ts = args[0].toInt();
 
         struct tm tm_from_ts;
         localtime_r(&ts, &tm_from_ts);
 
-        rpn_value result { rpn_int(tm_from_ts.tm_wday) };
-        rpn_stack_push(ctxt, result);
+        auto field = *reinterpret_cast<int tm::**>(data);
+        out = rpn_value { rpn_int(tm_from_ts.*field) };
 
         return 0;
-    });
-    rpn_operator_set(ctxt, "hour", 1, [](rpn_context & ctxt) -> rpn_error {
-        rpn_value value;
-        rpn_stack_pop(ctxt, value);
-        time_t ts = value.toInt();
-        struct tm tm_from_ts;
-        localtime_r(&ts, &tm_from_ts);
-        rpn_value result { rpn_int(tm_from_ts.tm_hour) };
-        rpn_stack_push(ctxt, result);
-        return 0;
-    });
-    rpn_operator_set(ctxt, "minute", 1, [](rpn_context & ctxt) -> rpn_error {
-        rpn_value value;
-        rpn_stack_pop(ctxt, value);
-        time_t ts = value.toInt();
-        struct tm tm_from_ts;
-        localtime_r(&ts, &tm_from_ts);
-        rpn_value result { rpn_int(tm_from_ts.tm_min) };
-        rpn_stack_push(ctxt, result);
-        return 0;
-    });
+    };
+
+    static int tm::* tm_wday = &tm::tm_wday;
+    static int tm::* tm_hour = &tm::tm_hour;
+    static int tm::* tm_min = &tm::tm_min;
+
+    rpn_operator_set(ctxt, "dow", 1, tm_field, &tm_wday);
+    rpn_operator_set(ctxt, "hour", 1, tm_field, &tm_hour);
+    rpn_operator_set(ctxt, "minute", 1, tm_field, &tm_min);
 
     rpn_variable_set(ctxt, F("time"),
         rpn_value(static_cast<rpn_int>(time(nullptr)))
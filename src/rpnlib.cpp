@@ -25,11 +25,16 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #include "rpnlib_value.h"
 #include "rpnlib_variable.h"
 #include "rpnlib_operators.h"
+#include "rpnlib_word.h"
 
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <cctype>
@@ -96,11 +101,6 @@ void rpn_error::reset() {
 // ----------------------------------------------------------------------------
 
 // TODO: consider using code generation for parser?
-// TODO: provide a way to define operators in expressions
-//       e.g.
-//       - by preserving type<->token pairs instead of passing them into the tokenizer handler
-//       - by having a separate branch which fully parses everything, but instead of updating stack or calling operators preserves
-//         operations order, which later will be replayed
 
 rpn_input_buffer& rpn_input_buffer::operator+=(char c) {
     if (((_length + 1) >= Size) || _overflow) {
@@ -152,6 +152,59 @@ bool _rpn_token_as_bool(const char* token) {
     return (strcmp(token, "true") == 0);
 }
 
+// Fixed-point tokens are converted without using floating point, up to 9 fractional digits are significant.
+// Expecting [+-]digits[.digits]q, returns `false` when the value does not fit
+bool _rpn_token_as_fixed(const char* token, rpn_fixed& out) {
+    using wide_type = rpn_fixed::wide_type;
+
+    bool negative = false;
+    if ((*token == '-') || (*token == '+')) {
+        negative = (*token == '-');
+        ++token;
+    }
+
+    bool digits = false;
+
+    wide_type integer = 0;
+    while (isdigit(*token)) {
+        integer = (integer * 10) + (*token - '0');
+        if (integer > ((rpn_fixed::Max / rpn_fixed::One) + 1)) {
+            return false;
+        }
+        digits = true;
+        ++token;
+    }
+
+    wide_type fraction = 0;
+    wide_type scale = 1;
+    if (*token == '.') {
+        ++token;
+        for (int index = 0; isdigit(*token); ++index, ++token) {
+            if (index < 9) {
+                fraction = (fraction * 10) + (*token - '0');
+                scale *= 10;
+            }
+            digits = true;
+        }
+    }
+
+    if (!digits || (*token != 'q') || (*(token + 1) != '\0')) {
+        return false;
+    }
+
+    wide_type raw = (integer * rpn_fixed::One) + ((fraction * rpn_fixed::One) + (scale / 2)) / scale;
+    if (negative) {
+        raw = -raw;
+    }
+
+    if ((raw < rpn_fixed::Min) || (raw > rpn_fixed::Max)) {
+        return false;
+    }
+
+    out = rpn_fixed::fromRaw(static_cast<rpn_fixed::raw_type>(raw));
+    return true;
+}
+
 // note that isspace in posix terms does not only mean literal ' ' space character. excerpt from isalpha(3):
 // > These functions check whether c, which must have the value of an unsigned char or EOF, falls into a certain character class according to  the  specified  locale.
 // > ...
@@ -193,6 +246,7 @@ enum class Token {
     Integer,
     Unsigned,
     Float,
+    Fixed,
     String,
     VariableReference,
     VariableValue,
@@ -338,6 +392,7 @@ on_stack_change:
 // Generic number matching
 // - anything with a single dot, e / E digits - pass along as float
 // - anything without dots could be integer or unsgined, depending on a single letter suffix
+// - both could be fixed-point, when using `q` suffix
 //
 // TODO:
 // - we don't support matching anything but the base10. allow prefix with integers?
@@ -370,9 +425,11 @@ on_number:
                 goto on_number_float;
             case 'i':
             case 'u':
+            case 'q':
                 if (_rpn_end_of_token(*(p + 1))) {
                     type = (*p == 'i') ? Token::Integer :
                            (*p == 'u') ? Token::Unsigned :
+                           (*p == 'q') ? Token::Fixed :
                            Token::Error;
                     ++p;
                     goto push_word;
@@ -388,13 +445,20 @@ on_number:
     goto push_word;
 
 // we have encountered floating point dot
-// only allow digits, exponent or end-of-token after this point
+// only allow digits, exponent, fixed-point suffix or end-of-token after this point
 
 on_number_float:
 
     while (!_rpn_end_of_token(*p)) {
         if (!isdigit(*p)) {
             switch (*p) {
+            case 'q':
+                if (_rpn_end_of_token(*(p + 1))) {
+                    type = Token::Fixed;
+                    ++p;
+                    goto push_word;
+                }
+                goto on_word;
             case 'e':
             case 'E':
                 ++p;
@@ -556,122 +620,873 @@ stop_parsing:
 
 }
 
-} // namespace anonymous
+bool _rpn_word_is(const char* name, const char* word) {
+    return (strcmp(name, word) == 0);
+}
 
-// ----------------------------------------------------------------------------
-// Main methods
-// ----------------------------------------------------------------------------
+// Words reserved for conditional blocks and word definitions
+bool _rpn_word_reserved(const char* name) {
+    return _rpn_word_is(name, "if")
+        || _rpn_word_is(name, "else")
+        || _rpn_word_is(name, "then")
+        || _rpn_word_is(name, ":")
+        || _rpn_word_is(name, ";");
+}
 
-bool rpn_process(rpn_context & ctxt, const char * input, bool variable_must_exist) {
+// Forth-like conditional blocks: `<condition> if <true branch> [else <false branch>] then`
+// Unlike `ifn`, which needs both branches to be already evaluated, untaken branch tokens are never placed on the stack or called.
+// While skipping, we only track the nested `if` and `then` words to find out where the current block ends.
+struct rpn_conditionals {
+    bool skipping() const {
+        return skip > 0;
+    }
 
-    ctxt.error.reset();
-    ctxt.input_buffer.reset();
+    bool balanced() const {
+        return blocks.empty();
+    }
 
-    auto position = _rpn_tokenize(input, ctxt.input_buffer, [&](Token type, const rpn_input_buffer& token) {
+    // every open block, set to `true` after we had seen its `else`
+    std::vector<bool> blocks;
 
-        //printf(":token \"%s\" type %d\n", token.c_str(), static_cast<int>(type));
-        if (!token.ok()) {
-            ctxt.error = rpn_processing_error::InputBufferOverflow;
+    // number of nested blocks inside of the untaken branch, 0 when not skipping anything
+    size_t skip { 0 };
+};
+
+// returns `false` when the block has more than one `else`
+bool _rpn_conditionals_skip(rpn_conditionals& conditionals, const char* word) {
+    if (_rpn_word_is(word, "if")) {
+        ++conditionals.skip;
+    } else if (_rpn_word_is(word, "then")) {
+        if (0 == --conditionals.skip) {
+            conditionals.blocks.pop_back();
+        }
+    } else if ((1 == conditionals.skip) && _rpn_word_is(word, "else")) {
+        if (conditionals.blocks.back()) {
             return false;
         }
+        conditionals.blocks.back() = true;
+        conditionals.skip = 0;
+    }
 
-        // Is token a null, bool, number, string or a variable?
-        switch (type) {
+    return true;
+}
 
-        case Token::Null:
-            ctxt.stack.get().emplace_back(std::make_shared<rpn_value>());
+// word body must only contain complete conditional blocks
+bool _rpn_conditionals_balanced(const rpn_word::body_type& body) {
+    std::vector<bool> blocks;
+
+    for (auto& instruction : body) {
+        if (instruction.type != rpn_instruction::Type::Word) {
+            continue;
+        }
+
+        const char* word = instruction.name.c_str();
+        if (_rpn_word_is(word, "if")) {
+            blocks.push_back(false);
+        } else if (_rpn_word_is(word, "else")) {
+            if (blocks.empty() || blocks.back()) {
+                return false;
+            }
+            blocks.back() = true;
+        } else if (_rpn_word_is(word, "then")) {
+            if (blocks.empty()) {
+                return false;
+            }
+            blocks.pop_back();
+        }
+    }
+
+    return blocks.empty();
+}
+
+// Literal tokens are converted into the value right away, both when placing them on the stack and when compiling them into the word.
+// Returns `false` when the token is not a literal or when the conversion fails
+bool _rpn_token_value(rpn_context& ctxt, Token type, const rpn_input_buffer& token, rpn_value& out) {
+    const auto precision = ctxt.precision;
+
+    switch (type) {
+
+    case Token::Null:
+        out = rpn_value();
+        return true;
+
+    case Token::Boolean:
+        out = rpn_value(_rpn_token_as_bool(token.c_str()));
+        return true;
+
+    // Integer tokens contain either `i` or `u` at the end, which conversion function should ignore
+    case Token::Integer: {
+        char* endptr = nullptr;
+        rpn_int value = strtol(token.c_str(), &endptr, 10);
+        if (endptr && (endptr != token.c_str()) && endptr[0] == 'i') {
+            out = rpn_value(value);
             return true;
+        }
+        break;
+    }
 
-        case Token::Boolean:
-            ctxt.stack.get().emplace_back(std::make_shared<rpn_value>(
-                _rpn_token_as_bool(token.c_str())
-            ));
+    case Token::Unsigned: {
+        char* endptr = nullptr;
+        rpn_uint value = strtoul(token.c_str(), &endptr, 10);
+        if (endptr && (endptr != token.c_str()) && endptr[0] == 'u') {
+            out = rpn_value(value);
             return true;
+        }
+        break;
+    }
 
-        // Integer tokens contain either `i` or `u` at the end, which conversion function should ignore
-        case Token::Integer: {
-            char* endptr = nullptr;
-            rpn_int value = strtol(token.c_str(), &endptr, 10);
-            if (endptr && (endptr != token.c_str()) && endptr[0] == 'i') {
-                ctxt.stack.get().emplace_back(std::make_shared<rpn_value>(value));
-                return true;
+    // Floating point does not contain any surprises, just try to parse it normally
+    // Single precision contexts round the value to the nearest `float`
+    case Token::Float: {
+        char* endptr = nullptr;
+        rpn_float value = (rpn_float_precision::Single == precision)
+            ? static_cast<rpn_float>(strtof(token.c_str(), &endptr))
+            : static_cast<rpn_float>(strtod(token.c_str(), &endptr));
+        if (endptr && endptr != token.c_str() && endptr[0] == '\0') {
+            out = rpn_value(value);
+            return true;
+        }
+        break;
+    }
+
+    case Token::Fixed: {
+        rpn_fixed value;
+        if (_rpn_token_as_fixed(token.c_str(), value)) {
+            out = rpn_value(value);
+            return true;
+        }
+        break;
+    }
+
+    case Token::String:
+        out = rpn_string_pool_value(ctxt.strings, token.c_str(), token.length());
+        return true;
+
+    case Token::Unknown:
+    case Token::Error:
+    case Token::Word:
+    case Token::VariableReference:
+    case Token::VariableValue:
+    case Token::StackPush:
+    case Token::StackPop:
+        break;
+
+    }
+
+    return false;
+}
+
+// Instead of placing the token on the stack or calling the operator, preserve it in the word body
+bool _rpn_compile_token(rpn_context& ctxt, Token type, const rpn_input_buffer& token, rpn_word::body_type& body, rpn_error& error) {
+    switch (type) {
+
+    case Token::Null:
+    case Token::Boolean:
+    case Token::Integer:
+    case Token::Unsigned:
+    case Token::Float:
+    case Token::Fixed:
+    case Token::String: {
+        rpn_value value;
+        if (_rpn_token_value(ctxt, type, token, value)) {
+            body.emplace_back(rpn_instruction::Type::Value, std::move(value));
+            return true;
+        }
+        break;
+    }
+
+    case Token::VariableValue:
+    case Token::VariableReference:
+        if (!token.length()) {
+            error = rpn_processing_error::UnknownToken;
+            return false;
+        }
+        body.emplace_back(
+            (Token::VariableValue == type)
+                ? rpn_instruction::Type::VariableValue
+                : rpn_instruction::Type::VariableReference,
+            token.c_str());
+        return true;
+
+    case Token::StackPush:
+        body.emplace_back(rpn_instruction::Type::StackPush);
+        return true;
+
+    case Token::StackPop:
+        body.emplace_back(rpn_instruction::Type::StackPop);
+        return true;
+
+    // Definitions cannot be nested
+    case Token::Word:
+        if (_rpn_word_is(token.c_str(), ":")) {
+            error = rpn_processing_error::InvalidDefinition;
+            return false;
+        }
+        body.emplace_back(rpn_instruction::Type::Word, token.c_str());
+        return true;
+
+    case Token::Unknown:
+        error = rpn_processing_error::UnknownToken;
+        return false;
+
+    case Token::Error:
+        error = rpn_processing_error::InvalidToken;
+        return false;
+
+    }
+
+    error = rpn_processing_error::TokenNotHandled;
+    return false;
+}
+
+void _rpn_word_store(rpn_context& ctxt, String&& name, rpn_word::body_type&& body) {
+    for (auto& word : ctxt.words) {
+        if (word.name == name) {
+            word.body = std::move(body);
+            return;
+        }
+    }
+
+    ctxt.words.emplace_front(std::move(name), std::move(body));
+}
+
+// `: name ... ;` spans multiple tokens, track what we expect to see next
+struct rpn_definition {
+    enum class State {
+        None,
+        Name,
+        Body
+    };
+
+    void reset() {
+        state = State::None;
+        name = "";
+        body.clear();
+    }
+
+    State state { State::None };
+    String name;
+    rpn_word::body_type body;
+};
+
+bool _rpn_define(rpn_context& ctxt, rpn_definition& definition, Token type, const rpn_input_buffer& token) {
+    switch (definition.state) {
+
+    case rpn_definition::State::Name:
+        if ((Token::Word != type) || _rpn_word_reserved(token.c_str())) {
+            ctxt.error = rpn_processing_error::InvalidDefinition;
+            return false;
+        }
+        definition.name = token.c_str();
+        definition.state = rpn_definition::State::Body;
+        return true;
+
+    case rpn_definition::State::Body:
+        if ((Token::Word == type) && _rpn_word_is(token.c_str(), ";")) {
+            if (!_rpn_conditionals_balanced(definition.body)) {
+                ctxt.error = rpn_processing_error::UnbalancedBlock;
+                return false;
             }
-            break;
+            _rpn_word_store(ctxt, std::move(definition.name), std::move(definition.body));
+            definition.reset();
+            return true;
         }
+        return _rpn_compile_token(ctxt, type, token, definition.body, ctxt.error);
 
-        case Token::Unsigned: {
-            char* endptr = nullptr;
-            rpn_uint value = strtoul(token.c_str(), &endptr, 10);
-            if (endptr && (endptr != token.c_str()) && endptr[0] == 'u') {
-                ctxt.stack.get().emplace_back(std::make_shared<rpn_value>(value));
-                return true;
+    case rpn_definition::State::None:
+        break;
+
+    }
+
+    ctxt.error = rpn_processing_error::TokenNotHandled;
+    return false;
+}
+
+// Names that are not found in the context are looked up in its parent, see rpn_parent()
+template <typename List, typename Value = typename List::value_type>
+const Value* _rpn_find(const rpn_context& ctxt, List rpn_context::* list, const char* name) {
+    for (auto* current = &ctxt; current; current = current->parent) {
+        auto& values = current->*list;
+        auto result = std::find_if(values.cbegin(), values.cend(), [name](const Value& value) {
+            return value.name.equals(name);
+        });
+
+        if (result != values.cend()) {
+            return &(*result);
+        }
+    }
+
+    return nullptr;
+}
+
+// Common state of the expression and the word bodies called from it
+struct rpn_processor {
+    rpn_processor(rpn_context& ctxt, bool variable_must_exist) :
+        ctxt(ctxt),
+        variable_must_exist(variable_must_exist)
+    {}
+
+    rpn_context& ctxt;
+    bool variable_must_exist;
+
+    // current number of nested word calls
+    size_t depth { 0 };
+};
+
+bool _rpn_push_variable(rpn_processor& processor, bool reference, const char* name) {
+    auto& ctxt = processor.ctxt;
+
+    // values of the parent variables can be read, but only the variables of this context can be referenced
+    if (reference) {
+        auto var = std::find_if(ctxt.variables.cbegin(), ctxt.variables.cend(), [name](const rpn_variable& v) {
+            return v.name.equals(name);
+        });
+        if (var != ctxt.variables.end()) {
+            ctxt.stack.get().emplace_back(rpn_stack_value::Type::Variable, (*var).value);
+            return true;
+        }
+    } else {
+        auto* var = _rpn_find(ctxt, &rpn_context::variables, name);
+        if (var) {
+            ctxt.stack.get().emplace_back(*var->value);
+            return true;
+        }
+
+        rpn_value value;
+        if (rpn_variable_store_get(ctxt, name, value)) {
+            ctxt.stack.get().emplace_back(std::move(value));
+            return true;
+        }
+    }
+
+    // in case we want value / explicitly said to check for variable existence
+    if (!reference || processor.variable_must_exist) {
+        ctxt.error = rpn_processing_error::VariableDoesNotExist;
+        return false;
+    }
+
+    // since we don't have the variable yet, push uninitialized one
+    auto null = rpn_make_value();
+    ctxt.variables.emplace_front(name, null);
+    ctxt.stack.get().emplace_back(
+        rpn_stack_value::Type::Variable, null
+    );
+
+    return true;
+}
+
+bool _rpn_stack_change(rpn_context& ctxt, bool push) {
+    if (push) {
+        ctxt.stack.stacks_push();
+        return true;
+    }
+
+    if (ctxt.stack.stacks_size() > 1) {
+        ctxt.stack.stacks_merge();
+        return true;
+    }
+
+    ctxt.error = rpn_processing_error::NoMoreStacks;
+    return false;
+}
+
+bool _rpn_call(rpn_processor&, rpn_conditionals&, const char*);
+
+// Replay pre-parsed instructions, using the same handlers as the tokenizer
+bool _rpn_execute(rpn_processor& processor, const rpn_word::body_type& body) {
+    auto& ctxt = processor.ctxt;
+
+    rpn_conditionals conditionals;
+
+    for (auto& instruction : body) {
+        if (conditionals.skipping()) {
+            if (rpn_instruction::Type::Word == instruction.type) {
+                _rpn_conditionals_skip(conditionals, instruction.name.c_str());
             }
+            continue;
+        }
+
+        bool result = false;
+
+        switch (instruction.type) {
+        case rpn_instruction::Type::Value:
+            ctxt.stack.get().emplace_back(instruction.value);
+            result = true;
+            break;
+        case rpn_instruction::Type::VariableValue:
+            result = _rpn_push_variable(processor, false, instruction.name.c_str());
+            break;
+        case rpn_instruction::Type::VariableReference:
+            result = _rpn_push_variable(processor, true, instruction.name.c_str());
+            break;
+        case rpn_instruction::Type::StackPush:
+            result = _rpn_stack_change(ctxt, true);
+            break;
+        case rpn_instruction::Type::StackPop:
+            result = _rpn_stack_change(ctxt, false);
+            break;
+        case rpn_instruction::Type::Word:
+            result = _rpn_call(processor, conditionals, instruction.name.c_str());
             break;
         }
 
-        // Floating point does not contain any surprises, just try to parse it normally
-        case Token::Float: {
-            char* endptr = nullptr;
-            rpn_float value = strtod(token.c_str(), &endptr);
-            if (endptr && endptr != token.c_str() && endptr[0] == '\0') {
-                ctxt.stack.get().emplace_back(std::make_shared<rpn_value>(value));
-                return true;
+        if (!result) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Single precision contexts keep every floating point result of the operator rounded to the nearest `float`.
+// Only the slots the operator could have replaced or pushed are checked. Values may be shared with the variables,
+// so the slot receives a new value instead of modifying the existing one
+void _rpn_single_results(rpn_context& ctxt, size_t from) {
+    if (std::is_same<rpn_float, float>::value) {
+        return;
+    }
+
+    auto& stack = ctxt.stack.get();
+    for (size_t index = from; index < stack.size(); ++index) {
+        const auto& slot = stack.at(index);
+        if ((slot.type != rpn_stack_value::Type::Value) || !slot.value->isFloat()) {
+            continue;
+        }
+
+        const rpn_float value = slot.value->toFloat();
+        const rpn_float rounded = static_cast<rpn_float>(static_cast<float>(value));
+        if ((rounded != value) && !std::isnan(value)) {
+            stack[index] = rpn_stack_value(rpn_value(rounded));
+        }
+    }
+}
+
+// Everything else that did not go through the token matching
+// Conditional block words are reserved and cannot be overriden. Otherwise, user-defined words are looked up first, then operators
+bool _rpn_call(rpn_processor& processor, rpn_conditionals& conditionals, const char* name) {
+    auto& ctxt = processor.ctxt;
+
+    if (_rpn_word_is(name, "if")) {
+        auto& stack = ctxt.stack.get();
+        if (!stack.size()) {
+            ctxt.error = rpn_operator_error::ArgumentCountMismatch;
+            return false;
+        }
+
+        const bool condition = stack.back().value->toBoolean();
+        stack.pop_back();
+
+        conditionals.blocks.push_back(false);
+        if (!condition) {
+            conditionals.skip = 1;
+        }
+
+        return true;
+    }
+
+    // Reaching `else` means we were executing the `if` branch, so the rest of the block is skipped
+    if (_rpn_word_is(name, "else")) {
+        if (conditionals.balanced() || conditionals.blocks.back()) {
+            ctxt.error = rpn_processing_error::UnbalancedBlock;
+            return false;
+        }
+
+        conditionals.blocks.back() = true;
+        conditionals.skip = 1;
+
+        return true;
+    }
+
+    if (_rpn_word_is(name, "then")) {
+        if (conditionals.balanced()) {
+            ctxt.error = rpn_processing_error::UnbalancedBlock;
+            return false;
+        }
+
+        conditionals.blocks.pop_back();
+        return true;
+    }
+
+    auto* word = _rpn_find(ctxt, &rpn_context::words, name);
+    if (word) {
+        if (processor.depth >= RPNLIB_WORDS_DEPTH) {
+            ctxt.error = rpn_processing_error::WordDepthExceeded;
+            return false;
+        }
+
+        ++processor.depth;
+        auto result = _rpn_execute(processor, word->body);
+        --processor.depth;
+
+        return result;
+    }
+
+    auto* op = _rpn_find(ctxt, &rpn_context::operators, name);
+    if (op) {
+        const size_t size = ctxt.stack.get().size();
+        const size_t from = (size > op->argc) ? (size - op->argc) : 0;
+
+        // array operators consume more than `argc` values, but their result is still at the top
+        ctxt.error = rpn_operator_call(ctxt, *op);
+        if ((0 == ctxt.error.code) && (rpn_float_precision::Single == ctxt.precision)) {
+            const size_t after = ctxt.stack.get().size();
+            _rpn_single_results(ctxt, after ? std::min(from, after - 1) : 0);
+        }
+
+        return (0 == ctxt.error.code);
+    }
+
+    ctxt.error = rpn_processing_error::UnknownOperator;
+    return false;
+}
+
+
+// Expression is compiled into the word body right away, definitions are not allowed
+bool _rpn_compile(rpn_context& ctxt, const char* expression, rpn_word::body_type& body, rpn_error& error) {
+    ctxt.input_buffer.reset();
+    _rpn_tokenize(expression, ctxt.input_buffer, [&](Token type, const rpn_input_buffer& token) {
+        if (!token.ok()) {
+            error = rpn_processing_error::InputBufferOverflow;
+            return false;
+        }
+
+        if ((Token::Word == type) && _rpn_word_is(token.c_str(), ";")) {
+            error = rpn_processing_error::InvalidDefinition;
+            return false;
+        }
+
+        return _rpn_compile_token(ctxt, type, token, body, error);
+    });
+
+    if (0 != error.code) {
+        return false;
+    }
+
+    if (!_rpn_conditionals_balanced(body)) {
+        error = rpn_processing_error::UnbalancedBlock;
+        return false;
+    }
+
+    return true;
+}
+
+// Column form of the compiled expression, every step works on the block of rows
+struct rpn_batch_step {
+    enum class Type {
+        Column,
+        Constant,
+        Operator
+    };
+
+    Type type;
+    const rpn_float* values;
+    rpn_float constant;
+    const rpn_operator* op;
+};
+
+struct rpn_batch_plan {
+    std::vector<rpn_batch_step> steps;
+
+    // maximum number of values on the stack
+    size_t depth { 0 };
+};
+
+const rpn_batch_column* _rpn_batch_column(const rpn_batch_column* columns, size_t columns_size, const char* name) {
+    for (size_t index = 0; index < columns_size; ++index) {
+        if (0 == strcmp(columns[index].name, name)) {
+            return &columns[index];
+        }
+    }
+
+    return nullptr;
+}
+
+// Only floating point values are allowed, since the result type of the math operators depends on the left-hand side.
+// Integers are still allowed on the right-hand side, they are converted anyway. Boolean result of the comparison must be the last one,
+// the operators would not treat it as a number. Returns `false` when the expression must be called row by row
+bool _rpn_batch_plan(const rpn_context& ctxt, const rpn_word::body_type& body, const rpn_batch_column* columns, size_t columns_size, rpn_batch_plan& plan) {
+    if (rpn_float_precision::Default != ctxt.precision) {
+        return false;
+    }
+
+    // type of the stack value, Float, Integer, Unsigned or Boolean
+    std::vector<rpn_value::Type> stack;
+
+    for (auto& instruction : body) {
+        rpn_batch_step step {rpn_batch_step::Type::Constant, nullptr, 0.0, nullptr};
+        auto type = rpn_value::Type::Float;
+
+        switch (instruction.type) {
+
+        case rpn_instruction::Type::Value:
+            if (!instruction.value.isFloat() && !instruction.value.isInt() && !instruction.value.isUint()) {
+                return false;
+            }
+            type = instruction.value.type;
+            step.constant = instruction.value.toFloat();
+            break;
+
+        case rpn_instruction::Type::VariableValue: {
+            auto* column = _rpn_batch_column(columns, columns_size, instruction.name.c_str());
+            if (column) {
+                step.type = rpn_batch_step::Type::Column;
+                step.values = column->values;
+                break;
+            }
+
+            auto* var = _rpn_find(ctxt, &rpn_context::variables, instruction.name.c_str());
+            if (!var || !var->value->isNumber() || var->value->isFixed()) {
+                return false;
             }
+            type = var->value->type;
+            step.constant = var->value->toFloat();
             break;
         }
 
-        case Token::String:
-            ctxt.stack.get().emplace_back(std::make_shared<rpn_value>(token.c_str()));
-            return true;
+        case rpn_instruction::Type::Word: {
+            const char* name = instruction.name.c_str();
+            if (_rpn_word_reserved(name)) {
+                return false;
+            }
 
-        case Token::VariableValue:
-        case Token::VariableReference: {
-            if (!token.length()) {
-                ctxt.error = rpn_processing_error::UnknownToken;
+            if (_rpn_find(ctxt, &rpn_context::words, name)) {
                 return false;
             }
-            auto var = std::find_if(ctxt.variables.cbegin(), ctxt.variables.cend(), [&token](const rpn_variable& v) {
-                return (token == v.name);
-            });
-            const bool found = (var != ctxt.variables.end());
-
-            // either push the reference to the value or the value itself, depending on the variable token type
-            if (found) {
-                if (Token::VariableReference == type) {
-                    ctxt.stack.get().emplace_back(rpn_stack_value::Type::Variable, (*var).value);
-                } else if (Token::VariableValue == type) {
-                    ctxt.stack.get().emplace_back(*((*var).value));
-                }
-                return true;
-            // in case we want value / explicitly said to check for variable existence
-            } else if ((type == Token::VariableValue) || variable_must_exist) {
-                ctxt.error = rpn_processing_error::VariableDoesNotExist;
+
+            auto* op = _rpn_find(ctxt, &rpn_context::operators, name);
+            if (!op || !op->batch_callback || (op->argc > stack.size())) {
+                return false;
+            }
+
+            auto args = stack.end() - op->argc;
+            if (rpn_value::Type::Float != *args) {
+                return false;
+            }
+
+            if (std::any_of(args, stack.end(), [](rpn_value::Type arg) {
+                return rpn_value::Type::Boolean == arg;
+            })) {
                 return false;
-            // since we don't have the variable yet, push uninitialized one
+            }
+
+            stack.erase(args, stack.end());
+            type = op->batch_result;
+
+            step.type = rpn_batch_step::Type::Operator;
+            step.op = op;
+            break;
+        }
+
+        case rpn_instruction::Type::VariableReference:
+        case rpn_instruction::Type::StackPush:
+        case rpn_instruction::Type::StackPop:
+            return false;
+
+        }
+
+        stack.push_back(type);
+        plan.depth = std::max(plan.depth, stack.size());
+        plan.steps.push_back(step);
+    }
+
+    return (1 == stack.size())
+        && ((rpn_value::Type::Float == stack.back()) || (rpn_value::Type::Boolean == stack.back()));
+}
+
+void _rpn_batch_result(size_t row, rpn_float value, const rpn_error& error, rpn_float* out, rpn_error* errors) {
+    out[row] = (0 == error.code)
+        ? value
+        : std::numeric_limits<rpn_float>::quiet_NaN();
+    if (errors) {
+        errors[row] = error;
+    }
+}
+
+void _rpn_batch_execute(const rpn_batch_plan& plan, size_t rows, rpn_float* out, rpn_error* errors) {
+    constexpr size_t BlockSize = RPNLIB_BATCH_BLOCK_SIZE;
+
+    std::vector<rpn_float> buffers(plan.depth * BlockSize);
+    rpn_value_error block_errors[BlockSize];
+
+    for (size_t offset = 0; offset < rows; offset += BlockSize) {
+        const size_t size = std::min(BlockSize, rows - offset);
+        std::fill_n(block_errors, size, rpn_value_error::Ok);
+
+        // next free buffer, the previous one is the top of the stack
+        rpn_float* top = buffers.data();
+
+        for (auto& step : plan.steps) {
+            switch (step.type) {
+            case rpn_batch_step::Type::Column:
+                std::copy_n(step.values + offset, size, top);
+                top += BlockSize;
+                break;
+            case rpn_batch_step::Type::Constant:
+                std::fill_n(top, size, step.constant);
+                top += BlockSize;
+                break;
+            case rpn_batch_step::Type::Operator:
+                if (2 == step.op->argc) {
+                    top -= BlockSize;
+                    step.op->batch_callback(top - BlockSize, top, size, block_errors);
+                } else {
+                    step.op->batch_callback(top - BlockSize, nullptr, size, block_errors);
+                }
+                break;
+            }
+        }
+
+        for (size_t index = 0; index < size; ++index) {
+            rpn_error error;
+            if (rpn_value_error::Ok != block_errors[index]) {
+                error = block_errors[index];
+            }
+            _rpn_batch_result(offset + index, buffers[index], error, out, errors);
+        }
+    }
+}
+
+// Columns are bound to the context variables, which are restored when we are done
+void _rpn_batch_call(rpn_context& ctxt, const rpn_word::body_type& body, const rpn_batch_column* columns, size_t columns_size, size_t rows, rpn_float* out, rpn_error* errors) {
+    struct binding {
+        rpn_value_ptr value;
+        rpn_value previous;
+        bool created;
+    };
+
+    std::vector<binding> bindings;
+    bindings.reserve(columns_size);
+
+    for (size_t index = 0; index < columns_size; ++index) {
+        const char* name = columns[index].name;
+        auto var = std::find_if(ctxt.variables.begin(), ctxt.variables.end(), [name](const rpn_variable& v) {
+            return v.name.equals(name);
+        });
+
+        if (var != ctxt.variables.end()) {
+            bindings.push_back({(*var).value, *(*var).value, false});
+        } else {
+            auto value = rpn_make_value();
+            ctxt.variables.emplace_front(name, value);
+            bindings.push_back({value, rpn_value{}, true});
+        }
+    }
+
+    rpn_processor processor(ctxt, false);
+
+    for (size_t row = 0; row < rows; ++row) {
+        ctxt.error.reset();
+        ctxt.stack.stacks_clear();
+
+        for (size_t index = 0; index < columns_size; ++index) {
+            *bindings[index].value = rpn_value(columns[index].values[row]);
+        }
+
+        rpn_float value { 0.0 };
+        if (_rpn_execute(processor, body)) {
+            auto& stack = ctxt.stack.get();
+            if (!stack.size()) {
+                ctxt.error = rpn_operator_error::ArgumentCountMismatch;
             } else {
-                auto null = std::make_shared<rpn_value>();
-                ctxt.variables.emplace_front(token.c_str(), null);
-                ctxt.stack.get().emplace_back(
-                    rpn_stack_value::Type::Variable, null
-                );
-                return true;
+                auto conversion = stack.back().value->checkedToFloat();
+                if (conversion.ok()) {
+                    value = conversion.value();
+                } else {
+                    ctxt.error = conversion.error();
+                }
             }
         }
 
-        case Token::StackPush:
-            ctxt.stack.stacks_push();
+        _rpn_batch_result(row, value, ctxt.error, out, errors);
+    }
+
+    ctxt.error.reset();
+    ctxt.stack.stacks_clear();
+
+    for (auto& bound : bindings) {
+        if (!bound.created) {
+            *bound.value = std::move(bound.previous);
+        }
+    }
+
+    ctxt.variables.remove_if([&](const rpn_variable& var) {
+        return std::any_of(bindings.begin(), bindings.end(), [&](const binding& bound) {
+            return bound.created && (bound.value == var.value);
+        });
+    });
+
+    rpn_variables_unref(ctxt);
+}
+
+} // namespace anonymous
+
+// ----------------------------------------------------------------------------
+// Main methods
+// ----------------------------------------------------------------------------
+
+bool rpn_process(rpn_context & ctxt, const char * input, bool variable_must_exist) {
+
+    ctxt.error.reset();
+    ctxt.input_buffer.reset();
+
+    rpn_processor processor(ctxt, variable_must_exist);
+    rpn_conditionals conditionals;
+    rpn_definition definition;
+
+    auto position = _rpn_tokenize(input, ctxt.input_buffer, [&](Token type, const rpn_input_buffer& token) {
+
+        //printf(":token \"%s\" type %d\n", token.c_str(), static_cast<int>(type));
+        if (!token.ok()) {
+            ctxt.error = rpn_processing_error::InputBufferOverflow;
+            return false;
+        }
+
+        // Everything between `:` and `;` is compiled into the word instead of being evaluated
+        if (definition.state != rpn_definition::State::None) {
+            return _rpn_define(ctxt, definition, type, token);
+        }
+
+        // Untaken branch of the conditional block is ignored, we only need to know where it ends
+        if (conditionals.skipping()) {
+            if ((Token::Word == type) && !_rpn_conditionals_skip(conditionals, token.c_str())) {
+                ctxt.error = rpn_processing_error::UnbalancedBlock;
+                return false;
+            }
             return true;
+        }
 
-        case Token::StackPop: {
-            if (ctxt.stack.stacks_size() > 1) {
-                ctxt.stack.stacks_merge();
+        // Is token a null, bool, number, string or a variable?
+        switch (type) {
+
+        case Token::Null:
+        case Token::Boolean:
+        case Token::Integer:
+        case Token::Unsigned:
+        case Token::Float:
+        case Token::Fixed:
+        case Token::String: {
+            rpn_value value;
+            if (_rpn_token_value(ctxt, type, token, value)) {
+                ctxt.stack.get().emplace_back(std::move(value));
                 return true;
             }
-
-            ctxt.error = rpn_processing_error::NoMoreStacks;
-            return false;
+            break;
         }
 
+        case Token::VariableValue:
+        case Token::VariableReference:
+            if (!token.length()) {
+                ctxt.error = rpn_processing_error::UnknownToken;
+                return false;
+            }
+            return _rpn_push_variable(processor, Token::VariableReference == type, token.c_str());
+
+        case Token::StackPush:
+            return _rpn_stack_change(ctxt, true);
+
+        case Token::StackPop:
+            return _rpn_stack_change(ctxt, false);
+
         // TODO: ctxt.error.position is set down below
         case Token::Unknown:
             ctxt.error = rpn_processing_error::UnknownToken;
@@ -681,27 +1496,18 @@ bool rpn_process(rpn_context & ctxt, const char * input, bool variable_must_exis
             ctxt.error = rpn_processing_error::InvalidToken;
             return false;
 
-        // Everything else that did not go through the token matching
-        // TODO: class forth systems store word inside of the stack when in compilation mode
-        //       consider adding a flag that never does any stack pop / push operations and just places a 'operation' code on the stack
-        //       this might bloat rpn_value though :/ (yet again)
-        case Token::Word: {
-            auto result = std::find_if(ctxt.operators.cbegin(), ctxt.operators.cend(), [&token](const rpn_operator& op) {
-                return token == op.name;
-            });
-
-            if (result != ctxt.operators.end()) {
-                if ((*result).argc > ctxt.stack.get().size()) {
-                    ctxt.error = rpn_operator_error::ArgumentCountMismatch;
-                    return false;
-                }
-                ctxt.error = ((*result).callback)(ctxt);
-                return (0 == ctxt.error.code);
+        case Token::Word:
+            if (_rpn_word_is(token.c_str(), ":")) {
+                definition.state = rpn_definition::State::Name;
+                return true;
             }
 
-            ctxt.error = rpn_processing_error::UnknownOperator;
-            return false;
-        }
+            if (_rpn_word_is(token.c_str(), ";")) {
+                ctxt.error = rpn_processing_error::InvalidDefinition;
+                return false;
+            }
+
+            return _rpn_call(processor, conditionals, token.c_str());
 
         }
 
@@ -711,6 +1517,15 @@ bool rpn_process(rpn_context & ctxt, const char * input, bool variable_must_exis
 
     });
 
+    // Every `if` must have a matching `then`, and every `:` must have a matching `;`
+    if (0 == ctxt.error.code) {
+        if (definition.state != rpn_definition::State::None) {
+            ctxt.error = rpn_processing_error::InvalidDefinition;
+        } else if (!conditionals.balanced()) {
+            ctxt.error = rpn_processing_error::UnbalancedBlock;
+        }
+    }
+
     if (0 != ctxt.error.code) {
         ctxt.error.position = position;
     }
@@ -724,18 +1539,135 @@ bool rpn_process(rpn_context & ctxt, const char * input, bool variable_must_exis
 
 }
 
+bool rpn_process(rpn_context & ctxt, const char * input, const rpn_process_options & options) {
+    if (!options.rollback) {
+        return rpn_process(ctxt, input, options.variable_must_exist);
+    }
+
+    rpn_stack_checkpoint(ctxt);
+
+    const bool result = rpn_process(ctxt, input, options.variable_must_exist);
+    if (result) {
+        rpn_stack_release(ctxt);
+    } else {
+        rpn_stack_rollback(ctxt);
+    }
+
+    return result;
+}
+
+bool rpn_process(const rpn_context & ctxt, rpn_context & scratch, const char * input, bool variable_must_exist) {
+    const auto* parent = scratch.parent;
+    const auto precision = scratch.precision;
+
+    if (!rpn_parent(scratch, &ctxt)) {
+        return false;
+    }
+
+    const bool result = rpn_process(scratch, input, variable_must_exist);
+
+    scratch.parent = parent;
+    scratch.precision = precision;
+
+    return result;
+}
+
+bool rpn_word_set(rpn_context & ctxt, const char * name, const char * expression) {
+    if (!name || !strlen(name) || _rpn_word_reserved(name)) {
+        return false;
+    }
+
+    for (const char* p = name; *p != '\0'; ++p) {
+        if (isspace(*p)) {
+            return false;
+        }
+    }
+
+    rpn_word::body_type body;
+    rpn_error error;
+
+    if (!_rpn_compile(ctxt, expression, body, error)) {
+        return false;
+    }
+
+    _rpn_word_store(ctxt, name, std::move(body));
+
+    return true;
+}
+
+bool rpn_process_batch(rpn_context & ctxt, const char * expression, const rpn_batch_column * columns, size_t columns_size, size_t rows, rpn_float * out, rpn_error * errors) {
+    ctxt.error.reset();
+
+    if ((columns_size && !columns) || (rows && !out)) {
+        return false;
+    }
+
+    for (size_t index = 0; index < columns_size; ++index) {
+        const char* name = columns[index].name;
+        if (!name || !strlen(name) || !columns[index].values) {
+            return false;
+        }
+
+        if (_rpn_batch_column(columns, index, name)) {
+            return false;
+        }
+    }
+
+    rpn_word::body_type body;
+    if (!_rpn_compile(ctxt, expression, body, ctxt.error)) {
+        return false;
+    }
+
+    rpn_batch_plan plan;
+    if (_rpn_batch_plan(ctxt, body, columns, columns_size, plan)) {
+        _rpn_batch_execute(plan, rows, out, errors);
+    } else {
+        _rpn_batch_call(ctxt, body, columns, columns_size, rows, out, errors);
+    }
+
+    return true;
+}
+
 bool rpn_debug(rpn_context & ctxt, rpn_context::debug_callback_type callback) {
     ctxt.debug_callback = callback;
     return true;
 }
 
+bool rpn_precision(rpn_context & ctxt, rpn_float_precision precision) {
+    ctxt.precision = precision;
+    return true;
+}
+
+// Context with the parent does not need its own operators
+bool rpn_parent(rpn_context & ctxt, const rpn_context * parent) {
+    for (auto* current = parent; current; current = current->parent) {
+        if (current == &ctxt) {
+            return false;
+        }
+    }
+
+    ctxt.parent = parent;
+    if (parent) {
+        ctxt.precision = parent->precision;
+    }
+
+    return true;
+}
+
 bool rpn_init(rpn_context & ctxt) {
     return rpn_operators_init(ctxt);
 }
 
 bool rpn_clear(rpn_context & ctxt) {
     rpn_operators_clear(ctxt);
+    rpn_words_clear(ctxt);
+    rpn_streams_clear(ctxt);
+    rpn_filters_clear(ctxt);
+    rpn_tables_clear(ctxt);
+    rpn_polynomials_clear(ctxt);
     rpn_variables_clear(ctxt);
+    rpn_strings_clear(ctxt);
+    rpn_variable_store_detach(ctxt);
     rpn_stack_clear(ctxt);
     return true;
 }
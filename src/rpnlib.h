@@ -40,9 +40,22 @@ struct rpn_context;
 // ----------------------------------------------------------------------------
 
 #include "rpnlib_value.h"
+#include "rpnlib_string.h"
+#include "rpnlib_series.h"
+#include "rpnlib_sketch.h"
+#include "rpnlib_stack.h"
 #include "rpnlib_operators.h"
 #include "rpnlib_variable.h"
-#include "rpnlib_stack.h"
+#include "rpnlib_store.h"
+#include "rpnlib_word.h"
+#include "rpnlib_stream.h"
+#include "rpnlib_filter.h"
+#include "rpnlib_table.h"
+#include "rpnlib_polynomial.h"
+#include "rpnlib_fmath.h"
+#include "rpnlib_batch.h"
+#include "rpnlib_simd.h"
+#include "rpnlib_engine.h"
 
 // XXX: In theory, this could be Arduino String class. However, String::concat(cstring, length) is hidden by default.
 // We *could* easily make it public via subclassing, however some implementations do resort to using strcpy, completely ignoring 'length' param:
@@ -75,18 +88,48 @@ struct rpn_input_buffer {
     bool _overflow { false };
 };
 
+// Floating point precision of the context, instead of templating all of the value and stack types.
+// `Single` parses numbers and calculates `+ - * / mod` using `float`, while the values are still stored as `rpn_float`.
+// Floating point results of every other operator are rounded to the nearest `float` before they reach the stack, so the stack
+// only contains `float` values. Values set from the outside (rpn_stack_push(), variables) are used as-is.
+// This only reproduces the `float` rounding, which is useful to check the rules meant for the `float` builds.
+// Values are still `double`, and rounding the results is extra work, so `Single` contexts are slower than the `Default` ones
+enum class rpn_float_precision {
+    Default,
+    Single
+};
+
 struct rpn_context {
     using debug_callback_type = void(*)(rpn_context &, const char *);
     using operators_type = std::forward_list<rpn_operator>;
     using variables_type = std::forward_list<rpn_variable>;
+    using words_type = std::forward_list<rpn_word>;
+    using streams_type = std::forward_list<rpn_stream>;
+    using filters_type = std::forward_list<rpn_filter>;
+    using tables_type = std::forward_list<rpn_table>;
+    using polynomials_type = std::forward_list<rpn_polynomial>;
 
     debug_callback_type debug_callback;
+    rpn_float_precision precision { rpn_float_precision::Default };
+
+    // Words, operators, variables, tables and polynomials not found in this context are looked up in the parent.
+    // Parent is only read from, so it can be shared by the contexts of the different threads as long as nothing modifies it
+    const rpn_context* parent { nullptr };
+
+    // Shared variables store, see rpn_variable_store_attach()
+    rpn_variable_store_slot* store { nullptr };
 
     rpn_input_buffer input_buffer;
     rpn_error error;
 
     variables_type variables;
     operators_type operators;
+    words_type words;
+    streams_type streams;
+    filters_type filters;
+    tables_type tables;
+    polynomials_type polynomials;
+    rpn_string_pool strings;
     rpn_nested_stack stack;
 };
 
@@ -95,10 +138,25 @@ struct rpn_context {
 #include "rpnlib_util.h"
 
 bool rpn_process(rpn_context &, const char *, bool variable_must_exist = false);
+
+struct rpn_process_options {
+    bool variable_must_exist { false };
+    // when processing fails, restore the stack to the state it was in before the call (see rpn_stack_checkpoint())
+    bool rollback { false };
+};
+
+bool rpn_process(rpn_context &, const char *, const rpn_process_options &);
+
+// Evaluates the expression without modifying the context, which is used as the parent of the `scratch` context for the duration of the call.
+// Stack, error and `&name` variables are placed in the caller-owned scratch, so the same context can be shared by several threads.
+// Evaluation still allocates the stack values and strings, so it must not be called from the interrupt handlers
+bool rpn_process(const rpn_context &, rpn_context & scratch, const char *, bool variable_must_exist = false);
 bool rpn_init(rpn_context &);
 bool rpn_clear(rpn_context &);
 
 bool rpn_debug(rpn_context &, rpn_context::debug_callback_type);
+bool rpn_precision(rpn_context &, rpn_float_precision);
+bool rpn_parent(rpn_context &, const rpn_context *);
 
 // ----------------------------------------------------------------------------
 
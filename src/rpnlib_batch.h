@@ -0,0 +1,40 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <cstddef>
+
+// Input column of rpn_process_batch(), expression sees `values[row]` as the `$name` variable
+struct rpn_batch_column {
+    const char* name;
+    const rpn_float* values;
+};
+
+// Evaluates the expression once for every row. Expression is only parsed once.
+// When it only uses floating point values and variables, columns and the operators with column kernels (see rpn_operator_set_batch()),
+// every operator is applied to the whole block of rows at once. Otherwise, the compiled expression is called for every row.
+// `out[row]` is the top stack value converted to rpn_float, or NaN when the row fails. When `errors` is set, `errors[row]` is the error of the row.
+// Context stack is cleared and variables are left unchanged. Returns `false` when the expression or the columns are invalid
+bool rpn_process_batch(rpn_context &, const char * expression, const rpn_batch_column * columns, size_t columns_size, size_t rows, rpn_float * out, rpn_error * errors = nullptr);
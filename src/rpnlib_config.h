@@ -33,10 +33,71 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #define RPNLIB_FLOAT_TYPE double
 #endif
 
+// Q16.16 by default. Q32.32 is RPNLIB_FIXED_TYPE=int64_t and RPNLIB_FIXED_FRACTION_BITS=32
+#ifndef RPNLIB_FIXED_TYPE
+#define RPNLIB_FIXED_TYPE int32_t
+#endif
+
+#ifndef RPNLIB_FIXED_FRACTION_BITS
+#define RPNLIB_FIXED_FRACTION_BITS 16
+#endif
+
+// Non-atomic reference counting of the stack and variable values, see rpnlib_value_ptr.h
+#ifndef RPNLIB_INTRUSIVE_REFCOUNT
+#define RPNLIB_INTRUSIVE_REFCOUNT 0
+#endif
+
 #ifndef RPNLIB_EXPRESSION_BUFFER_SIZE
 #define RPNLIB_EXPRESSION_BUFFER_SIZE  256
 #endif
 
+#ifndef RPNLIB_WORDS_DEPTH
+#define RPNLIB_WORDS_DEPTH          16
+#endif
+
+#ifndef RPNLIB_OPERATOR_MEMO_SIZE
+#define RPNLIB_OPERATOR_MEMO_SIZE   8
+#endif
+
+// Arrays up to this size are selected by `median`, `percentile` and `nth` without allocating anything,
+// larger ones use the heap for the selection keys
+#ifndef RPNLIB_ARRAY_SELECT_SIZE
+#define RPNLIB_ARRAY_SELECT_SIZE    32
+#endif
+
+// Rows evaluated at once by rpn_process_batch(), every value on the stack needs the buffer of this size
+#ifndef RPNLIB_BATCH_BLOCK_SIZE
+#define RPNLIB_BATCH_BLOCK_SIZE     64
+#endif
+
+// SSE2 and AVX2 column kernels on x86 hosts, see rpnlib_simd.h
+#ifndef RPNLIB_SIMD
+#define RPNLIB_SIMD                 1
+#endif
+
+// Multi-threaded rpn_engine needs std::thread, so it is only built on host by default
+#ifndef RPNLIB_ENGINE
+#if defined(UNIX_HOST_DUINO) || HOST_MOCK
+#define RPNLIB_ENGINE               1
+#else
+#define RPNLIB_ENGINE               0
+#endif
+#endif
+
+// Writers of the shared variable store are serialized with std::mutex. ESP8266 toolchain does not provide it, and has no
+// preemptive tasks that could write at the same time, so the store uses a no-op lock there instead
+#ifndef RPNLIB_STORE_MUTEX
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+#define RPNLIB_STORE_MUTEX          0
+#else
+#define RPNLIB_STORE_MUTEX          1
+#endif
+#endif
+
+#ifndef RPNLIB_FMATH_FAST
+#define RPNLIB_FMATH_FAST           0
+#endif
+
 #ifndef RPNLIB_BUILTIN_OPERATORS
 #define RPNLIB_BUILTIN_OPERATORS    1
 #endif
@@ -0,0 +1,242 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_engine.h"
+
+#if RPNLIB_ENGINE
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Range of the jobs, processed by one worker at a time
+struct rpn_engine_chunk {
+    rpn_engine_job* jobs;
+    size_t begin;
+    size_t end;
+};
+
+// Owner takes chunks from the back, thieves take them from the front
+struct rpn_engine_queue {
+    std::mutex mutex;
+    std::deque<rpn_engine_chunk> chunks;
+};
+
+struct rpn_engine_pool {
+    explicit rpn_engine_pool(const rpn_context& shared) :
+        shared(shared)
+    {}
+
+    const rpn_context& shared;
+
+    std::vector<std::unique_ptr<rpn_engine_queue>> queues;
+    std::vector<std::thread> threads;
+
+    // workers sleep until the next run is published or the pool is stopped
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    size_t generation { 0 };
+    bool stop { false };
+
+    // jobs of the current run that are not finished yet
+    std::atomic<size_t> remaining { 0 };
+};
+
+namespace {
+
+bool _rpn_engine_take(rpn_engine_queue& queue, rpn_engine_chunk& chunk, bool owner) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty()) {
+        return false;
+    }
+
+    if (owner) {
+        chunk = queue.chunks.back();
+        queue.chunks.pop_back();
+    } else {
+        chunk = queue.chunks.front();
+        queue.chunks.pop_front();
+    }
+
+    return true;
+}
+
+// Victims are tried in order, starting with the next worker
+bool _rpn_engine_steal(rpn_engine_pool& pool, size_t index, rpn_engine_chunk& chunk) {
+    const size_t size = pool.queues.size();
+    for (size_t offset = 1; offset < size; ++offset) {
+        if (_rpn_engine_take(*pool.queues[(index + offset) % size], chunk, false)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void _rpn_engine_job(rpn_context& ctxt, rpn_engine_job& job) {
+    rpn_stack_clear(ctxt);
+    rpn_variables_clear(ctxt);
+
+    for (auto& var : job.variables) {
+        rpn_variable_set(ctxt, var.name, *var.value);
+    }
+
+    rpn_process(ctxt, job.expression.c_str());
+    job.error = ctxt.error;
+
+    auto& stack = ctxt.stack.get();
+    job.result = stack.size()
+        ? *stack.back().value
+        : rpn_value{};
+}
+
+void _rpn_engine_worker(rpn_engine_pool& pool, size_t index) {
+    rpn_context ctxt;
+    rpn_parent(ctxt, &pool.shared);
+
+    size_t generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pool.mutex);
+            pool.wake.wait(lock, [&]() {
+                return pool.stop || (generation != pool.generation);
+            });
+            if (pool.stop) {
+                break;
+            }
+            generation = pool.generation;
+        }
+
+        rpn_engine_chunk chunk;
+        while (_rpn_engine_take(*pool.queues[index], chunk, true) || _rpn_engine_steal(pool, index, chunk)) {
+            for (size_t job = chunk.begin; job < chunk.end; ++job) {
+                _rpn_engine_job(ctxt, chunk.jobs[job]);
+            }
+
+            const size_t size = chunk.end - chunk.begin;
+            if (size == pool.remaining.fetch_sub(size)) {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                pool.done.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace
+
+rpn_engine::rpn_engine() = default;
+
+rpn_engine::~rpn_engine() {
+    rpn_engine_stop(*this);
+}
+
+bool rpn_engine_start(rpn_engine & engine, const rpn_context & shared, size_t threads) {
+    if (engine.pool) {
+        return false;
+    }
+
+    if (!threads) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    engine.pool.reset(new rpn_engine_pool(shared));
+    auto& pool = *engine.pool;
+
+    for (size_t index = 0; index < threads; ++index) {
+        pool.queues.emplace_back(new rpn_engine_queue);
+    }
+
+    for (size_t index = 0; index < threads; ++index) {
+        pool.threads.emplace_back(_rpn_engine_worker, std::ref(pool), index);
+    }
+
+    return true;
+}
+
+bool rpn_engine_stop(rpn_engine & engine) {
+    if (!engine.pool) {
+        return false;
+    }
+
+    auto& pool = *engine.pool;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.stop = true;
+    }
+    pool.wake.notify_all();
+
+    for (auto& thread : pool.threads) {
+        thread.join();
+    }
+
+    engine.pool.reset();
+
+    return true;
+}
+
+size_t rpn_engine_threads(rpn_engine & engine) {
+    return engine.pool
+        ? engine.pool->threads.size()
+        : 0;
+}
+
+// Every worker starts with the contiguous part of the jobs, split into several chunks so there is something left to steal
+bool rpn_engine_run(rpn_engine & engine, rpn_engine_job * jobs, size_t size) {
+    if (!engine.pool) {
+        return false;
+    }
+
+    if (!size) {
+        return true;
+    }
+
+    auto& pool = *engine.pool;
+    const size_t workers = pool.queues.size();
+    const size_t chunk = std::max<size_t>(1, size / (workers * 8));
+
+    pool.remaining = size;
+
+    for (size_t begin = 0; begin < size; begin += chunk) {
+        const size_t worker = (begin * workers) / size;
+        auto& queue = *pool.queues[worker];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.push_front({jobs, begin, std::min(size, begin + chunk)});
+    }
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    ++pool.generation;
+    pool.wake.notify_all();
+    pool.done.wait(lock, [&]() {
+        return 0 == pool.remaining;
+    });
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#if RPNLIB_ENGINE
+
+#include <memory>
+#include <vector>
+
+// Single evaluation of the expression, with the variables set beforehand.
+// Expression is usually the name of the word defined in the shared context, so it is only parsed once
+struct rpn_engine_job {
+    using variables_type = std::vector<rpn_variable>;
+
+    String expression;
+    variables_type variables;
+
+    // top stack value after the evaluation, null when the stack is empty
+    rpn_value result;
+    rpn_error error;
+};
+
+struct rpn_engine_pool;
+
+// Worker threads evaluating the jobs in parallel. Every worker has its own context (with its own stack and variables),
+// using the shared context as its parent for the words, operators, variables, tables and polynomials.
+// Shared context must not be modified while the engine is running
+struct rpn_engine {
+    rpn_engine();
+    ~rpn_engine();
+
+    std::unique_ptr<rpn_engine_pool> pool;
+};
+
+// `threads` defaults to the number of CPU cores
+bool rpn_engine_start(rpn_engine &, const rpn_context & shared, size_t threads = 0);
+bool rpn_engine_stop(rpn_engine &);
+size_t rpn_engine_threads(rpn_engine &);
+
+// Jobs are split into chunks and distributed between the workers. Worker that runs out of chunks steals them from the others.
+// Blocks until every job is done, returns `false` when the engine is not running
+bool rpn_engine_run(rpn_engine &, rpn_engine_job * jobs, size_t size);
+
+#endif
@@ -37,7 +37,10 @@ enum class rpn_processing_error {
     UnknownOperator,
     NoMoreStacks,
     TokenNotHandled,
-    InputBufferOverflow
+    InputBufferOverflow,
+    UnbalancedBlock,
+    InvalidDefinition,
+    WordDepthExceeded
 };
 
 enum class rpn_operator_error {
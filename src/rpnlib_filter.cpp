@@ -0,0 +1,272 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#if defined(HOST_MOCK) && defined(__SSE2__)
+#include <emmintrin.h>
+#define RPNLIB_FILTER_SSE2 1
+#else
+#define RPNLIB_FILTER_SSE2 0
+#endif
+
+// anonymous namespace binds all of the functions below to this compilation unit
+// this has the same effect as if these functions were `static`
+namespace {
+
+// ----------------------------------------------------------------------------
+// Filter processing
+// ----------------------------------------------------------------------------
+
+// FIR taps loop is a dot product of the taps and the samples window. Host build processes 2 doubles or 4 floats at a time
+#if RPNLIB_FILTER_SSE2
+
+inline double _rpn_filter_dot(const double* lhs, const double* rhs, size_t size) {
+    __m128d acc = _mm_setzero_pd();
+
+    size_t index = 0;
+    for (; (index + 2) <= size; index += 2) {
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index)));
+    }
+
+    double parts[2];
+    _mm_storeu_pd(parts, acc);
+
+    double result = parts[0] + parts[1];
+    for (; index < size; ++index) {
+        result += lhs[index] * rhs[index];
+    }
+
+    return result;
+}
+
+inline float _rpn_filter_dot(const float* lhs, const float* rhs, size_t size) {
+    __m128 acc = _mm_setzero_ps();
+
+    size_t index = 0;
+    for (; (index + 4) <= size; index += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(lhs + index), _mm_loadu_ps(rhs + index)));
+    }
+
+    float parts[4];
+    _mm_storeu_ps(parts, acc);
+
+    float result = (parts[0] + parts[1]) + (parts[2] + parts[3]);
+    for (; index < size; ++index) {
+        result += lhs[index] * rhs[index];
+    }
+
+    return result;
+}
+
+#else
+
+template <typename T>
+T _rpn_filter_dot(const T* lhs, const T* rhs, size_t size) {
+    T result { 0 };
+    for (size_t index = 0; index < size; ++index) {
+        result += lhs[index] * rhs[index];
+    }
+
+    return result;
+}
+
+#endif
+
+rpn_float _rpn_filter_fir(rpn_filter& filter, rpn_float sample) {
+    auto& state = filter.state;
+    const size_t size = state.size();
+
+    state[size - 1] = sample;
+    rpn_float result = _rpn_filter_dot(filter.coefficients.data(), state.data(), size);
+    std::memmove(state.data(), state.data() + 1, (size - 1) * sizeof(rpn_float));
+
+    return result;
+}
+
+// Previous samples are placed right before the input, so every output sample is a dot product over the contiguous memory
+void _rpn_filter_fir(rpn_filter& filter, const rpn_float* in, rpn_float* out, size_t size) {
+    auto& state = filter.state;
+    const size_t history = state.size() - 1;
+
+    auto& samples = filter.scratch;
+    samples.resize(history + size);
+    std::copy(state.begin(), state.begin() + history, samples.begin());
+    std::copy(in, in + size, samples.begin() + history);
+
+    for (size_t index = 0; index < size; ++index) {
+        out[index] = _rpn_filter_dot(filter.coefficients.data(), samples.data() + index, state.size());
+    }
+
+    std::copy(samples.end() - history, samples.end(), state.begin());
+}
+
+// Cascade of the second-order sections, using the transposed direct form II
+rpn_float _rpn_filter_biquad(rpn_filter& filter, rpn_float sample) {
+    const rpn_float* coefficients = filter.coefficients.data();
+    rpn_float* state = filter.state.data();
+
+    const size_t sections = filter.state.size() / 2;
+    for (size_t section = 0; section < sections; ++section, coefficients += 5, state += 2) {
+        rpn_float result = coefficients[0] * sample + state[0];
+        state[0] = coefficients[1] * sample - coefficients[3] * result + state[1];
+        state[1] = coefficients[2] * sample - coefficients[4] * result;
+        sample = result;
+    }
+
+    return sample;
+}
+
+void _rpn_filter_biquad(rpn_filter& filter, const rpn_float* in, rpn_float* out, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        out[index] = _rpn_filter_biquad(filter, in[index]);
+    }
+}
+
+rpn_filter* _rpn_filter_find(rpn_context & ctxt, const char* name) {
+    auto result = std::find_if(ctxt.filters.begin(), ctxt.filters.end(), [name](const rpn_filter& filter) {
+        return filter.name.equals(name);
+    });
+
+    if (result != ctxt.filters.end()) {
+        return &(*result);
+    }
+
+    return nullptr;
+}
+
+bool _rpn_filter_set(rpn_context & ctxt, const char* name, rpn_filter::Type type, rpn_filter::values_type&& coefficients, size_t state_size) {
+    if (!strlen(name) || !coefficients.size()) {
+        return false;
+    }
+
+    rpn_filter_del(ctxt, name);
+    ctxt.filters.emplace_front(name, type, std::move(coefficients), state_size);
+
+    return true;
+}
+
+// [a "name"] -> [b]
+// Where `b` is the next output of the filter `name`, fed with the sample `a`
+rpn_error _rpn_filter(rpn_context & ctxt) {
+    auto& stack = ctxt.stack.get();
+
+    auto& name = *stack.back().value;
+    if (!name.isString()) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto* filter = _rpn_filter_find(ctxt, name.stringData());
+    if (!filter) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto conversion = (*(stack.end() - 2)).value->checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    rpn_float result = (filter->type == rpn_filter::Type::Biquad)
+        ? _rpn_filter_biquad(*filter, conversion.value())
+        : _rpn_filter_fir(*filter, conversion.value());
+
+    stack.erase(stack.end() - 2, stack.end());
+    stack.emplace_back(rpn_value(result));
+
+    return 0;
+}
+
+} // namespace anonymous
+
+// ----------------------------------------------------------------------------
+// Filters methods
+// ----------------------------------------------------------------------------
+
+bool rpn_filter_biquad(rpn_context & ctxt, const char* name, const rpn_float* coefficients, size_t sections) {
+    rpn_filter::values_type values(coefficients, coefficients + (sections * 5));
+    return _rpn_filter_set(ctxt, name, rpn_filter::Type::Biquad, std::move(values), sections * 2);
+}
+
+bool rpn_filter_fir(rpn_context & ctxt, const char* name, const rpn_float* taps, size_t size) {
+    rpn_filter::values_type values(std::reverse_iterator<const rpn_float*>(taps + size), std::reverse_iterator<const rpn_float*>(taps));
+    return _rpn_filter_set(ctxt, name, rpn_filter::Type::Fir, std::move(values), size);
+}
+
+bool rpn_filter_process(rpn_context & ctxt, const char* name, const rpn_float* in, rpn_float* out, size_t size) {
+    auto* filter = _rpn_filter_find(ctxt, name);
+    if (!filter) {
+        return false;
+    }
+
+    if (filter->type == rpn_filter::Type::Biquad) {
+        _rpn_filter_biquad(*filter, in, out, size);
+    } else {
+        _rpn_filter_fir(*filter, in, out, size);
+    }
+
+    return true;
+}
+
+bool rpn_filter_reset(rpn_context & ctxt, const char* name) {
+    auto* filter = _rpn_filter_find(ctxt, name);
+    if (!filter) {
+        return false;
+    }
+
+    std::fill(filter->state.begin(), filter->state.end(), 0.0);
+    return true;
+}
+
+bool rpn_filter_del(rpn_context & ctxt, const char* name) {
+    auto end = ctxt.filters.end();
+    auto prev = ctxt.filters.before_begin();
+    auto filter = prev;
+
+    while (filter != end) {
+        prev = filter++;
+        if ((filter != end) && (*filter).name.equals(name)) {
+            ctxt.filters.erase_after(prev);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t rpn_filters_size(rpn_context & ctxt) {
+    return std::distance(ctxt.filters.begin(), ctxt.filters.end());
+}
+
+bool rpn_filters_clear(rpn_context & ctxt) {
+    ctxt.filters.clear();
+    return true;
+}
+
+bool rpn_operators_filter_init(rpn_context & ctxt) {
+    rpn_operator_set(ctxt, "filter", 2, _rpn_filter);
+    return true;
+}
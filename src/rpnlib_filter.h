@@ -0,0 +1,80 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <vector>
+
+// Digital filter, configured once and referenced by name from the expression.
+// Filter keeps it's own state, so it can be fed with one sample at a time
+struct rpn_filter {
+    enum class Type {
+        Biquad,
+        Fir
+    };
+
+    using values_type = std::vector<rpn_float>;
+
+    rpn_filter(const rpn_filter&) = default;
+    rpn_filter(rpn_filter&& other) noexcept :
+        name(std::move(other.name)),
+        type(other.type),
+        coefficients(std::move(other.coefficients)),
+        state(std::move(other.state)),
+        scratch(std::move(other.scratch))
+    {}
+
+    template <typename Name>
+    rpn_filter(Name&& name, Type type, values_type&& coefficients, size_t state_size) :
+        name(std::forward<Name>(name)),
+        type(type),
+        coefficients(std::move(coefficients)),
+        state(state_size, 0.0)
+    {}
+
+    String name;
+    Type type;
+
+    // Biquad: b0 b1 b2 a1 a2 for every section, with a0 normalized to 1. State holds 2 values per section
+    // FIR: taps in reverse order, so they line up with the samples. State holds previous samples, oldest first, and the current one at the end
+    values_type coefficients;
+    values_type state;
+
+    // FIR: block processing places the previous samples and the input here, re-using the memory between the calls
+    values_type scratch;
+};
+
+bool rpn_filter_biquad(rpn_context &, const char* name, const rpn_float* coefficients, size_t sections);
+bool rpn_filter_fir(rpn_context &, const char* name, const rpn_float* taps, size_t size);
+
+// Process `size` samples at once, `out` can be the same as `in`
+bool rpn_filter_process(rpn_context &, const char* name, const rpn_float* in, rpn_float* out, size_t size);
+
+bool rpn_filter_reset(rpn_context &, const char* name);
+bool rpn_filter_del(rpn_context &, const char* name);
+
+size_t rpn_filters_size(rpn_context &);
+bool rpn_filters_clear(rpn_context &);
+
+bool rpn_operators_filter_init(rpn_context &);
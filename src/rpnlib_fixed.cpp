@@ -0,0 +1,234 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_fixed.h"
+
+// anonymous namespace binds all of the functions below to this compilation unit
+// this has the same effect as if these functions were `static`
+namespace {
+
+using wide_type = rpn_fixed::wide_type;
+using unsigned_wide_type = rpn_fixed::unsigned_wide_type;
+
+constexpr int SineBits = 16;
+constexpr int SineSegmentBits = 8;
+constexpr int SineFractionBits = 30 - SineSegmentBits;
+constexpr int SineShift = rpn_fixed::FractionBits - SineBits;
+
+// sin(x) in Q16, 256 segments over [0, pi/2]. Every entry is 32bit aligned, so it can be read directly from flash
+const uint32_t _rpn_fixed_sine[(1 << SineSegmentBits) + 1] PROGMEM {
+    0u, 402u, 804u, 1206u, 1608u, 2010u, 2412u, 2814u,
+    3216u, 3617u, 4019u, 4420u, 4821u, 5222u, 5623u, 6023u,
+    6424u, 6824u, 7224u, 7623u, 8022u, 8421u, 8820u, 9218u,
+    9616u, 10014u, 10411u, 10808u, 11204u, 11600u, 11996u, 12391u,
+    12785u, 13180u, 13573u, 13966u, 14359u, 14751u, 15143u, 15534u,
+    15924u, 16314u, 16703u, 17091u, 17479u, 17867u, 18253u, 18639u,
+    19024u, 19409u, 19792u, 20175u, 20557u, 20939u, 21320u, 21699u,
+    22078u, 22457u, 22834u, 23210u, 23586u, 23961u, 24335u, 24708u,
+    25080u, 25451u, 25821u, 26190u, 26558u, 26925u, 27291u, 27656u,
+    28020u, 28383u, 28745u, 29106u, 29466u, 29824u, 30182u, 30538u,
+    30893u, 31248u, 31600u, 31952u, 32303u, 32652u, 33000u, 33347u,
+    33692u, 34037u, 34380u, 34721u, 35062u, 35401u, 35738u, 36075u,
+    36410u, 36744u, 37076u, 37407u, 37736u, 38064u, 38391u, 38716u,
+    39040u, 39362u, 39683u, 40002u, 40320u, 40636u, 40951u, 41264u,
+    41576u, 41886u, 42194u, 42501u, 42806u, 43110u, 43412u, 43713u,
+    44011u, 44308u, 44604u, 44898u, 45190u, 45480u, 45769u, 46056u,
+    46341u, 46624u, 46906u, 47186u, 47464u, 47741u, 48015u, 48288u,
+    48559u, 48828u, 49095u, 49361u, 49624u, 49886u, 50146u, 50404u,
+    50660u, 50914u, 51166u, 51417u, 51665u, 51911u, 52156u, 52398u,
+    52639u, 52878u, 53114u, 53349u, 53581u, 53812u, 54040u, 54267u,
+    54491u, 54714u, 54934u, 55152u, 55368u, 55582u, 55794u, 56004u,
+    56212u, 56418u, 56621u, 56823u, 57022u, 57219u, 57414u, 57607u,
+    57798u, 57986u, 58172u, 58356u, 58538u, 58718u, 58896u, 59071u,
+    59244u, 59415u, 59583u, 59750u, 59914u, 60075u, 60235u, 60392u,
+    60547u, 60700u, 60851u, 60999u, 61145u, 61288u, 61429u, 61568u,
+    61705u, 61839u, 61971u, 62101u, 62228u, 62353u, 62476u, 62596u,
+    62714u, 62830u, 62943u, 63054u, 63162u, 63268u, 63372u, 63473u,
+    63572u, 63668u, 63763u, 63854u, 63944u, 64031u, 64115u, 64197u,
+    64277u, 64354u, 64429u, 64501u, 64571u, 64639u, 64704u, 64766u,
+    64827u, 64884u, 64940u, 64993u, 65043u, 65091u, 65137u, 65180u,
+    65220u, 65259u, 65294u, 65328u, 65358u, 65387u, 65413u, 65436u,
+    65457u, 65476u, 65492u, 65505u, 65516u, 65525u, 65531u, 65535u,
+    65536u,
+};
+
+// 2^32 / 2pi, converts radians into the 32bit phase
+constexpr wide_type _rpn_fixed_turn = 683565276;
+
+// Phase is a full turn as 32bit unsigned integer, upper 2 bits select the quadrant
+rpn_fixed _rpn_fixed_sine_phase(uint32_t phase) {
+    const uint32_t quadrant = phase >> 30;
+
+    uint32_t position = phase & 0x3fffffffu;
+    if (quadrant & 1u) {
+        position = 0x40000000u - position;
+    }
+
+    const uint32_t index = position >> SineFractionBits;
+    const uint32_t fraction = position & ((1u << SineFractionBits) - 1u);
+
+    wide_type value = _rpn_fixed_sine[index];
+    if (fraction) {
+        value += (static_cast<wide_type>(_rpn_fixed_sine[index + 1] - _rpn_fixed_sine[index]) * fraction) >> SineFractionBits;
+    }
+
+    value = (SineShift >= 0)
+        ? (value << ((SineShift >= 0) ? SineShift : 0))
+        : (value >> ((SineShift < 0) ? -SineShift : 0));
+
+    return rpn_fixed::fromRaw((quadrant & 2u) ? -value : value);
+}
+
+uint32_t _rpn_fixed_phase(rpn_fixed value) {
+    return static_cast<uint32_t>((static_cast<wide_type>(value.raw) * _rpn_fixed_turn) >> rpn_fixed::FractionBits);
+}
+
+} // namespace anonymous
+
+rpn_fixed rpn_fixed::operator*(rpn_fixed other) const {
+    wide_type result = static_cast<wide_type>(raw) * other.raw;
+    return saturate((result + (One / 2)) >> FractionBits);
+}
+
+rpn_fixed rpn_fixed::operator/(rpn_fixed other) const {
+    return saturate((static_cast<wide_type>(raw) * One) / other.raw);
+}
+
+// Result has the same sign as the divisor, same as the other rpn_value types
+rpn_fixed rpn_fixed::operator%(rpn_fixed other) const {
+    wide_type result = static_cast<wide_type>(raw) % other.raw;
+    if (result && ((result < 0) != (other.raw < 0))) {
+        result += other.raw;
+    }
+
+    return saturate(result);
+}
+
+rpn_fixed rpn_fixed::abs() const {
+    return (raw < 0) ? -(*this) : *this;
+}
+
+rpn_fixed rpn_fixed::floor() const {
+    return fromRaw(raw & ~(One - 1));
+}
+
+rpn_fixed rpn_fixed::ceil() const {
+    return saturate((static_cast<wide_type>(raw) + One - 1) & ~static_cast<wide_type>(One - 1));
+}
+
+// Rounds half up, `decimals` is clamped to 0...9
+rpn_fixed rpn_fixed::round(int decimals) const {
+    wide_type multiplier = 1;
+    for (int index = 0; index < decimals && index < 9; ++index) {
+        multiplier *= 10;
+    }
+
+    wide_type result = ((static_cast<wide_type>(raw) * multiplier) + (One / 2)) >> FractionBits;
+    result *= One;
+    result += (result < 0) ? -(multiplier / 2) : (multiplier / 2);
+
+    return saturate(result / multiplier);
+}
+
+// Digit-by-digit square root of `raw << FractionBits`, exact to the last bit without any tables
+rpn_fixed rpn_fixed::sqrt() const {
+    unsigned_wide_type value = static_cast<unsigned_wide_type>(raw) << FractionBits;
+    unsigned_wide_type result = 0;
+
+    unsigned_wide_type bit = static_cast<unsigned_wide_type>(1) << (std::numeric_limits<unsigned_wide_type>::digits - 2);
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return saturate(static_cast<wide_type>(result));
+}
+
+rpn_fixed rpn_fixed::sin() const {
+    return _rpn_fixed_sine_phase(_rpn_fixed_phase(*this));
+}
+
+rpn_fixed rpn_fixed::cos() const {
+    return _rpn_fixed_sine_phase(_rpn_fixed_phase(*this) + 0x40000000u);
+}
+
+// Decimal representation is rounded to the number of digits that fraction bits can express, trailing zeroes are removed
+String rpn_fixed::toString() const {
+    constexpr int Digits = (FractionBits * 3 + 9) / 10;
+
+    unsigned_wide_type scale = 1;
+    for (int index = 0; index < Digits; ++index) {
+        scale *= 10;
+    }
+
+    const bool negative = raw < 0;
+    const unsigned_wide_type magnitude = negative
+        ? static_cast<unsigned_wide_type>(-static_cast<wide_type>(raw))
+        : static_cast<unsigned_wide_type>(raw);
+
+    unsigned_wide_type integer = magnitude >> FractionBits;
+    unsigned_wide_type decimal = ((magnitude & (One - 1)) * scale + (One / 2)) >> FractionBits;
+    if (decimal >= scale) {
+        decimal -= scale;
+        ++integer;
+    }
+
+    // negative numbers rounded to zero are printed without the sign
+    const bool sign = negative && (integer || decimal);
+
+    char buffer[std::numeric_limits<unsigned_wide_type>::digits10 + Digits + 4];
+    char* ptr = buffer + sizeof(buffer);
+    *(--ptr) = '\0';
+
+    int digits = Digits;
+    while ((digits > 1) && (0 == (decimal % 10))) {
+        decimal /= 10;
+        --digits;
+    }
+
+    while (digits--) {
+        *(--ptr) = '0' + static_cast<char>(decimal % 10);
+        decimal /= 10;
+    }
+    *(--ptr) = '.';
+
+    do {
+        *(--ptr) = '0' + static_cast<char>(integer % 10);
+        integer /= 10;
+    } while (integer);
+
+    if (sign) {
+        *(--ptr) = '-';
+    }
+
+    return String(ptr);
+}
@@ -0,0 +1,120 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib_config.h"
+
+#include <cstdint>
+#include <limits>
+
+// Wider type holds the intermediate results of multiplication and division.
+// Q32.32 (RPNLIB_FIXED_TYPE=int64_t) is only available when the compiler supports 128bit integers
+template <typename T>
+struct rpn_fixed_traits;
+
+template <>
+struct rpn_fixed_traits<int32_t> {
+    using wide_type = int64_t;
+    using unsigned_wide_type = uint64_t;
+};
+
+#ifdef __SIZEOF_INT128__
+template <>
+struct rpn_fixed_traits<int64_t> {
+    using wide_type = __int128;
+    using unsigned_wide_type = unsigned __int128;
+};
+#endif
+
+// Fixed-point number, by default Q16.16. Every operation uses integers only, and results saturate at the range limits instead of wrapping around
+struct rpn_fixed {
+    using raw_type = RPNLIB_FIXED_TYPE;
+    using wide_type = rpn_fixed_traits<raw_type>::wide_type;
+    using unsigned_wide_type = rpn_fixed_traits<raw_type>::unsigned_wide_type;
+
+    static constexpr int FractionBits = RPNLIB_FIXED_FRACTION_BITS;
+    static_assert((FractionBits > 0) && (FractionBits < std::numeric_limits<raw_type>::digits), "");
+
+    static constexpr raw_type One = static_cast<raw_type>(1) << FractionBits;
+    static constexpr raw_type Max = std::numeric_limits<raw_type>::max();
+    static constexpr raw_type Min = std::numeric_limits<raw_type>::min();
+
+    rpn_fixed() = default;
+
+    static rpn_fixed fromRaw(raw_type value) {
+        rpn_fixed result;
+        result.raw = value;
+        return result;
+    }
+
+    static rpn_fixed saturate(wide_type value) {
+        return (value > Max) ? fromRaw(Max)
+            : (value < Min) ? fromRaw(Min)
+            : fromRaw(static_cast<raw_type>(value));
+    }
+
+    rpn_fixed operator+(rpn_fixed other) const {
+        return saturate(static_cast<wide_type>(raw) + other.raw);
+    }
+
+    rpn_fixed operator-(rpn_fixed other) const {
+        return saturate(static_cast<wide_type>(raw) - other.raw);
+    }
+
+    rpn_fixed operator-() const {
+        return saturate(-static_cast<wide_type>(raw));
+    }
+
+    bool operator==(rpn_fixed other) const {
+        return raw == other.raw;
+    }
+
+    bool operator<(rpn_fixed other) const {
+        return raw < other.raw;
+    }
+
+    bool operator>(rpn_fixed other) const {
+        return raw > other.raw;
+    }
+
+    // Division and modulo expect non-zero divisor
+    rpn_fixed operator*(rpn_fixed) const;
+    rpn_fixed operator/(rpn_fixed) const;
+    rpn_fixed operator%(rpn_fixed) const;
+
+    rpn_fixed abs() const;
+    rpn_fixed floor() const;
+    rpn_fixed ceil() const;
+    rpn_fixed round(int decimals) const;
+
+    // Expects non-negative value
+    rpn_fixed sqrt() const;
+
+    // Angle is in radians, using quarter-wave table with linear interpolation
+    rpn_fixed sin() const;
+    rpn_fixed cos() const;
+
+    String toString() const;
+
+    raw_type raw;
+};
@@ -22,37 +22,336 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "rpnlib.h"
 #include "rpnlib_operators.h"
+#include "rpnlib_fmath.h"
 
 extern "C" {
     #include "fs_math.h"
 }
 
-#ifdef RPNLIB_ADVANCED_MATH
+#include <cmath>
+#include <limits>
 
 // anonymous namespace binds all of the functions below to this compilation unit
 // this has the same effect as if these functions were `static`
 namespace {
 
+// ----------------------------------------------------------------------------
+// Fast approximations
+// ----------------------------------------------------------------------------
+
+constexpr rpn_float FastPi = 3.14159265358979323846;
+constexpr rpn_float FastLn2 = 0.69314718055994530942;
+constexpr rpn_float FastLog10e = 0.43429448190325182765;
+
+// sin(2pi * i / 256), cos is the same table shifted by a quarter
+constexpr int FastSineSize = 256;
+const float _rpn_fmath_sine[FastSineSize] PROGMEM {
+    0.000000000e+00f, 2.454122852e-02f, 4.906767433e-02f, 7.356456360e-02f,
+    9.801714033e-02f, 1.224106752e-01f, 1.467304745e-01f, 1.709618888e-01f,
+    1.950903220e-01f, 2.191012402e-01f, 2.429801799e-01f, 2.667127575e-01f,
+    2.902846773e-01f, 3.136817404e-01f, 3.368898534e-01f, 3.598950365e-01f,
+    3.826834324e-01f, 4.052413140e-01f, 4.275550934e-01f, 4.496113297e-01f,
+    4.713967368e-01f, 4.928981922e-01f, 5.141027442e-01f, 5.349976199e-01f,
+    5.555702330e-01f, 5.758081914e-01f, 5.956993045e-01f, 6.152315906e-01f,
+    6.343932842e-01f, 6.531728430e-01f, 6.715589548e-01f, 6.895405447e-01f,
+    7.071067812e-01f, 7.242470830e-01f, 7.409511254e-01f, 7.572088465e-01f,
+    7.730104534e-01f, 7.883464276e-01f, 8.032075315e-01f, 8.175848132e-01f,
+    8.314696123e-01f, 8.448535652e-01f, 8.577286100e-01f, 8.700869911e-01f,
+    8.819212643e-01f, 8.932243012e-01f, 9.039892931e-01f, 9.142097557e-01f,
+    9.238795325e-01f, 9.329927988e-01f, 9.415440652e-01f, 9.495281806e-01f,
+    9.569403357e-01f, 9.637760658e-01f, 9.700312532e-01f, 9.757021300e-01f,
+    9.807852804e-01f, 9.852776424e-01f, 9.891765100e-01f, 9.924795346e-01f,
+    9.951847267e-01f, 9.972904567e-01f, 9.987954562e-01f, 9.996988187e-01f,
+    1.000000000e+00f, 9.996988187e-01f, 9.987954562e-01f, 9.972904567e-01f,
+    9.951847267e-01f, 9.924795346e-01f, 9.891765100e-01f, 9.852776424e-01f,
+    9.807852804e-01f, 9.757021300e-01f, 9.700312532e-01f, 9.637760658e-01f,
+    9.569403357e-01f, 9.495281806e-01f, 9.415440652e-01f, 9.329927988e-01f,
+    9.238795325e-01f, 9.142097557e-01f, 9.039892931e-01f, 8.932243012e-01f,
+    8.819212643e-01f, 8.700869911e-01f, 8.577286100e-01f, 8.448535652e-01f,
+    8.314696123e-01f, 8.175848132e-01f, 8.032075315e-01f, 7.883464276e-01f,
+    7.730104534e-01f, 7.572088465e-01f, 7.409511254e-01f, 7.242470830e-01f,
+    7.071067812e-01f, 6.895405447e-01f, 6.715589548e-01f, 6.531728430e-01f,
+    6.343932842e-01f, 6.152315906e-01f, 5.956993045e-01f, 5.758081914e-01f,
+    5.555702330e-01f, 5.349976199e-01f, 5.141027442e-01f, 4.928981922e-01f,
+    4.713967368e-01f, 4.496113297e-01f, 4.275550934e-01f, 4.052413140e-01f,
+    3.826834324e-01f, 3.598950365e-01f, 3.368898534e-01f, 3.136817404e-01f,
+    2.902846773e-01f, 2.667127575e-01f, 2.429801799e-01f, 2.191012402e-01f,
+    1.950903220e-01f, 1.709618888e-01f, 1.467304745e-01f, 1.224106752e-01f,
+    9.801714033e-02f, 7.356456360e-02f, 4.906767433e-02f, 2.454122852e-02f,
+    1.224646799e-16f, -2.454122852e-02f, -4.906767433e-02f, -7.356456360e-02f,
+    -9.801714033e-02f, -1.224106752e-01f, -1.467304745e-01f, -1.709618888e-01f,
+    -1.950903220e-01f, -2.191012402e-01f, -2.429801799e-01f, -2.667127575e-01f,
+    -2.902846773e-01f, -3.136817404e-01f, -3.368898534e-01f, -3.598950365e-01f,
+    -3.826834324e-01f, -4.052413140e-01f, -4.275550934e-01f, -4.496113297e-01f,
+    -4.713967368e-01f, -4.928981922e-01f, -5.141027442e-01f, -5.349976199e-01f,
+    -5.555702330e-01f, -5.758081914e-01f, -5.956993045e-01f, -6.152315906e-01f,
+    -6.343932842e-01f, -6.531728430e-01f, -6.715589548e-01f, -6.895405447e-01f,
+    -7.071067812e-01f, -7.242470830e-01f, -7.409511254e-01f, -7.572088465e-01f,
+    -7.730104534e-01f, -7.883464276e-01f, -8.032075315e-01f, -8.175848132e-01f,
+    -8.314696123e-01f, -8.448535652e-01f, -8.577286100e-01f, -8.700869911e-01f,
+    -8.819212643e-01f, -8.932243012e-01f, -9.039892931e-01f, -9.142097557e-01f,
+    -9.238795325e-01f, -9.329927988e-01f, -9.415440652e-01f, -9.495281806e-01f,
+    -9.569403357e-01f, -9.637760658e-01f, -9.700312532e-01f, -9.757021300e-01f,
+    -9.807852804e-01f, -9.852776424e-01f, -9.891765100e-01f, -9.924795346e-01f,
+    -9.951847267e-01f, -9.972904567e-01f, -9.987954562e-01f, -9.996988187e-01f,
+    -1.000000000e+00f, -9.996988187e-01f, -9.987954562e-01f, -9.972904567e-01f,
+    -9.951847267e-01f, -9.924795346e-01f, -9.891765100e-01f, -9.852776424e-01f,
+    -9.807852804e-01f, -9.757021300e-01f, -9.700312532e-01f, -9.637760658e-01f,
+    -9.569403357e-01f, -9.495281806e-01f, -9.415440652e-01f, -9.329927988e-01f,
+    -9.238795325e-01f, -9.142097557e-01f, -9.039892931e-01f, -8.932243012e-01f,
+    -8.819212643e-01f, -8.700869911e-01f, -8.577286100e-01f, -8.448535652e-01f,
+    -8.314696123e-01f, -8.175848132e-01f, -8.032075315e-01f, -7.883464276e-01f,
+    -7.730104534e-01f, -7.572088465e-01f, -7.409511254e-01f, -7.242470830e-01f,
+    -7.071067812e-01f, -6.895405447e-01f, -6.715589548e-01f, -6.531728430e-01f,
+    -6.343932842e-01f, -6.152315906e-01f, -5.956993045e-01f, -5.758081914e-01f,
+    -5.555702330e-01f, -5.349976199e-01f, -5.141027442e-01f, -4.928981922e-01f,
+    -4.713967368e-01f, -4.496113297e-01f, -4.275550934e-01f, -4.052413140e-01f,
+    -3.826834324e-01f, -3.598950365e-01f, -3.368898534e-01f, -3.136817404e-01f,
+    -2.902846773e-01f, -2.667127575e-01f, -2.429801799e-01f, -2.191012402e-01f,
+    -1.950903220e-01f, -1.709618888e-01f, -1.467304745e-01f, -1.224106752e-01f,
+    -9.801714033e-02f, -7.356456360e-02f, -4.906767433e-02f, -2.454122852e-02f,
+};
+
+// 2^(i / 32)
+constexpr int FastExpSize = 32;
+const float _rpn_fmath_exp2[FastExpSize] PROGMEM {
+    1.000000000e+00f, 1.021897149e+00f, 1.044273782e+00f, 1.067140401e+00f,
+    1.090507733e+00f, 1.114386743e+00f, 1.138788635e+00f, 1.163724859e+00f,
+    1.189207115e+00f, 1.215247360e+00f, 1.241857812e+00f, 1.269050957e+00f,
+    1.296839555e+00f, 1.325236643e+00f, 1.354255547e+00f, 1.383909882e+00f,
+    1.414213562e+00f, 1.445180807e+00f, 1.476826146e+00f, 1.509164428e+00f,
+    1.542210825e+00f, 1.575980845e+00f, 1.610490332e+00f, 1.645755478e+00f,
+    1.681792831e+00f, 1.718619298e+00f, 1.756252160e+00f, 1.794709075e+00f,
+    1.834008086e+00f, 1.874167634e+00f, 1.915206561e+00f, 1.957144124e+00f,
+};
+
+// log(c) and 1 / c, where c = 1 + (i + 0.5) / 32
+constexpr int FastLogSize = 32;
+const float _rpn_fmath_log[FastLogSize] PROGMEM {
+    1.550418654e-02f, 4.580953603e-02f, 7.522342124e-02f, 1.037967937e-01f,
+    1.315763578e-01f, 1.586050302e-01f, 1.849223385e-01f, 2.105647691e-01f,
+    2.355660713e-01f, 2.599575244e-01f, 2.837681731e-01f, 3.070250353e-01f,
+    3.297532864e-01f, 3.519764232e-01f, 3.737164098e-01f, 3.949938082e-01f,
+    4.158278951e-01f, 4.362367668e-01f, 4.562374335e-01f, 4.758459049e-01f,
+    4.950772668e-01f, 5.139457511e-01f, 5.324647989e-01f, 5.506471180e-01f,
+    5.685047354e-01f, 5.860490450e-01f, 6.032908514e-01f, 6.202404098e-01f,
+    6.369074622e-01f, 6.533012720e-01f, 6.694306539e-01f, 6.853040031e-01f,
+};
+
+const float _rpn_fmath_inverse[FastLogSize] PROGMEM {
+    9.846153846e-01f, 9.552238806e-01f, 9.275362319e-01f, 9.014084507e-01f,
+    8.767123288e-01f, 8.533333333e-01f, 8.311688312e-01f, 8.101265823e-01f,
+    7.901234568e-01f, 7.710843373e-01f, 7.529411765e-01f, 7.356321839e-01f,
+    7.191011236e-01f, 7.032967033e-01f, 6.881720430e-01f, 6.736842105e-01f,
+    6.597938144e-01f, 6.464646465e-01f, 6.336633663e-01f, 6.213592233e-01f,
+    6.095238095e-01f, 5.981308411e-01f, 5.871559633e-01f, 5.765765766e-01f,
+    5.663716814e-01f, 5.565217391e-01f, 5.470085470e-01f, 5.378151261e-01f,
+    5.289256198e-01f, 5.203252033e-01f, 5.120000000e-01f, 5.039370079e-01f,
+};
+
+// x = 2pi * n / 256 + r, where |r| <= pi / 256
+// sin(x) = sin(a)cos(r) + cos(a)sin(r)
+// cos(x) = cos(a)cos(r) - sin(a)sin(r)
+template <bool Cosine>
+rpn_float _rpn_fmath_fast_sincos(rpn_float x) {
+    constexpr rpn_float Step = (2.0 * FastPi) / FastSineSize;
+    constexpr rpn_float InverseStep = FastSineSize / (2.0 * FastPi);
+
+    // table index of the non-finite `n` would be undefined
+    if (!std::isfinite(x)) {
+        return std::numeric_limits<rpn_float>::quiet_NaN();
+    }
+
+    const rpn_float n = std::nearbyint(x * InverseStep);
+    const float r = static_cast<float>(x - n * Step);
+    const float r2 = r * r;
+
+    const float sin_r = r - (r * r2 * (1.0f / 6.0f));
+    const float cos_r = 1.0f - (r2 * 0.5f) + (r2 * r2 * (1.0f / 24.0f));
+
+    const int index = static_cast<int>(static_cast<long>(std::fmod(n, static_cast<rpn_float>(FastSineSize))) & (FastSineSize - 1));
+    const float sin_a = _rpn_fmath_sine[index];
+    const float cos_a = _rpn_fmath_sine[(index + (FastSineSize / 4)) & (FastSineSize - 1)];
+
+    return Cosine
+        ? static_cast<rpn_float>((cos_a * cos_r) - (sin_a * sin_r))
+        : static_cast<rpn_float>((sin_a * cos_r) + (cos_a * sin_r));
+}
+
+} // namespace anonymous
+
+rpn_float rpn_fmath_fast_sin(rpn_float x) {
+    return _rpn_fmath_fast_sincos<false>(x);
+}
+
+rpn_float rpn_fmath_fast_cos(rpn_float x) {
+    return _rpn_fmath_fast_sincos<true>(x);
+}
+
+rpn_float rpn_fmath_fast_tan(rpn_float x) {
+    return _rpn_fmath_fast_sincos<false>(x) / _rpn_fmath_fast_sincos<true>(x);
+}
+
+// x = (32m + j) * ln2 / 32 + r, where |r| <= ln2 / 64
+// exp(x) = 2^m * 2^(j / 32) * exp(r)
+rpn_float rpn_fmath_fast_exp(rpn_float x) {
+    constexpr rpn_float Step = FastLn2 / FastExpSize;
+    constexpr rpn_float InverseStep = FastExpSize / FastLn2;
+
+    if (std::isnan(x)) {
+        return x;
+    }
+
+    if (x > static_cast<rpn_float>(std::numeric_limits<rpn_float>::max_exponent) * FastLn2) {
+        return std::numeric_limits<rpn_float>::infinity();
+    }
+
+    if (x < static_cast<rpn_float>(std::numeric_limits<rpn_float>::min_exponent - std::numeric_limits<rpn_float>::digits) * FastLn2) {
+        return 0.0;
+    }
+
+    const long n = std::lround(x * InverseStep);
+    const float r = static_cast<float>(x - static_cast<rpn_float>(n) * Step);
+
+    const float exp_r = 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6.0f)));
+
+    const long j = n & (FastExpSize - 1);
+    const long m = (n - j) / FastExpSize;
+
+    return std::ldexp(static_cast<rpn_float>(_rpn_fmath_exp2[j] * exp_r), static_cast<int>(m));
+}
+
+// x = 2^e * m, where m is in [1, 2) and m = c * (1 + f)
+// log(x) = e * ln2 + log(c) + log(1 + f)
+rpn_float rpn_fmath_fast_log(rpn_float x) {
+    if (std::isnan(x) || (x < 0.0)) {
+        return std::numeric_limits<rpn_float>::quiet_NaN();
+    }
+
+    if (x == 0.0) {
+        return -std::numeric_limits<rpn_float>::infinity();
+    }
+
+    if (std::isinf(x)) {
+        return x;
+    }
+
+    int e;
+    const rpn_float m = std::frexp(x, &e) * 2.0;
+    --e;
+
+    // m - c is exact, only the small difference is rounded to `float`
+    const int index = static_cast<int>((m - 1.0) * FastLogSize);
+    const rpn_float c = 1.0 + ((static_cast<rpn_float>(index) + 0.5) / FastLogSize);
+    const float f = static_cast<float>(m - c) * _rpn_fmath_inverse[index];
+    const float log_f = f * (1.0f - f * (0.5f - f * ((1.0f / 3.0f) - f * 0.25f)));
+
+    return (static_cast<rpn_float>(e) * FastLn2) + static_cast<rpn_float>(_rpn_fmath_log[index]) + static_cast<rpn_float>(log_f);
+}
+
+rpn_float rpn_fmath_fast_log10(rpn_float x) {
+    return rpn_fmath_fast_log(x) * FastLog10e;
+}
+
+// Negative base is only allowed with integer exponent. Sign of zero is kept with odd integer exponent, same as std::pow
+rpn_float rpn_fmath_fast_pow(rpn_float x, rpn_float y) {
+    if (y == 0.0) {
+        return 1.0;
+    }
+
+    if (std::isnan(x) || std::isnan(y)) {
+        return std::numeric_limits<rpn_float>::quiet_NaN();
+    }
+
+    if (x == 0.0) {
+        const bool odd = (std::trunc(y) == y) && (std::fmod(y, 2.0) != 0.0);
+        const rpn_float zero = (odd && std::signbit(x)) ? -0.0 : 0.0;
+        return (y > 0.0)
+            ? zero
+            : std::copysign(std::numeric_limits<rpn_float>::infinity(), zero);
+    }
+
+    if (x < 0.0) {
+        if (std::trunc(y) != y) {
+            return std::numeric_limits<rpn_float>::quiet_NaN();
+        }
+
+        const rpn_float result = rpn_fmath_fast_exp(y * rpn_fmath_fast_log(-x));
+        return (std::fmod(y, 2.0) != 0.0) ? -result : result;
+    }
+
+    return rpn_fmath_fast_exp(y * rpn_fmath_fast_log(x));
+}
+
+#ifdef RPNLIB_ADVANCED_MATH
+
+namespace {
+
 // ----------------------------------------------------------------------------
 // Advanced math
 // ----------------------------------------------------------------------------
 
-rpn_error _rpn_sqrt(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+// Operators using approximations receive the set of functions as the user data, which is replaced when the mode changes
+
+struct rpn_fmath_functions {
+    rpn_float(*log)(rpn_float);
+    rpn_float(*log10)(rpn_float);
+    rpn_float(*exp)(rpn_float);
+    rpn_float(*pow)(rpn_float, rpn_float);
+    rpn_float(*cos)(rpn_float);
+    rpn_float(*sin)(rpn_float);
+};
+
+// sin(x) = cos(x - pi/2), which also keeps the sign of the result
+rpn_fmath_functions _rpn_fmath_exact {
+    [](rpn_float x) { return static_cast<rpn_float>(fs_log(x)); },
+    [](rpn_float x) { return static_cast<rpn_float>(fs_log10(x)); },
+    [](rpn_float x) { return static_cast<rpn_float>(fs_exp(x)); },
+    [](rpn_float x, rpn_float y) { return static_cast<rpn_float>(fs_pow(x, y)); },
+    [](rpn_float x) { return static_cast<rpn_float>(fs_cos(x)); },
+    [](rpn_float x) { return static_cast<rpn_float>(fs_cos(x - (FastPi / 2.0))); },
+};
+
+rpn_fmath_functions _rpn_fmath_fast {
+    rpn_fmath_fast_log,
+    rpn_fmath_fast_log10,
+    rpn_fmath_fast_exp,
+    rpn_fmath_fast_pow,
+    rpn_fmath_fast_cos,
+    rpn_fmath_fast_sin,
+};
+
+const rpn_fmath_functions& _rpn_fmath_functions(void* data) {
+    return *static_cast<const rpn_fmath_functions*>(data);
+}
+
+// Operators use arguments view, so we don't need to copy values from the stack
+// sqrt, sin and cos of the fixed-point value avoid fs_math and floating point altogether
+// sqrt and fmod are always exact
+
+rpn_error _rpn_sqrt(void*, const rpn_operator_args& args, rpn_value& out) {
+    if (args[0].isFixed()) {
+        auto value = args[0].toFixed();
+        if (value.raw < 0) {
+            return rpn_operator_error::InvalidArgument;
+        }
+
+        out = rpn_value { value.sqrt() };
+        return 0;
+    }
+
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
 
-    rpn_value result { static_cast<rpn_float>(fs_sqrt(conversion.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { static_cast<rpn_float>(fs_sqrt(conversion.value())) };
 
     return 0;
 }
 
-rpn_error _rpn_log(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+rpn_error _rpn_log(void* data, const rpn_operator_args& args, rpn_value& out) {
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
@@ -61,15 +360,13 @@ rpn_error _rpn_log(rpn_context & ctxt) {
         return rpn_operator_error::InvalidArgument;
     }
 
-    rpn_value result { rpn_float(fs_log(conversion.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { _rpn_fmath_functions(data).log(conversion.value()) };
 
     return 0;
 }
 
-rpn_error _rpn_log10(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+rpn_error _rpn_log10(void* data, const rpn_operator_args& args, rpn_value& out) {
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
@@ -78,35 +375,29 @@ rpn_error _rpn_log10(rpn_context & ctxt) {
         return rpn_operator_error::InvalidArgument;
     }
 
-    rpn_value result { rpn_float(fs_log10(conversion.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { _rpn_fmath_functions(data).log10(conversion.value()) };
 
     return 0;
 }
 
-rpn_error _rpn_exp(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+rpn_error _rpn_exp(void* data, const rpn_operator_args& args, rpn_value& out) {
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
 
-    rpn_value result { rpn_float(fs_exp(conversion.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { _rpn_fmath_functions(data).exp(conversion.value()) };
 
     return 0;
 }
 
-rpn_error _rpn_fmod(rpn_context & ctxt) {
-    auto b = rpn_stack_pop(ctxt);
-    auto a = rpn_stack_pop(ctxt);
-
-    auto convert_a = a.checkedToFloat();
+rpn_error _rpn_fmod(void*, const rpn_operator_args& args, rpn_value& out) {
+    auto convert_a = args[0].checkedToFloat();
     if (!convert_a.ok()) {
         return convert_a.error();
     }
 
-    auto convert_b = b.checkedToFloat();
+    auto convert_b = args[1].checkedToFloat();
     if (!convert_b.ok()) {
         return convert_b.error();
     }
@@ -115,74 +406,73 @@ rpn_error _rpn_fmod(rpn_context & ctxt) {
         return rpn_operator_error::InvalidArgument;
     }
 
-    rpn_value result { static_cast<rpn_float>(fs_fmod(convert_a.value(), convert_b.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { static_cast<rpn_float>(fs_fmod(convert_a.value(), convert_b.value())) };
 
     return 0;
 }
 
-rpn_error _rpn_pow(rpn_context & ctxt) {
-    auto b = rpn_stack_pop(ctxt);
-    auto a = rpn_stack_pop(ctxt);
-
-    auto convert_a = a.checkedToFloat();
+rpn_error _rpn_pow(void* data, const rpn_operator_args& args, rpn_value& out) {
+    auto convert_a = args[0].checkedToFloat();
     if (!convert_a.ok()) {
         return convert_a.error();
     }
 
-    auto convert_b = b.checkedToFloat();
+    auto convert_b = args[1].checkedToFloat();
     if (!convert_b.ok()) {
         return convert_b.error();
     }
 
-    rpn_value result { static_cast<rpn_float>(fs_pow(convert_a.value(), convert_b.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { _rpn_fmath_functions(data).pow(convert_a.value(), convert_b.value()) };
 
     return 0;
 }
 
-rpn_error _rpn_cos(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+rpn_error _rpn_cos(void* data, const rpn_operator_args& args, rpn_value& out) {
+    if (args[0].isFixed()) {
+        out = rpn_value { args[0].toFixed().cos() };
+        return 0;
+    }
+
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
 
-    rpn_value result { rpn_float(fs_cos(conversion.value())) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { _rpn_fmath_functions(data).cos(conversion.value()) };
 
     return 0;
 }
 
-rpn_error _rpn_sin(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+rpn_error _rpn_sin(void* data, const rpn_operator_args& args, rpn_value& out) {
+    if (args[0].isFixed()) {
+        out = rpn_value { args[0].toFixed().sin() };
+        return 0;
+    }
+
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
 
-    auto cos = fs_cos(conversion.value());
-
-    rpn_value result { rpn_float(fs_sqrt(1.0 - cos * cos)) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { _rpn_fmath_functions(data).sin(conversion.value()) };
 
     return 0;
 }
 
-rpn_error _rpn_tan(rpn_context & ctxt) {
-    auto a = rpn_stack_pop(ctxt);
-    auto conversion = a.checkedToFloat();
+rpn_error _rpn_tan(void* data, const rpn_operator_args& args, rpn_value& out) {
+    auto conversion = args[0].checkedToFloat();
     if (!conversion.ok()) {
         return conversion.error();
     }
 
-    auto cos = fs_cos(conversion.value());
+    const auto& functions = _rpn_fmath_functions(data);
+
+    auto cos = functions.cos(conversion.value());
     if (0.0 == cos) {
         return rpn_operator_error::InvalidArgument;
     }
 
-    rpn_value result { rpn_float(fs_sqrt(1.0 - cos * cos) / cos) };
-    rpn_stack_push(ctxt, std::move(result));
+    out = rpn_value { functions.sin(conversion.value()) / cos };
 
     return 0;
 }
@@ -190,17 +480,44 @@ rpn_error _rpn_tan(rpn_context & ctxt) {
 } // namespace anonymous
 
 bool rpn_operators_fmath_init(rpn_context & ctxt) {
+#if RPNLIB_FMATH_FAST
+    void* functions = &_rpn_fmath_fast;
+#else
+    void* functions = &_rpn_fmath_exact;
+#endif
+
     rpn_operator_set(ctxt, "sqrt", 1, _rpn_sqrt);
-    rpn_operator_set(ctxt, "log", 1, _rpn_log);
-    rpn_operator_set(ctxt, "log10", 1, _rpn_log10);
-    rpn_operator_set(ctxt, "exp", 1, _rpn_exp);
+    rpn_operator_set(ctxt, "log", 1, _rpn_log, functions);
+    rpn_operator_set(ctxt, "log10", 1, _rpn_log10, functions);
+    rpn_operator_set(ctxt, "exp", 1, _rpn_exp, functions);
     rpn_operator_set(ctxt, "fmod", 2, _rpn_fmod);
-    rpn_operator_set(ctxt, "pow", 2, _rpn_pow);
-    rpn_operator_set(ctxt, "cos", 1, _rpn_cos);
-    rpn_operator_set(ctxt, "sin", 1, _rpn_sin);
-    rpn_operator_set(ctxt, "tan", 1, _rpn_tan);
+    rpn_operator_set(ctxt, "pow", 2, _rpn_pow, functions);
+    rpn_operator_set(ctxt, "cos", 1, _rpn_cos, functions);
+    rpn_operator_set(ctxt, "sin", 1, _rpn_sin, functions);
+    rpn_operator_set(ctxt, "tan", 1, _rpn_tan, functions);
     return true;
 }
 
 #endif // ifdef RPNLIB_ADVANCED_MATH
 
+// Only replaces the user data of the operators registered by rpn_operators_fmath_init(), custom operators with the same name are not affected
+bool rpn_fmath(rpn_context & ctxt, rpn_fmath_mode mode) {
+#ifdef RPNLIB_ADVANCED_MATH
+    void* functions = (rpn_fmath_mode::Fast == mode)
+        ? &_rpn_fmath_fast
+        : &_rpn_fmath_exact;
+
+    for (auto& op : ctxt.operators) {
+        if ((op.data == &_rpn_fmath_fast) || (op.data == &_rpn_fmath_exact)) {
+            op.data = functions;
+        }
+    }
+
+    return true;
+#else
+    (void)ctxt;
+    (void)mode;
+    return false;
+#endif
+}
+
@@ -0,0 +1,52 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+// Approximations of the floating point math, using lookup tables and low-degree polynomials calculated in `float`.
+// Range reduction is done with `rpn_float`, so the error does not grow with the input magnitude.
+// Max error, measured against libm over the input domain:
+// - sin, cos: 1.5e-7 absolute, |x| <= 1e5
+// - tan: 2.5e-7 relative to max(1, |tan(x)|), where |cos(x)| >= 1e-3
+// - exp: 2e-7 relative, |x| <= 700
+// - log: 3e-8 absolute, x in [1e-300, 1e300]
+// - log10: 1.5e-8 absolute, same as log
+// - pow: 2e-7 * (1 + |y|) relative, x in [0.01, 100] and |y| <= 10
+// sin, cos and tan of NaN or infinity are NaN. Zero base of pow keeps its sign with odd integer exponents, same as std::pow
+rpn_float rpn_fmath_fast_sin(rpn_float);
+rpn_float rpn_fmath_fast_cos(rpn_float);
+rpn_float rpn_fmath_fast_tan(rpn_float);
+rpn_float rpn_fmath_fast_exp(rpn_float);
+rpn_float rpn_fmath_fast_log(rpn_float);
+rpn_float rpn_fmath_fast_log10(rpn_float);
+rpn_float rpn_fmath_fast_pow(rpn_float, rpn_float);
+
+// `Exact` uses fs_math routines, `Fast` uses the approximations above.
+// Default mode of the context is `Fast` when RPNLIB_FMATH_FAST is set
+enum class rpn_fmath_mode {
+    Exact,
+    Fast
+};
+
+bool rpn_fmath(rpn_context &, rpn_fmath_mode);
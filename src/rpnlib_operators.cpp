@@ -23,6 +23,9 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #include "rpnlib.h"
 #include "rpnlib_stack.h"
 #include "rpnlib_operators.h"
+#include "rpnlib_series.h"
+#include "rpnlib_sketch.h"
+#include "rpnlib_simd.h"
 
 extern "C" {
     #include "fs_math.h"
@@ -32,9 +35,11 @@ extern "C" {
 
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <utility>
 #include <cstdio>
+#include <type_traits>
 #include <utility>
 
 // These are from <cmath>
@@ -179,7 +184,59 @@ rpn_error _rpn_inf(rpn_context & ctxt) {
 // Operators accept [a b] and do `a` OPERATION `b`
 // Eats both stack values, resulting type depends on the type of `a`
 
+// Same checks as the rpn_value division
+rpn_value_error _rpn_math_single_divisor(float value) {
+    if (std::isinf(value) || std::isnan(value)) {
+        return rpn_value_error::IEEE754;
+    }
+
+    if (0.0f == value) {
+        return rpn_value_error::DivideByZero;
+    }
+
+    return rpn_value_error::Ok;
+}
+
+// Single precision contexts calculate in `float` when `a` is a floating point number, and `b` is any number except fixed-point.
+// Returns `false` when the generic rpn_value operator should be used instead
+template <typename Operation>
+bool _rpn_math_single(rpn_context & ctxt, rpn_error& error, bool divide, Operation&& operation) {
+    if ((rpn_float_precision::Single != ctxt.precision) || std::is_same<rpn_float, float>::value) {
+        return false;
+    }
+
+    const auto& lhs = _rpn_stack_peek(ctxt, 2);
+    const auto& rhs = _rpn_stack_peek(ctxt, 1);
+    if (!lhs.isFloat() || !(rhs.isFloat() || rhs.isInt() || rhs.isUint())) {
+        return false;
+    }
+
+    const auto a = static_cast<float>(lhs.toFloat());
+    const auto b = static_cast<float>(rhs.toFloat());
+
+    auto divisor = divide
+        ? _rpn_math_single_divisor(b)
+        : rpn_value_error::Ok;
+    if (rpn_value_error::Ok != divisor) {
+        _rpn_stack_eat(ctxt, 2);
+        error = divisor;
+        return true;
+    }
+
+    rpn_value result { static_cast<rpn_float>(operation(a, b)) };
+    _rpn_stack_eat(ctxt, 2);
+    rpn_stack_push(ctxt, std::move(result));
+    error = 0;
+
+    return true;
+}
+
 rpn_error _rpn_sum(rpn_context & ctxt) {
+    rpn_error error;
+    if (_rpn_math_single(ctxt, error, false, [](float a, float b) { return a + b; })) {
+        return error;
+    }
+
     auto result = _rpn_stack_peek(ctxt, 2) + _rpn_stack_peek(ctxt, 1);
     _rpn_stack_eat(ctxt, 2);
     if (result.isError()) {
@@ -190,6 +247,11 @@ rpn_error _rpn_sum(rpn_context & ctxt) {
 }
 
 rpn_error _rpn_substract(rpn_context & ctxt) {
+    rpn_error error;
+    if (_rpn_math_single(ctxt, error, false, [](float a, float b) { return a - b; })) {
+        return error;
+    }
+
     auto result = _rpn_stack_peek(ctxt, 2) - _rpn_stack_peek(ctxt, 1);
     _rpn_stack_eat(ctxt, 2);
     if (result.isError()) {
@@ -200,6 +262,11 @@ rpn_error _rpn_substract(rpn_context & ctxt) {
 }
 
 rpn_error _rpn_times(rpn_context & ctxt) {
+    rpn_error error;
+    if (_rpn_math_single(ctxt, error, false, [](float a, float b) { return a * b; })) {
+        return error;
+    }
+
     auto result = _rpn_stack_peek(ctxt, 2) * _rpn_stack_peek(ctxt, 1);
     _rpn_stack_eat(ctxt, 2);
     if (result.isError()) {
@@ -210,6 +277,11 @@ rpn_error _rpn_times(rpn_context & ctxt) {
 }
 
 rpn_error _rpn_divide(rpn_context & ctxt) {
+    rpn_error error;
+    if (_rpn_math_single(ctxt, error, true, [](float a, float b) { return a / b; })) {
+        return error;
+    }
+
     auto result = _rpn_stack_peek(ctxt, 2) / _rpn_stack_peek(ctxt, 1);
     _rpn_stack_eat(ctxt, 2);
     if (result.isError()) {
@@ -220,6 +292,11 @@ rpn_error _rpn_divide(rpn_context & ctxt) {
 }
 
 rpn_error _rpn_mod(rpn_context & ctxt) {
+    rpn_error error;
+    if (_rpn_math_single(ctxt, error, true, [](float a, float b) { return a - (std::floor(a / b) * b); })) {
+        return error;
+    }
+
     auto result = _rpn_stack_peek(ctxt, 2) % _rpn_stack_peek(ctxt, 1);
     _rpn_stack_eat(ctxt, 2);
     if (result.isError()) {
@@ -238,175 +315,1072 @@ rpn_error _rpn_abs(rpn_context & ctxt) {
         return 0;
     }
 
-    rpn_value result =
-        (top.isFloat()) ? rpn_value(rpnlib_abs(top.toFloat())) :
-        (top.isInt()) ? rpn_value(rpnlib_abs(top.toInt())) :
-        (rpn_value{});
+    rpn_value result =
+        (top.isFloat()) ? rpn_value(rpnlib_abs(top.toFloat())) :
+        (top.isInt()) ? rpn_value(rpnlib_abs(top.toInt())) :
+        (top.isFixed()) ? rpn_value(top.toFixed().abs()) :
+        (rpn_value{});
+
+    _rpn_stack_eat(ctxt, 1);
+    rpn_stack_push(ctxt, std::move(result));
+
+    return 0;
+}
+
+// Column kernels of the math operators, see rpn_process_batch() and rpnlib_simd.h
+
+void _rpn_sum_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_add(lhs, rhs, size);
+}
+
+void _rpn_substract_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_sub(lhs, rhs, size);
+}
+
+void _rpn_times_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_mul(lhs, rhs, size);
+}
+
+void _rpn_divide_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error* errors) {
+    rpn_simd_divisor(rhs, size, errors);
+    rpn_simd_div(lhs, rhs, size);
+}
+
+void _rpn_mod_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error* errors) {
+    rpn_simd_divisor(rhs, size, errors);
+    rpn_simd_mod(lhs, rhs, size);
+}
+
+void _rpn_abs_batch(rpn_float* lhs, const rpn_float*, size_t size, rpn_value_error*) {
+    rpn_simd_abs(lhs, size);
+}
+
+// ----------------------------------------------------------------------------
+// Logic
+// ----------------------------------------------------------------------------
+
+// Operators accept [a b] and do `a` OPERATION `b`
+// Pushes `boolean` value of the comparison
+// Eats both stack values
+
+rpn_error _rpn_eq(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_peek(ctxt, 2) == _rpn_stack_peek(ctxt, 1) };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, std::move(result));
+    return 0;
+}
+
+rpn_error _rpn_ne(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_peek(ctxt, 2) != _rpn_stack_peek(ctxt, 1) };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, std::move(result));
+    return 0;
+}
+
+rpn_error _rpn_gt(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_compare(ctxt) == 1 };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, std::move(result));
+    return 0;
+}
+
+rpn_error _rpn_ge(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_compare_or_eq(ctxt, 1) == 1 };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, result);
+    return 0;
+}
+
+rpn_error _rpn_lt(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_compare(ctxt) == -1 };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, result);
+    return 0;
+}
+
+rpn_error _rpn_le(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_compare_or_eq(ctxt, -1) == -1 };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, result);
+    return 0;
+}
+
+// Column kernels of the comparison operators, Boolean result of every row is either 1.0 or 0.0
+
+void _rpn_eq_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_compare(lhs, rhs, size, rpn_simd_comparison::Eq);
+}
+
+void _rpn_ne_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_compare(lhs, rhs, size, rpn_simd_comparison::Ne);
+}
+
+void _rpn_gt_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_compare(lhs, rhs, size, rpn_simd_comparison::Gt);
+}
+
+void _rpn_ge_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_compare(lhs, rhs, size, rpn_simd_comparison::Ge);
+}
+
+void _rpn_lt_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_compare(lhs, rhs, size, rpn_simd_comparison::Lt);
+}
+
+void _rpn_le_batch(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error*) {
+    rpn_simd_compare(lhs, rhs, size, rpn_simd_comparison::Le);
+}
+
+// ----------------------------------------------------------------------------
+// Advanced logic
+// ----------------------------------------------------------------------------
+
+// [a b] -> [c]
+// Where `c` is:
+// - -1 if `a` < `b`
+// - 1 if `a` > `b`
+// - 0 if `a` == `b`
+rpn_error _rpn_cmp(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_compare(ctxt) };
+    _rpn_stack_eat(ctxt, 2);
+    if (result.isError()) {
+        return result.toError();
+    }
+    rpn_stack_push(ctxt, result);
+    return 0;
+}
+
+// [a b c] -> [d]
+// Where `d` is
+// - -1 if `a` < `b`
+// - 1 if `a` > `c`
+// - 0 if none of the above match
+rpn_error _rpn_cmp3(rpn_context & ctxt) {
+    rpn_value result { _rpn_stack_compare3(ctxt) };
+    _rpn_stack_eat(ctxt, 3);
+    if (result.isError()) {
+        return result.toError();
+    }
+
+    rpn_stack_push(ctxt, result);
+    return 0;
+}
+
+// [a ... x] -> [y]
+// Allow indexed access for N+1 stack array, where:
+// - `x` is the array size
+// - ... next elements are members of the array
+// - `a` is the array[index] to push onto the stack
+// We eat all of the stack and push N'th element. When either index or array size is wrong, do nothing
+rpn_error _rpn_index(rpn_context & ctxt) {
+    auto& stack = ctxt.stack.get();
+    auto stack_size = stack.size();
+
+    // the expected size of the array
+    auto top = stack.end() - 1;
+
+    auto top_value = (*top).value.get();
+    if (!top_value->isNumber()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto size = top_value->checkedToUint();
+    if (!size.ok()) {
+        return size.error();
+    }
+
+    if ((stack_size - 1) < size.value() + 1) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    // the expected offset aka index
+    auto bottom = top - 1 - size.value();
+
+    auto bottom_value = (*bottom).value.get();
+    if (!bottom_value->isNumber()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto conversion = bottom_value->checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    auto offset = rpnlib_round(conversion.value());
+    if (offset >= 0.) {
+        if ((offset + 1) > size) {
+            return rpn_operator_error::InvalidArgument;
+        }
+    } else {
+        if (-offset > size) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        offset = size + offset;
+    }
+
+    auto pick = *(bottom + 1 + offset);
+    stack.erase(bottom, stack.end());
+    stack.push_back(pick);
+
+    return 0;
+}
+
+// [a ... x]
+// Array of N values, where `x` is the array size and `a ...` are the members.
+// Operators below work with the array in place and replace the whole array with a single value
+using rpn_array_iterator = rpn_nested_stack::stack_type::iterator;
+
+rpn_error _rpn_stack_array(rpn_context & ctxt, rpn_array_iterator& begin, rpn_array_iterator& end) {
+    auto& stack = ctxt.stack.get();
+
+    auto top_value = stack.back().value.get();
+    if (!top_value->isNumber()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto size = top_value->checkedToUint();
+    if (!size.ok()) {
+        return size.error();
+    }
+
+    if ((stack.size() - 1) < size.value()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    end = stack.end() - 1;
+    begin = end - size.value();
+
+    return 0;
+}
+
+void _rpn_stack_array_replace(rpn_context & ctxt, rpn_array_iterator begin, rpn_value&& value) {
+    auto& stack = ctxt.stack.get();
+    stack.erase(begin, stack.end());
+    stack.emplace_back(std::move(value));
+}
+
+template <typename T>
+T* _rpn_value_object(rpn_value&);
+
+template <>
+rpn_series* _rpn_value_object(rpn_value& value) {
+    return value.isSeries() ? &value.toSeries() : nullptr;
+}
+
+template <>
+rpn_sketch* _rpn_value_object(rpn_value& value) {
+    return value.isSketch() ? &value.toSketch() : nullptr;
+}
+
+// When the array operator receives a series or a sketch instead, it uses the pre-calculated result and replaces the object with it
+template <typename T, typename Callback>
+bool _rpn_stack_object(rpn_context & ctxt, Callback callback, rpn_error& error) {
+    auto& stack = ctxt.stack.get();
+    auto& top = stack.back();
+
+    auto* object = _rpn_value_object<T>(*top.value);
+    if (!object) {
+        return false;
+    }
+
+    rpn_value result;
+    error = callback(*object, result);
+    if (0 == error.code) {
+        stack.back() = rpn_stack_value(std::move(result));
+    }
+
+    return true;
+}
+
+// Values are gathered into a small block, which is then summed with independent accumulators (see rpn_simd_accumulate())
+rpn_error _rpn_array_accumulate(rpn_array_iterator begin, rpn_array_iterator end, rpn_float& out) {
+    constexpr size_t BlockSize { 16 };
+    rpn_float block[BlockSize];
+
+    rpn_float acc[4] { 0.0, 0.0, 0.0, 0.0 };
+
+    while (begin != end) {
+        size_t size = 0;
+        for (; (size < BlockSize) && (begin != end); ++size, ++begin) {
+            auto conversion = (*begin).value->checkedToFloat();
+            if (!conversion.ok()) {
+                return rpn_operator_error::InvalidType;
+            }
+            block[size] = conversion.value();
+        }
+
+        for (; size % 4; ++size) {
+            block[size] = 0.0;
+        }
+
+        rpn_simd_accumulate(block, size, acc);
+    }
+
+    out = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+
+    return 0;
+}
+
+// Arrays where every member has the same type are also gathered into blocks, and are reduced by the rpnlib_simd.h kernels.
+// NaN is never picked by `min` and `max` unless it is the first member, these arrays are checked one by one instead
+template <typename T>
+struct rpn_array_run;
+
+template <>
+struct rpn_array_run<rpn_float> {
+    static bool check(const rpn_value& value) {
+        return value.isFloat() && !std::isnan(value.toFloat());
+    }
+
+    static rpn_float get(const rpn_value& value) {
+        return value.toFloat();
+    }
+};
+
+template <>
+struct rpn_array_run<rpn_int> {
+    static bool check(const rpn_value& value) {
+        return value.isInt();
+    }
+
+    static rpn_int get(const rpn_value& value) {
+        return value.toInt();
+    }
+};
+
+template <>
+struct rpn_array_run<rpn_uint> {
+    static bool check(const rpn_value& value) {
+        return value.isUint();
+    }
+
+    static rpn_uint get(const rpn_value& value) {
+        return value.toUint();
+    }
+};
+
+template <typename T, typename Callback>
+bool _rpn_array_run(rpn_array_iterator begin, rpn_array_iterator end, Callback callback) {
+    if ((begin == end) || !std::all_of(begin, end, [](const rpn_stack_value& value) {
+        return rpn_array_run<T>::check(*value.value);
+    })) {
+        return false;
+    }
+
+    constexpr size_t BlockSize { 16 };
+    T block[BlockSize];
+
+    while (begin != end) {
+        size_t size = 0;
+        for (; (size < BlockSize) && (begin != end); ++size, ++begin) {
+            block[size] = rpn_array_run<T>::get(*(*begin).value);
+        }
+
+        callback(static_cast<const T*>(block), size);
+    }
+
+    return true;
+}
+
+template <typename T, bool Max>
+bool _rpn_array_run_pick(rpn_array_iterator begin, rpn_array_iterator end, rpn_value& out) {
+    bool first { true };
+    T result {};
+
+    if (!_rpn_array_run<T>(begin, end, [&](const T* block, size_t size) {
+        const T value = Max ? rpn_simd_max(block, size) : rpn_simd_min(block, size);
+        if (first || (Max ? (value > result) : (value < result))) {
+            result = value;
+            first = false;
+        }
+    })) {
+        return false;
+    }
+
+    out = rpn_value(result);
+    return true;
+}
+
+// Integers wrap around, same as with rpn_value::operator+
+template <typename T>
+bool _rpn_array_run_sum(rpn_array_iterator begin, rpn_array_iterator end, rpn_value& out) {
+    using unsigned_type = typename std::make_unsigned<T>::type;
+    unsigned_type result { 0 };
+
+    if (!_rpn_array_run<T>(begin, end, [&](const T* block, size_t size) {
+        result += static_cast<unsigned_type>(rpn_simd_sum(block, size));
+    })) {
+        return false;
+    }
+
+    out = rpn_value(static_cast<T>(result));
+    return true;
+}
+
+// Arrays without any Float members are summed one by one with rpn_value::operator+, same as the `+` operator would,
+// so the result keeps the type of the members and integer overflow is reported instead of being rounded away
+bool _rpn_array_exact(rpn_array_iterator begin, rpn_array_iterator end) {
+    for (auto it = begin; it != end; ++it) {
+        auto& value = *(*it).value;
+        if (value.isFloat() || !value.isNumber()) {
+            return false;
+        }
+    }
+
+    return begin != end;
+}
+
+rpn_error _rpn_array_fold(rpn_array_iterator begin, rpn_array_iterator end, rpn_value& out) {
+    out = *(*begin).value;
+    for (auto it = begin + 1; it != end; ++it) {
+        out = out + *(*it).value;
+        if (out.isError()) {
+            return out.toError();
+        }
+    }
+
+    return 0;
+}
+
+// [a ... x] -> [y]
+// where `y` is the sum of all array members. Float when any of the members is a Float (or when the array is empty), otherwise the type of the members
+rpn_error _rpn_array_sum(rpn_context & ctxt) {
+    rpn_error object_error;
+    if (_rpn_stack_object<rpn_series>(ctxt, [](const rpn_series& series, rpn_value& out) -> rpn_error {
+        out = rpn_value(series.sum());
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
+
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
+    }
+
+    if (_rpn_array_exact(begin, end)) {
+        rpn_value result;
+        if (!_rpn_array_run_sum<rpn_int>(begin, end, result) && !_rpn_array_run_sum<rpn_uint>(begin, end, result)) {
+            error = _rpn_array_fold(begin, end, result);
+            if (0 != error.code) {
+                return error;
+            }
+        }
+
+        _rpn_stack_array_replace(ctxt, begin, std::move(result));
+        return 0;
+    }
+
+    rpn_float sum;
+    error = _rpn_array_accumulate(begin, end, sum);
+    if (0 != error.code) {
+        return error;
+    }
+
+    _rpn_stack_array_replace(ctxt, begin, rpn_value(sum));
+
+    return 0;
+}
+
+// [a ... x] -> [y]
+// where `y` (float) is the arithmetic mean of all array members. Array must not be empty
+rpn_error _rpn_array_avg(rpn_context & ctxt) {
+    rpn_error object_error;
+    if (_rpn_stack_object<rpn_series>(ctxt, [](const rpn_series& series, rpn_value& out) -> rpn_error {
+        if (!series.size()) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        out = rpn_value(series.mean());
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
+
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
+    }
+
+    if (begin == end) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    rpn_float sum;
+    error = _rpn_array_accumulate(begin, end, sum);
+    if (0 != error.code) {
+        return error;
+    }
+
+    rpn_float avg = sum / static_cast<rpn_float>(end - begin);
+    _rpn_stack_array_replace(ctxt, begin, rpn_value(avg));
+
+    return 0;
+}
+
+// [a ... x] -> [y]
+// where `y` is either the smallest or the largest array member. Array must not be empty, and contain only numbers
+template <bool Max>
+rpn_error _rpn_array_pick(rpn_context & ctxt) {
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
+
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
+    }
+
+    if (begin == end) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    rpn_value run;
+    if (_rpn_array_run_pick<rpn_float, Max>(begin, end, run)
+        || _rpn_array_run_pick<rpn_int, Max>(begin, end, run)
+        || _rpn_array_run_pick<rpn_uint, Max>(begin, end, run)) {
+        _rpn_stack_array_replace(ctxt, begin, std::move(run));
+        return 0;
+    }
+
+    auto pick = begin;
+    for (auto it = begin; it != end; ++it) {
+        auto& value = *(*it).value;
+        if (!value.isNumber()) {
+            return rpn_operator_error::InvalidType;
+        }
+        if (Max ? (value > *(*pick).value) : (value < *(*pick).value)) {
+            pick = it;
+        }
+    }
+
+    rpn_value result(*(*pick).value);
+    _rpn_stack_array_replace(ctxt, begin, std::move(result));
+
+    return 0;
+}
+
+rpn_error _rpn_array_min(rpn_context & ctxt) {
+    rpn_error object_error;
+    if (_rpn_stack_object<rpn_series>(ctxt, [](const rpn_series& series, rpn_value& out) -> rpn_error {
+        if (!series.size()) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        out = rpn_value(series.min());
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    if (_rpn_stack_object<rpn_sketch>(ctxt, [](rpn_sketch& sketch, rpn_value& out) -> rpn_error {
+        if (!sketch.count()) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        out = rpn_value(sketch.min());
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    return _rpn_array_pick<false>(ctxt);
+}
+
+rpn_error _rpn_array_max(rpn_context & ctxt) {
+    rpn_error object_error;
+    if (_rpn_stack_object<rpn_series>(ctxt, [](const rpn_series& series, rpn_value& out) -> rpn_error {
+        if (!series.size()) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        out = rpn_value(series.max());
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    if (_rpn_stack_object<rpn_sketch>(ctxt, [](rpn_sketch& sketch, rpn_value& out) -> rpn_error {
+        if (!sketch.count()) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        out = rpn_value(sketch.max());
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    return _rpn_array_pick<true>(ctxt);
+}
+
+// [a ... x] -> [x]
+// where `x` is the size of the array
+rpn_error _rpn_array_count(rpn_context & ctxt) {
+    rpn_error object_error;
+    if (_rpn_stack_object<rpn_series>(ctxt, [](const rpn_series& series, rpn_value& out) -> rpn_error {
+        out = rpn_value(static_cast<rpn_uint>(series.size()));
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    if (_rpn_stack_object<rpn_sketch>(ctxt, [](rpn_sketch& sketch, rpn_value& out) -> rpn_error {
+        out = rpn_value(static_cast<rpn_uint>(sketch.count()));
+        return 0;
+    }, object_error)) {
+        return object_error;
+    }
+
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
+
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
+    }
+
+    rpn_uint count = end - begin;
+    _rpn_stack_array_replace(ctxt, begin, rpn_value(count));
+
+    return 0;
+}
+
+// [a] -> [s]
+// Creates an empty series, which can hold up to `a` samples
+rpn_error _rpn_series(rpn_context & ctxt) {
+    auto& top = _rpn_stack_peek(ctxt);
+
+    auto capacity = top.checkedToUint();
+    if (!capacity.ok()) {
+        return capacity.error();
+    }
+
+    if (!capacity.value()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    _rpn_stack_eat(ctxt);
+    rpn_stack_push(ctxt, rpn_value(rpn_series(capacity.value())));
+
+    return 0;
+}
+
+// [a s] -> [s]
+// Appends `a` to the series or the sketch `s`. When the series is full, the oldest sample is removed.
+// Object is modified in place, so `s` is usually a variable reference
+rpn_error _rpn_push(rpn_context & ctxt) {
+    auto& top = _rpn_stack_peek(ctxt, 1);
+    if (!top.isSeries() && !top.isSketch()) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto conversion = _rpn_stack_peek(ctxt, 2).checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    auto& stack = ctxt.stack.get();
+    ctxt.stack.aggregate_save(stack.back().value);
+
+    if (top.isSeries()) {
+        top.toSeries().push(conversion.value());
+    } else {
+        top.toSketch().push(conversion.value());
+    }
+
+    stack.erase(stack.end() - 2);
+
+    return 0;
+}
+
+// [s a] -> [b ... x]
+// Pushes `a` newest samples of the series `s` onto the stack as an array, oldest first
+rpn_error _rpn_series_last(rpn_context & ctxt) {
+    auto& prev = _rpn_stack_peek(ctxt, 2);
+    if (!prev.isSeries()) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto count = _rpn_stack_peek(ctxt, 1).checkedToUint();
+    if (!count.ok()) {
+        return count.error();
+    }
+
+    auto& stack = ctxt.stack.get();
+
+    // series object itself needs to outlive it's stack slot
+    auto ptr = (*(stack.end() - 2)).value;
+    auto& series = ptr->toSeries();
+    if (count.value() > series.size()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    _rpn_stack_eat(ctxt, 2);
+
+    for (size_t index = series.size() - count.value(); index < series.size(); ++index) {
+        stack.emplace_back(rpn_value(series.at(index)));
+    }
+
+    stack.emplace_back(
+        rpn_stack_value::Type::Array,
+        rpn_value(static_cast<rpn_uint>(count.value()))
+    );
+
+    return 0;
+}
+
+// [a] -> [s]
+// Creates an empty quantile sketch, where `a` is the compression parameter. Sketch memory grows linearly with it,
+// while the error of the estimated quantiles decreases
+rpn_error _rpn_sketch(rpn_context & ctxt) {
+    auto& top = _rpn_stack_peek(ctxt);
+
+    auto compression = top.checkedToUint();
+    if (!compression.ok()) {
+        return compression.error();
+    }
+
+    if (compression.value() < 2) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    _rpn_stack_eat(ctxt);
+    rpn_stack_push(ctxt, rpn_value(rpn_sketch(compression.value())));
+
+    return 0;
+}
+
+// [s t] -> [s]
+// Merges the sketch `t` into the sketch `s`
+rpn_error _rpn_sketch_merge(rpn_context & ctxt) {
+    auto& top = _rpn_stack_peek(ctxt, 1);
+    auto& prev = _rpn_stack_peek(ctxt, 2);
+    if (!top.isSketch() || !prev.isSketch()) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto& stack = ctxt.stack.get();
+    ctxt.stack.aggregate_save((*(stack.end() - 2)).value);
+
+    prev.toSketch().merge(top.toSketch());
+    _rpn_stack_eat(ctxt);
+
+    return 0;
+}
+
+rpn_error _rpn_sketch_quantile(rpn_context & ctxt, rpn_float q) {
+    if (!(q >= 0.0) || (q > 1.0)) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto& sketch = _rpn_stack_peek(ctxt, 2).toSketch();
+    if (!sketch.count()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    rpn_value result(sketch.quantile(q));
+
+    _rpn_stack_eat(ctxt, 2);
+    rpn_stack_push(ctxt, std::move(result));
+
+    return 0;
+}
+
+// [s q] -> [a]
+// Where `a` (float) is the estimated `q`-th quantile of the sketch `s`, `q` is between 0 and 1
+rpn_error _rpn_quantile(rpn_context & ctxt) {
+    if (!_rpn_stack_peek(ctxt, 2).isSketch()) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto conversion = _rpn_stack_peek(ctxt, 1).checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    return _rpn_sketch_quantile(ctxt, conversion.value());
+}
+
+// [p s] -> [a]
+// Same as `quantile`, but with the arguments in the same order as the array `percentile`
+rpn_error _rpn_sketch_percentile(rpn_context & ctxt) {
+    auto& stack = ctxt.stack.get();
+    if (stack.size() < 2) {
+        return rpn_operator_error::ArgumentCountMismatch;
+    }
+
+    auto conversion = _rpn_stack_peek(ctxt, 2).checkedToFloat();
+    if (!conversion.ok()) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    std::iter_swap(stack.end() - 1, stack.end() - 2);
+
+    return _rpn_sketch_quantile(ctxt, conversion.value() / 100.0);
+}
+
+// Operators below select the N'th smallest value from the array, using the introselect provided by std::nth_element.
+// Every member is converted into a float key once, and the selection runs over the keys. Comparing the values themselves
+// would convert every pair differently and use the operator== epsilon, which is not a strict weak ordering for mixed arrays.
+// Key remembers the position of the member, so the selected member can be used as-is.
+// Array must only contain numbers and must not contain NaN
+struct rpn_array_key {
+    rpn_float value;
+    size_t index;
+
+    bool operator<(const rpn_array_key& other) const {
+        return (value < other.value)
+            || ((value == other.value) && (index < other.index));
+    }
+};
+
+// Keys of the small arrays are kept right here, larger arrays use the vector
+struct rpn_array_keys {
+    rpn_array_keys() = default;
+    rpn_array_keys(const rpn_array_keys&) = delete;
+    rpn_array_keys& operator=(const rpn_array_keys&) = delete;
+
+    void reset(size_t size) {
+        if (size > Size) {
+            _heap.resize(size);
+            _data = _heap.data();
+        } else {
+            _data = _buffer;
+        }
+        _size = size;
+    }
+
+    rpn_array_key* begin() {
+        return _data;
+    }
+
+    rpn_array_key* end() {
+        return _data + _size;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    private:
+
+    static constexpr size_t Size = RPNLIB_ARRAY_SELECT_SIZE;
+
+    rpn_array_key _buffer[Size];
+    std::vector<rpn_array_key> _heap;
+    rpn_array_key* _data { _buffer };
+    size_t _size { 0 };
+};
+
+rpn_error _rpn_array_keys(rpn_array_iterator begin, rpn_array_iterator end, rpn_array_keys& keys) {
+    keys.reset(end - begin);
+
+    auto* key = keys.begin();
+    for (auto it = begin; it != end; ++it, ++key) {
+        auto& value = *(*it).value;
+        if (!value.isNumber()) {
+            return rpn_operator_error::InvalidType;
+        }
+
+        auto conversion = value.checkedToFloat();
+        if (!conversion.ok()) {
+            return conversion.error();
+        }
+
+        if (std::isnan(conversion.value())) {
+            return rpn_value_error::IEEE754;
+        }
 
-    _rpn_stack_eat(ctxt, 1);
-    rpn_stack_push(ctxt, std::move(result));
+        key->value = conversion.value();
+        key->index = it - begin;
+    }
 
     return 0;
 }
 
-// ----------------------------------------------------------------------------
-// Logic
-// ----------------------------------------------------------------------------
+const rpn_array_key& _rpn_array_select(rpn_array_keys& keys, size_t nth) {
+    auto* pick = keys.begin() + nth;
+    std::nth_element(keys.begin(), pick, keys.end());
+    return *pick;
+}
 
-// Operators accept [a b] and do `a` OPERATION `b`
-// Pushes `boolean` value of the comparison
-// Eats both stack values
+// After selecting N'th element, every element after it is not less than it. Thus, N+1'th is the smallest one of those
+const rpn_array_key& _rpn_array_select_next(rpn_array_keys& keys, size_t nth) {
+    return *std::min_element(keys.begin() + nth + 1, keys.end());
+}
 
-rpn_error _rpn_eq(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_peek(ctxt, 2) == _rpn_stack_peek(ctxt, 1) };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+// Same as with `index`, some operators expect an additional argument right below the array
+rpn_error _rpn_stack_array_arg(rpn_context & ctxt, rpn_array_iterator begin, rpn_float& out) {
+    auto& stack = ctxt.stack.get();
+    if (begin == stack.begin()) {
+        return rpn_operator_error::ArgumentCountMismatch;
     }
-    rpn_stack_push(ctxt, std::move(result));
-    return 0;
-}
 
-rpn_error _rpn_ne(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_peek(ctxt, 2) != _rpn_stack_peek(ctxt, 1) };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+    auto& value = *(*(begin - 1)).value;
+    if (!value.isNumber()) {
+        return rpn_operator_error::InvalidArgument;
     }
-    rpn_stack_push(ctxt, std::move(result));
-    return 0;
-}
 
-rpn_error _rpn_gt(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_compare(ctxt) == 1 };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+    auto conversion = value.checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
     }
-    rpn_stack_push(ctxt, std::move(result));
+
+    out = conversion.value();
+
     return 0;
 }
 
-rpn_error _rpn_ge(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_compare_or_eq(ctxt, 1) == 1 };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+// [a ... x] -> [y]
+// where `y` (float) is the median of the array. When array size is even, `y` is the mean of two middle elements
+rpn_error _rpn_array_median(rpn_context & ctxt) {
+    rpn_error object_error;
+    if (_rpn_stack_object<rpn_sketch>(ctxt, [](rpn_sketch& sketch, rpn_value& out) -> rpn_error {
+        if (!sketch.count()) {
+            return rpn_operator_error::InvalidArgument;
+        }
+        out = rpn_value(sketch.quantile(0.5));
+        return 0;
+    }, object_error)) {
+        return object_error;
     }
-    rpn_stack_push(ctxt, result);
-    return 0;
-}
 
-rpn_error _rpn_lt(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_compare(ctxt) == -1 };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
+
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
     }
-    rpn_stack_push(ctxt, result);
-    return 0;
-}
 
-rpn_error _rpn_le(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_compare_or_eq(ctxt, -1) == -1 };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+    if (begin == end) {
+        return rpn_operator_error::InvalidArgument;
     }
-    rpn_stack_push(ctxt, result);
-    return 0;
-}
 
-// ----------------------------------------------------------------------------
-// Advanced logic
-// ----------------------------------------------------------------------------
+    rpn_array_keys keys;
+    error = _rpn_array_keys(begin, end, keys);
+    if (0 != error.code) {
+        return error;
+    }
 
-// [a b] -> [c]
-// Where `c` is:
-// - -1 if `a` < `b`
-// - 1 if `a` > `b`
-// - 0 if `a` == `b`
-rpn_error _rpn_cmp(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_compare(ctxt) };
-    _rpn_stack_eat(ctxt, 2);
-    if (result.isError()) {
-        return result.toError();
+    size_t size = keys.size();
+    size_t middle = (size - 1) / 2;
+
+    rpn_float median = _rpn_array_select(keys, middle).value;
+    if (!(size % 2)) {
+        median = (median + _rpn_array_select_next(keys, middle).value) / 2.0;
     }
-    rpn_stack_push(ctxt, result);
+
+    _rpn_stack_array_replace(ctxt, begin, rpn_value(median));
+
     return 0;
 }
 
-// [a b c] -> [d]
-// Where `d` is
-// - -1 if `a` < `b`
-// - 1 if `a` > `c`
-// - 0 if none of the above match
-rpn_error _rpn_cmp3(rpn_context & ctxt) {
-    rpn_value result { _rpn_stack_compare3(ctxt) };
-    _rpn_stack_eat(ctxt, 3);
-    if (result.isError()) {
-        return result.toError();
+// [p a ... x] -> [y]
+// where `y` (float) is the `p`-th percentile of the array, `p` is between 0 and 100.
+// Linearly interpolates between two closest ranks, when `p` does not fall on one exactly
+rpn_error _rpn_array_percentile(rpn_context & ctxt) {
+    if (_rpn_stack_peek(ctxt).isSketch()) {
+        return _rpn_sketch_percentile(ctxt);
     }
 
-    rpn_stack_push(ctxt, result);
-    return 0;
-}
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
 
-// [a ... x] -> [y]
-// Allow indexed access for N+1 stack array, where:
-// - `x` is the array size
-// - ... next elements are members of the array
-// - `a` is the array[index] to push onto the stack
-// We eat all of the stack and push N'th element. When either index or array size is wrong, do nothing
-rpn_error _rpn_index(rpn_context & ctxt) {
-    auto& stack = ctxt.stack.get();
-    auto stack_size = stack.size();
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
+    }
 
-    // the expected size of the array
-    auto top = stack.end() - 1;
+    rpn_float percent;
+    error = _rpn_stack_array_arg(ctxt, begin, percent);
+    if (0 != error.code) {
+        return error;
+    }
 
-    auto top_value = (*top).value.get();
-    if (!top_value->isNumber()) {
+    if ((begin == end) || !(percent >= 0.0) || (percent > 100.0)) {
         return rpn_operator_error::InvalidArgument;
     }
 
-    auto size = top_value->checkedToUint();
-    if (!size.ok()) {
-        return size.error();
+    rpn_array_keys keys;
+    error = _rpn_array_keys(begin, end, keys);
+    if (0 != error.code) {
+        return error;
     }
 
-    if ((stack_size - 1) < size.value() + 1) {
-        return rpn_operator_error::InvalidArgument;
+    rpn_float rank = (percent / 100.0) * static_cast<rpn_float>(keys.size() - 1);
+    size_t lower = std::floor(rank);
+    rpn_float fraction = rank - static_cast<rpn_float>(lower);
+
+    rpn_float result = _rpn_array_select(keys, lower).value;
+    if (fraction > 0.0) {
+        result += (_rpn_array_select_next(keys, lower).value - result) * fraction;
     }
 
-    // the expected offset aka index
-    auto bottom = top - 1 - size.value();
+    _rpn_stack_array_replace(ctxt, begin - 1, rpn_value(result));
 
-    auto bottom_value = (*bottom).value.get();
-    if (!bottom_value->isNumber()) {
-        return rpn_operator_error::InvalidArgument;
+    return 0;
+}
+
+// [n a ... x] -> [y]
+// where `y` is the `n`-th smallest element of the array (starting from 0), as if the array was sorted.
+// Negative `n` starts from the largest element, same as the `index` operator
+rpn_error _rpn_array_nth(rpn_context & ctxt) {
+    rpn_array_iterator begin;
+    rpn_array_iterator end;
+
+    auto error = _rpn_stack_array(ctxt, begin, end);
+    if (0 != error.code) {
+        return error;
     }
 
-    auto conversion = bottom_value->checkedToFloat();
-    if (!conversion.ok()) {
-        return conversion.error();
+    rpn_float offset;
+    error = _rpn_stack_array_arg(ctxt, begin, offset);
+    if (0 != error.code) {
+        return error;
     }
 
-    auto offset = rpnlib_round(conversion.value());
-    if (offset >= 0.) {
-        if ((offset + 1) > size) {
-            return rpn_operator_error::InvalidArgument;
-        }
-    } else {
-        if (-offset > size) {
-            return rpn_operator_error::InvalidArgument;
-        }
+    offset = rpnlib_round(offset);
+
+    rpn_float size = end - begin;
+    if (offset < 0.) {
         offset = size + offset;
     }
 
-    auto pick = *(bottom + 1 + offset);
-    stack.erase(bottom, stack.end());
-    stack.push_back(pick);
+    if ((offset < 0.) || (offset >= size)) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    rpn_array_keys keys;
+    error = _rpn_array_keys(begin, end, keys);
+    if (0 != error.code) {
+        return error;
+    }
+
+    // result is the member itself, keeping its type
+    const auto& key = _rpn_array_select(keys, static_cast<size_t>(offset));
+
+    rpn_value result(*(*(begin + key.index)).value);
+    _rpn_stack_array_replace(ctxt, begin - 1, std::move(result));
 
     return 0;
 }
@@ -539,6 +1513,14 @@ rpn_error _rpn_round(rpn_context & ctxt) {
         return conversion.error();
     }
 
+    // fixed-point values are rounded using integer math and keep their type
+    if (value.isFixed()) {
+        rpn_value result { value.toFixed().round(decimals.toInt()) };
+        _rpn_stack_eat(ctxt, 2);
+        rpn_stack_push(ctxt, std::move(result));
+        return 0;
+    }
+
     rpn_float limit = rpnlib_round(conversion.value());
     rpn_float multiplier = 1.0;
     for (int i = 0; i < limit; ++i) {
@@ -564,7 +1546,9 @@ rpn_error _rpn_ceil(rpn_context & ctxt) {
         return rpn_operator_error::InvalidType;
     }
 
-    rpn_value result { ceil(value.toFloat()) };
+    rpn_value result = value.isFixed()
+        ? rpn_value(value.toFixed().ceil())
+        : rpn_value(ceil(value.toFloat()));
     _rpn_stack_eat(ctxt, 1);
     rpn_stack_push(ctxt, std::move(result));
     return 0;
@@ -578,7 +1562,9 @@ rpn_error _rpn_floor(rpn_context & ctxt) {
         return rpn_operator_error::InvalidType;
     }
 
-    rpn_value result { std::floor(value.toFloat()) };
+    rpn_value result = value.isFixed()
+        ? rpn_value(value.toFixed().floor())
+        : rpn_value(std::floor(value.toFloat()));
     _rpn_stack_eat(ctxt, 1);
     rpn_stack_push(ctxt, std::move(result));
     return 0;
@@ -591,8 +1577,7 @@ rpn_error _rpn_floor(rpn_context & ctxt) {
 // [a b c] -> [b] when a resolves `true`
 // [a b c] -> [c] when a resolves `false`
 //
-// Note: classing forth has `if`, `then` and `else`, which place unresolved *forward* reference on the stack
-//       thus, having an ability to have 'delayed' expressions inside `then` and `else`
+// Note: both `b` and `c` are already evaluated at this point. Use `a if b else c then` to only evaluate one of them
 rpn_error _rpn_ifn(rpn_context & ctxt) {
     auto& stack = ctxt.stack.get();
 
@@ -736,6 +1721,83 @@ rpn_error _rpn_assign(rpn_context & ctxt) {
     return 0;
 }
 
+// ----------------------------------------------------------------------------
+// Memoization of pure operators
+// ----------------------------------------------------------------------------
+
+// Integer 1, Unsigned 1 and Float 1.0 are all equal when compared with rpn_value::operator==(),
+// but the operator may produce a different result for each one of them.
+// Floats are compared by their bits, since the operator== epsilon would treat 1e-20 and 3e-20, or 0.0 and -0.0, as the same key
+bool _rpn_memo_same(const rpn_value& lhs, const rpn_value& rhs) {
+    if (lhs.type != rhs.type) {
+        return false;
+    }
+
+    if (lhs.isFloat()) {
+        const rpn_float lhs_float = lhs.toFloat();
+        const rpn_float rhs_float = rhs.toFloat();
+        return 0 == std::memcmp(&lhs_float, &rhs_float, sizeof(rpn_float));
+    }
+
+    return lhs == rhs;
+}
+
+bool _rpn_memo_match(const rpn_operator_memo::entry_type& entry, const rpn_operator_args& args) {
+    for (size_t index = 0; index < args.size(); ++index) {
+        if (!_rpn_memo_same(entry.args[index], args[index])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+rpn_operator_memo* _rpn_operator_memo(rpn_context & ctxt, const char* name) {
+    auto result = std::find_if(ctxt.operators.begin(), ctxt.operators.end(), [name](const rpn_operator& op) {
+        return op.name.equals(name);
+    });
+
+    if (result != ctxt.operators.end()) {
+        return (*result).memo.get();
+    }
+
+    return nullptr;
+}
+
+// Most recently used entry is moved to the front, the last one is evicted when there is no more space
+rpn_error _rpn_operator_memo_call(rpn_operator_memo& memo, const rpn_operator& op, const rpn_operator_args& args, rpn_value& out) {
+    auto& entries = memo.entries;
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (_rpn_memo_match(*it, args)) {
+            ++memo.hits;
+            entries.splice(entries.begin(), entries, it);
+            out = entries.front().result;
+            return 0;
+        }
+    }
+
+    ++memo.misses;
+
+    rpn_error error = op.args_callback(op.data, args, out);
+    if ((0 != error.code) || out.isError()) {
+        return error;
+    }
+
+    if (entries.size() >= memo.capacity) {
+        entries.pop_back();
+    }
+
+    std::vector<rpn_value> key;
+    key.reserve(args.size());
+    for (size_t index = 0; index < args.size(); ++index) {
+        key.push_back(args[index]);
+    }
+
+    entries.push_front(rpn_operator_memo::entry_type{std::move(key), out});
+
+    return 0;
+}
+
 } // namespace anonymous
 
 // ----------------------------------------------------------------------------
@@ -745,7 +1807,17 @@ rpn_error _rpn_assign(rpn_context & ctxt) {
 rpn_operator::rpn_operator(const char* name, unsigned char argc, callback_type callback) :
     name(name),
     argc(argc),
-    callback(callback)
+    callback(callback),
+    args_callback(nullptr),
+    data(nullptr)
+{}
+
+rpn_operator::rpn_operator(const char* name, unsigned char argc, args_callback_type callback, void* data) :
+    name(name),
+    argc(argc),
+    callback(nullptr),
+    args_callback(callback),
+    data(data)
 {}
 
 bool rpn_operator_set(rpn_context & ctxt, const char * name, unsigned char argc, rpn_operator::callback_type callback) {
@@ -753,6 +1825,117 @@ bool rpn_operator_set(rpn_context & ctxt, const char * name, unsigned char argc,
     return true;
 }
 
+bool rpn_operator_set(rpn_context & ctxt, const char * name, unsigned char argc, rpn_operator::args_callback_type callback, void* data) {
+    ctxt.operators.emplace_front(name, argc, callback, data);
+    return true;
+}
+
+bool rpn_operator_set_pure(rpn_context & ctxt, const char * name, unsigned char argc, rpn_operator::args_callback_type callback, void* data, size_t memo_size) {
+    if (!memo_size) {
+        return false;
+    }
+
+    ctxt.operators.emplace_front(name, argc, callback, data);
+    ctxt.operators.front().memo.reset(new rpn_operator_memo(memo_size));
+
+    return true;
+}
+
+bool rpn_operator_set_batch(rpn_context & ctxt, const char * name, rpn_operator::batch_callback_type callback, rpn_value::Type result_type) {
+    if ((rpn_value::Type::Float != result_type) && (rpn_value::Type::Boolean != result_type)) {
+        return false;
+    }
+
+    auto result = std::find_if(ctxt.operators.begin(), ctxt.operators.end(), [name](const rpn_operator& op) {
+        return op.name.equals(name);
+    });
+
+    if ((result == ctxt.operators.end()) || !(*result).argc || ((*result).argc > 2)) {
+        return false;
+    }
+
+    (*result).batch_callback = callback;
+    (*result).batch_result = result_type;
+
+    return true;
+}
+
+bool rpn_operator_memo_stats(rpn_context & ctxt, const char * name, size_t& hits, size_t& misses) {
+    auto* memo = _rpn_operator_memo(ctxt, name);
+    if (!memo) {
+        return false;
+    }
+
+    hits = memo->hits;
+    misses = memo->misses;
+
+    return true;
+}
+
+bool rpn_operator_memo_clear(rpn_context & ctxt, const char * name) {
+    auto* memo = _rpn_operator_memo(ctxt, name);
+    if (!memo) {
+        return false;
+    }
+
+    memo->entries.clear();
+    memo->hits = 0;
+    memo->misses = 0;
+
+    return true;
+}
+
+// [a b ...] -> [c]
+// When operator uses arguments view, we replace the bottom-most argument with the result and remove everything above it.
+// Argument value is re-used when nothing else refers to it, saving the allocation of the new one.
+rpn_error rpn_operator_call(rpn_context & ctxt, const rpn_operator& op) {
+    auto& stack = ctxt.stack.get();
+    if (op.argc > stack.size()) {
+        return rpn_operator_error::ArgumentCountMismatch;
+    }
+
+    if (op.callback) {
+        return op.callback(ctxt);
+    }
+
+    auto begin = stack.end() - op.argc;
+    rpn_operator_args args(stack.data() + (stack.size() - op.argc), op.argc);
+
+    rpn_value out;
+    // operator may belong to the parent context, which is shared with the other threads
+    if (op.memo && !ctxt.parent) {
+        rpn_error error = _rpn_operator_memo_call(*op.memo, op, args, out);
+        if (0 != error.code) {
+            return error;
+        }
+    } else {
+        rpn_error error = op.args_callback(op.data, args, out);
+        if (0 != error.code) {
+            return error;
+        }
+    }
+
+    if (out.isError()) {
+        return out.toError();
+    }
+
+    if (!op.argc) {
+        stack.emplace_back(std::move(out));
+        return 0;
+    }
+
+    auto& slot = *begin;
+    if ((slot.type == rpn_stack_value::Type::Value) && (slot.value.use_count() == 1)) {
+        *slot.value = std::move(out);
+    } else {
+        slot = rpn_stack_value(std::move(out));
+    }
+
+    stack.erase(begin + 1, stack.end());
+
+    return 0;
+}
+
 bool rpn_operators_clear(rpn_context & ctxt) {
     ctxt.operators.clear();
     return true;
@@ -778,6 +1961,13 @@ bool rpn_operators_init(rpn_context & ctxt) {
     rpn_operator_set(ctxt, "mod", 2, _rpn_mod);
     rpn_operator_set(ctxt, "abs", 1, _rpn_abs);
 
+    rpn_operator_set_batch(ctxt, "+", _rpn_sum_batch);
+    rpn_operator_set_batch(ctxt, "-", _rpn_substract_batch);
+    rpn_operator_set_batch(ctxt, "*", _rpn_times_batch);
+    rpn_operator_set_batch(ctxt, "/", _rpn_divide_batch);
+    rpn_operator_set_batch(ctxt, "mod", _rpn_mod_batch);
+    rpn_operator_set_batch(ctxt, "abs", _rpn_abs_batch);
+
     rpn_operator_set(ctxt, "round", 2, _rpn_round);
     rpn_operator_set(ctxt, "ceil", 1, _rpn_ceil);
     rpn_operator_set(ctxt, "floor", 1, _rpn_floor);
@@ -790,9 +1980,32 @@ bool rpn_operators_init(rpn_context & ctxt) {
     rpn_operator_set(ctxt, "lt", 2, _rpn_lt);
     rpn_operator_set(ctxt, "le", 2, _rpn_le);
 
+    rpn_operator_set_batch(ctxt, "eq", _rpn_eq_batch, rpn_value::Type::Boolean);
+    rpn_operator_set_batch(ctxt, "ne", _rpn_ne_batch, rpn_value::Type::Boolean);
+    rpn_operator_set_batch(ctxt, "gt", _rpn_gt_batch, rpn_value::Type::Boolean);
+    rpn_operator_set_batch(ctxt, "ge", _rpn_ge_batch, rpn_value::Type::Boolean);
+    rpn_operator_set_batch(ctxt, "lt", _rpn_lt_batch, rpn_value::Type::Boolean);
+    rpn_operator_set_batch(ctxt, "le", _rpn_le_batch, rpn_value::Type::Boolean);
+
     rpn_operator_set(ctxt, "cmp", 2, _rpn_cmp);
     rpn_operator_set(ctxt, "cmp3", 3, _rpn_cmp3);
     rpn_operator_set(ctxt, "index", 1, _rpn_index);
+    rpn_operator_set(ctxt, "sum", 1, _rpn_array_sum);
+    rpn_operator_set(ctxt, "avg", 1, _rpn_array_avg);
+    rpn_operator_set(ctxt, "min", 1, _rpn_array_min);
+    rpn_operator_set(ctxt, "max", 1, _rpn_array_max);
+    rpn_operator_set(ctxt, "count", 1, _rpn_array_count);
+    rpn_operator_set(ctxt, "median", 1, _rpn_array_median);
+    rpn_operator_set(ctxt, "percentile", 1, _rpn_array_percentile);
+    rpn_operator_set(ctxt, "nth", 1, _rpn_array_nth);
+
+    rpn_operator_set(ctxt, "series", 1, _rpn_series);
+    rpn_operator_set(ctxt, "push", 2, _rpn_push);
+    rpn_operator_set(ctxt, "last", 2, _rpn_series_last);
+
+    rpn_operator_set(ctxt, "sketch", 1, _rpn_sketch);
+    rpn_operator_set(ctxt, "merge", 2, _rpn_sketch_merge);
+    rpn_operator_set(ctxt, "quantile", 2, _rpn_quantile);
     rpn_operator_set(ctxt, "map", 5, _rpn_map);
     rpn_operator_set(ctxt, "constrain", 3, _rpn_constrain);
 
@@ -817,6 +2030,11 @@ bool rpn_operators_init(rpn_context & ctxt) {
     rpn_operator_set(ctxt, "ifn", 3, _rpn_ifn);
     rpn_operator_set(ctxt, "end", 1, _rpn_end);
 
+    rpn_operators_stream_init(ctxt);
+    rpn_operators_filter_init(ctxt);
+    rpn_operators_table_init(ctxt);
+    rpn_operators_polynomial_init(ctxt);
+
     #ifdef RPNLIB_ADVANCED_MATH
         rpn_operators_fmath_init(ctxt);
     #endif
@@ -23,23 +23,101 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include "rpnlib.h"
+#include "rpnlib_stack.h"
+
+#include <list>
+#include <memory>
+#include <vector>
+
+// Read-only view of the top `argc` stack values, arranged as `[0]` == bottom and `[size() - 1]` == top
+struct rpn_operator_args {
+    rpn_operator_args(const rpn_stack_value* begin, size_t size) :
+        _begin(begin),
+        _size(size)
+    {}
+
+    const rpn_value& operator[](size_t index) const {
+        return *(_begin + index)->value;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    private:
+
+    const rpn_stack_value* _begin;
+    size_t _size;
+};
+
+// Results of the pure operator, keyed on the exact argument values (Float arguments are compared bit-for-bit).
+// Most recently used entry is at the front, least recently used one is dropped when `capacity` is reached.
+// Every copy of the operator owns a separate memo, starting out empty
+struct rpn_operator_memo {
+    struct entry_type {
+        std::vector<rpn_value> args;
+        rpn_value result;
+    };
+
+    using entries_type = std::list<entry_type>;
+
+    explicit rpn_operator_memo(size_t capacity) :
+        capacity(capacity)
+    {}
+
+    size_t capacity;
+    size_t hits { 0ul };
+    size_t misses { 0ul };
+    entries_type entries;
+};
 
 struct rpn_operator {
     using callback_type = rpn_error(*)(rpn_context &);
 
+    // Instead of manipulating the stack directly, operator receives the arguments and writes the result into the `out` value.
+    // Arguments are replaced with the result when the callback returns, without copying them beforehand
+    using args_callback_type = rpn_error(*)(void* data, const rpn_operator_args& args, rpn_value& out);
+
+    // Optional column form of the operator, see rpn_operator_set_batch()
+    using batch_callback_type = void(*)(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_value_error* errors);
+
     rpn_operator() = delete;
     rpn_operator(const char*, unsigned char, callback_type);
+    rpn_operator(const char*, unsigned char, args_callback_type, void*);
+
+    rpn_operator(const rpn_operator& other) :
+        name(other.name),
+        argc(other.argc),
+        callback(other.callback),
+        args_callback(other.args_callback),
+        data(other.data),
+        batch_callback(other.batch_callback),
+        batch_result(other.batch_result),
+        memo(other.memo ? new rpn_operator_memo(other.memo->capacity) : nullptr)
+    {}
 
-    rpn_operator(const rpn_operator&) = default;
     rpn_operator(rpn_operator&& other) noexcept :
         name(std::move(other.name)),
         argc(other.argc),
-        callback(other.callback)
+        callback(other.callback),
+        args_callback(other.args_callback),
+        data(other.data),
+        batch_callback(other.batch_callback),
+        batch_result(other.batch_result),
+        memo(std::move(other.memo))
     {}
 
     String name;
     unsigned char argc;
     callback_type callback;
+    args_callback_type args_callback;
+    void* data;
+    batch_callback_type batch_callback { nullptr };
+    rpn_value::Type batch_result { rpn_value::Type::Float };
+
+    // Only set for pure operators, see rpn_operator_set_pure().
+    // Updated on every call, even though the operator itself is const
+    std::unique_ptr<rpn_operator_memo> memo;
 };
 
 bool rpn_operators_fmath_init(rpn_context &);
@@ -48,3 +126,20 @@ bool rpn_operators_init(rpn_context &);
 bool rpn_operators_clear(rpn_context &);
 
 bool rpn_operator_set(rpn_context &, const char *, unsigned char, rpn_operator::callback_type);
+bool rpn_operator_set(rpn_context &, const char *, unsigned char, rpn_operator::args_callback_type, void* data = nullptr);
+
+// Result of the operator only depends on it's arguments and the user data, and it has no side-effects.
+// Calls with the same arguments will re-use the previous result instead of calling the function again.
+// Contexts with the parent (see rpn_parent()) always call the function
+bool rpn_operator_set_pure(rpn_context &, const char *, unsigned char, rpn_operator::args_callback_type, void* data = nullptr, size_t memo_size = RPNLIB_OPERATOR_MEMO_SIZE);
+
+// Operator with the column kernel can be applied to the whole block of rows at once by rpn_process_batch().
+// Kernel replaces `lhs` with the result, `rhs` is only set for the operators with 2 arguments.
+// Failed rows set `errors[row]`, unless the row already had an error.
+// Result is either Float, or Boolean stored as 1.0 and 0.0. Boolean can only be the result of the whole expression
+bool rpn_operator_set_batch(rpn_context &, const char *, rpn_operator::batch_callback_type, rpn_value::Type result = rpn_value::Type::Float);
+
+bool rpn_operator_memo_stats(rpn_context &, const char *, size_t& hits, size_t& misses);
+bool rpn_operator_memo_clear(rpn_context &, const char *);
+
+rpn_error rpn_operator_call(rpn_context &, const rpn_operator&);
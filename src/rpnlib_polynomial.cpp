@@ -0,0 +1,214 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_polynomial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+// anonymous namespace binds all of the functions below to this compilation unit
+// this has the same effect as if these functions were `static`
+namespace {
+
+// ----------------------------------------------------------------------------
+// Polynomials
+// ----------------------------------------------------------------------------
+
+// Only use fused multiply-add when the target implements it in hardware, since the software one is a lot slower than a*b+c
+template <typename T>
+T _rpn_polynomial_fma(T a, T b, T c) {
+    return a * b + c;
+}
+
+#ifdef FP_FAST_FMA
+template <>
+double _rpn_polynomial_fma(double a, double b, double c) {
+    return std::fma(a, b, c);
+}
+#endif
+
+#ifdef FP_FAST_FMAF
+template <>
+float _rpn_polynomial_fma(float a, float b, float c) {
+    return std::fma(a, b, c);
+}
+#endif
+
+// Horner's method, starting from the highest degree
+rpn_float _rpn_polynomial_horner(const rpn_float* coefficients, size_t size, rpn_float value) {
+    rpn_float result = coefficients[0];
+    for (size_t index = 1; index < size; ++index) {
+        result = _rpn_polynomial_fma(result, value, coefficients[index]);
+    }
+
+    return result;
+}
+
+// Same as tables, polynomials of the parent context are visible as well
+const rpn_polynomial* _rpn_polynomial_find(const rpn_context & ctxt, const char* name) {
+    for (auto* current = &ctxt; current; current = current->parent) {
+        auto result = std::find_if(current->polynomials.begin(), current->polynomials.end(), [name](const rpn_polynomial& polynomial) {
+            return polynomial.name.equals(name);
+        });
+
+        if (result != current->polynomials.end()) {
+            return &(*result);
+        }
+    }
+
+    return nullptr;
+}
+
+// [a "name"] -> [b]
+// Where `b` is the value of the polynomial `name` at `a`
+rpn_error _rpn_poly_named(rpn_context & ctxt) {
+    auto& stack = ctxt.stack.get();
+    if (stack.size() < 2) {
+        return rpn_operator_error::ArgumentCountMismatch;
+    }
+
+    auto* polynomial = _rpn_polynomial_find(ctxt, stack.back().value->toString().c_str());
+    if (!polynomial) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto conversion = (*(stack.end() - 2)).value->checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    rpn_float result = _rpn_polynomial_horner(
+        polynomial->coefficients.data(), polynomial->coefficients.size(), conversion.value());
+
+    stack.erase(stack.end() - 2, stack.end());
+    stack.emplace_back(rpn_value(result));
+
+    return 0;
+}
+
+// [a b ... x] -> [y]
+// Where `y` is the value of the polynomial at `a`, and the array `b ...` of size `x` holds the coefficients.
+// Coefficients are read from the stack in place, without copying them beforehand
+rpn_error _rpn_poly_array(rpn_context & ctxt) {
+    auto& stack = ctxt.stack.get();
+
+    auto size = stack.back().value->checkedToUint();
+    if (!size.ok()) {
+        return size.error();
+    }
+
+    if (!size.value() || ((stack.size() - 1) < (size.value() + 1))) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto end = stack.end() - 1;
+    auto begin = end - size.value();
+
+    auto conversion = (*(begin - 1)).value->checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    const rpn_float value = conversion.value();
+
+    rpn_float result = 0.0;
+    for (auto it = begin; it != end; ++it) {
+        auto coefficient = (*it).value->checkedToFloat();
+        if (!coefficient.ok()) {
+            return rpn_operator_error::InvalidType;
+        }
+        result = _rpn_polynomial_fma(result, value, coefficient.value());
+    }
+
+    stack.erase(begin - 1, stack.end());
+    stack.emplace_back(rpn_value(result));
+
+    return 0;
+}
+
+rpn_error _rpn_poly(rpn_context & ctxt) {
+    if (ctxt.stack.get().back().value->isString()) {
+        return _rpn_poly_named(ctxt);
+    }
+
+    return _rpn_poly_array(ctxt);
+}
+
+} // namespace anonymous
+
+// ----------------------------------------------------------------------------
+// Polynomials methods
+// ----------------------------------------------------------------------------
+
+bool rpn_polynomial_set(rpn_context & ctxt, const char* name, const rpn_float* coefficients, size_t size) {
+    if (!strlen(name) || !coefficients || !size) {
+        return false;
+    }
+
+    rpn_polynomial_del(ctxt, name);
+    ctxt.polynomials.emplace_front(name, rpn_polynomial::coefficients_type(coefficients, coefficients + size));
+
+    return true;
+}
+
+bool rpn_polynomial_eval(rpn_context & ctxt, const char* name, rpn_float value, rpn_float& out) {
+    auto* polynomial = _rpn_polynomial_find(ctxt, name);
+    if (!polynomial) {
+        return false;
+    }
+
+    out = _rpn_polynomial_horner(polynomial->coefficients.data(), polynomial->coefficients.size(), value);
+    return true;
+}
+
+bool rpn_polynomial_del(rpn_context & ctxt, const char* name) {
+    auto end = ctxt.polynomials.end();
+    auto prev = ctxt.polynomials.before_begin();
+    auto polynomial = prev;
+
+    while (polynomial != end) {
+        prev = polynomial++;
+        if ((polynomial != end) && (*polynomial).name.equals(name)) {
+            ctxt.polynomials.erase_after(prev);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t rpn_polynomials_size(rpn_context & ctxt) {
+    return std::distance(ctxt.polynomials.begin(), ctxt.polynomials.end());
+}
+
+bool rpn_polynomials_clear(rpn_context & ctxt) {
+    ctxt.polynomials.clear();
+    return true;
+}
+
+bool rpn_operators_polynomial_init(rpn_context & ctxt) {
+    rpn_operator_set(ctxt, "poly", 1, _rpn_poly);
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <vector>
+
+// Polynomial coefficients, referenced by name from the expression.
+// Coefficients are ordered from the highest degree down to the constant term, e.g. { a, b, c } is `a*x^2 + b*x + c`
+struct rpn_polynomial {
+    using coefficients_type = std::vector<rpn_float>;
+
+    rpn_polynomial(const rpn_polynomial&) = default;
+    rpn_polynomial(rpn_polynomial&& other) noexcept :
+        name(std::move(other.name)),
+        coefficients(std::move(other.coefficients))
+    {}
+
+    template <typename Name>
+    rpn_polynomial(Name&& name, coefficients_type&& coefficients) :
+        name(std::forward<Name>(name)),
+        coefficients(std::move(coefficients))
+    {}
+
+    String name;
+    coefficients_type coefficients;
+};
+
+bool rpn_polynomial_set(rpn_context &, const char* name, const rpn_float* coefficients, size_t size);
+bool rpn_polynomial_eval(rpn_context &, const char* name, rpn_float value, rpn_float& out);
+bool rpn_polynomial_del(rpn_context &, const char* name);
+
+size_t rpn_polynomials_size(rpn_context &);
+bool rpn_polynomials_clear(rpn_context &);
+
+bool rpn_operators_polynomial_init(rpn_context &);
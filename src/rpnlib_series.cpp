@@ -0,0 +1,105 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_series.h"
+
+// ----------------------------------------------------------------------------
+// Series methods
+// ----------------------------------------------------------------------------
+
+rpn_series::rpn_series(size_t capacity) :
+    _samples(capacity ? capacity : 1),
+    _min(_samples.size()),
+    _max(_samples.size())
+{}
+
+rpn_float rpn_series::at(size_t index) const {
+    return _samples[_position(_count - _size + index)];
+}
+
+// Every new sample removes the ones it 'beats' from the back, and the front is removed when it leaves the window
+template <typename Compare>
+void rpn_series::_push(extremum_type& extremum, size_t index, Compare compare) {
+    auto& indexes = extremum.indexes;
+
+    while (extremum.size && !compare(_samples[_position(indexes[_position(extremum.head + extremum.size - 1)])], _samples[_position(index)])) {
+        --extremum.size;
+    }
+
+    if (extremum.size && ((indexes[extremum.head] + _samples.size()) <= index)) {
+        extremum.head = _position(extremum.head + 1);
+        --extremum.size;
+    }
+
+    indexes[_position(extremum.head + extremum.size)] = index;
+    ++extremum.size;
+}
+
+void rpn_series::push(rpn_float value) {
+    const size_t index = _count++;
+    const size_t position = _position(index);
+
+    if (_size == _samples.size()) {
+        _sum -= _samples[position];
+    } else {
+        ++_size;
+    }
+
+    _samples[position] = value;
+    _sum += value;
+
+    _push(_min, index, [](rpn_float lhs, rpn_float rhs) {
+        return lhs < rhs;
+    });
+    _push(_max, index, [](rpn_float lhs, rpn_float rhs) {
+        return lhs > rhs;
+    });
+
+    // running sum accumulates rounding errors, re-calculate it once per every buffer rotation
+    if (!position) {
+        _sum = 0.0;
+        for (size_t index = 0; index < _size; ++index) {
+            _sum += at(index);
+        }
+    }
+}
+
+void rpn_series::clear() {
+    _min.head = _min.size = 0;
+    _max.head = _max.size = 0;
+    _count = 0;
+    _size = 0;
+    _sum = 0.0;
+}
+
+rpn_float rpn_series::mean() const {
+    return _size ? (_sum / static_cast<rpn_float>(_size)) : 0.0;
+}
+
+rpn_float rpn_series::min() const {
+    return _size ? _samples[_position(_min.indexes[_min.head])] : 0.0;
+}
+
+rpn_float rpn_series::max() const {
+    return _size ? _samples[_position(_max.indexes[_max.head])] : 0.0;
+}
@@ -0,0 +1,85 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <vector>
+
+// Fixed-capacity ring buffer of numbers, oldest sample is replaced when the buffer is full.
+// Sum, minimum and maximum of the samples are updated on every push, so the queries below do not need to go over the whole buffer
+struct rpn_series {
+    rpn_series() = delete;
+    explicit rpn_series(size_t capacity);
+
+    size_t capacity() const {
+        return _samples.size();
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    // 0 is the oldest sample, size() - 1 is the newest one
+    rpn_float at(size_t index) const;
+
+    void push(rpn_float value);
+    void clear();
+
+    rpn_float sum() const {
+        return _sum;
+    }
+
+    rpn_float mean() const;
+    rpn_float min() const;
+    rpn_float max() const;
+
+    private:
+
+    // Monotonic deque of sample indexes, front is either the minimum or the maximum of the window
+    struct extremum_type {
+        explicit extremum_type(size_t capacity) :
+            indexes(capacity)
+        {}
+
+        std::vector<size_t> indexes;
+        size_t head { 0ul };
+        size_t size { 0ul };
+    };
+
+    template <typename Compare>
+    void _push(extremum_type& extremum, size_t index, Compare compare);
+
+    size_t _position(size_t index) const {
+        return index % _samples.size();
+    }
+
+    std::vector<rpn_float> _samples;
+    extremum_type _min;
+    extremum_type _max;
+
+    // total number of samples that were pushed
+    size_t _count { 0ul };
+    size_t _size { 0ul };
+    rpn_float _sum { 0.0 };
+};
@@ -0,0 +1,1148 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_simd.h"
+#include "rpnlib_compat.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if RPNLIB_SIMD && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RPNLIB_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define RPNLIB_SIMD_X86 0
+#endif
+
+namespace {
+
+template <typename T>
+struct rpn_simd_functions {
+    rpn_simd_isa isa;
+    void (*add)(T*, const T*, size_t);
+    void (*sub)(T*, const T*, size_t);
+    void (*mul)(T*, const T*, size_t);
+    void (*div)(T*, const T*, size_t);
+    void (*mod)(T*, const T*, size_t);
+    void (*abs)(T*, size_t);
+    void (*divisor)(const T*, size_t, rpn_value_error*);
+    void (*compare)(T*, const T*, size_t, rpn_simd_comparison);
+    void (*accumulate)(const T*, size_t, T*);
+    T (*min)(const T*, size_t);
+    T (*max)(const T*, size_t);
+};
+
+template <typename T>
+struct rpn_simd_integer_functions {
+    rpn_simd_isa isa;
+    T (*sum)(const T*, size_t);
+    T (*min)(const T*, size_t);
+    T (*max)(const T*, size_t);
+};
+
+// Reference implementation, also used for the remaining elements of the vectorized loops
+
+template <typename T>
+void _rpn_simd_scalar_add(T* lhs, const T* rhs, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] += rhs[index];
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_sub(T* lhs, const T* rhs, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] -= rhs[index];
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_mul(T* lhs, const T* rhs, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] *= rhs[index];
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_div(T* lhs, const T* rhs, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] /= rhs[index];
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_mod(T* lhs, const T* rhs, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] = lhs[index] - (std::floor(lhs[index] / rhs[index]) * rhs[index]);
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_abs(T* lhs, size_t size) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] = rpnlib_abs(lhs[index]);
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_divisor(const T* rhs, size_t size, rpn_value_error* errors) {
+    for (size_t index = 0; index < size; ++index) {
+        if (rpn_value_error::Ok != errors[index]) {
+            continue;
+        }
+
+        if (std::isinf(rhs[index]) || std::isnan(rhs[index])) {
+            errors[index] = rpn_value_error::IEEE754;
+        } else if (static_cast<T>(0.0) == rhs[index]) {
+            errors[index] = rpn_value_error::DivideByZero;
+        }
+    }
+}
+
+template <typename T>
+bool _rpn_simd_scalar_equals(T lhs, T rhs) {
+    if (std::isinf(lhs) || std::isnan(lhs) || std::isinf(rhs) || std::isnan(rhs)) {
+        return false;
+    }
+
+    return rpnlib_abs(lhs - rhs) <= std::numeric_limits<T>::epsilon();
+}
+
+template <typename T>
+bool _rpn_simd_scalar_compare_one(T lhs, T rhs, rpn_simd_comparison comparison) {
+    switch (comparison) {
+    case rpn_simd_comparison::Eq:
+        return _rpn_simd_scalar_equals(lhs, rhs);
+    case rpn_simd_comparison::Ne:
+        return !_rpn_simd_scalar_equals(lhs, rhs);
+    case rpn_simd_comparison::Gt:
+        return lhs > rhs;
+    case rpn_simd_comparison::Ge:
+        return _rpn_simd_scalar_equals(lhs, rhs) || (lhs > rhs);
+    case rpn_simd_comparison::Lt:
+        return lhs < rhs;
+    case rpn_simd_comparison::Le:
+        return _rpn_simd_scalar_equals(lhs, rhs) || (lhs < rhs);
+    }
+
+    return false;
+}
+
+template <typename T>
+void _rpn_simd_scalar_compare(T* lhs, const T* rhs, size_t size, rpn_simd_comparison comparison) {
+    for (size_t index = 0; index < size; ++index) {
+        lhs[index] = _rpn_simd_scalar_compare_one(lhs[index], rhs[index], comparison)
+            ? static_cast<T>(1.0)
+            : static_cast<T>(0.0);
+    }
+}
+
+template <typename T>
+void _rpn_simd_scalar_accumulate(const T* values, size_t size, T* acc) {
+    for (size_t index = 0; index < size; ++index) {
+        acc[index % 4] += values[index];
+    }
+}
+
+template <typename T>
+T _rpn_simd_scalar_min(const T* values, size_t size) {
+    T out = values[0];
+    for (size_t index = 1; index < size; ++index) {
+        if (values[index] < out) {
+            out = values[index];
+        }
+    }
+
+    return out;
+}
+
+template <typename T>
+T _rpn_simd_scalar_max(const T* values, size_t size) {
+    T out = values[0];
+    for (size_t index = 1; index < size; ++index) {
+        if (values[index] > out) {
+            out = values[index];
+        }
+    }
+
+    return out;
+}
+
+// signed overflow is undefined, unsigned one is not
+template <typename T>
+T _rpn_simd_wrap_add(T lhs, T rhs) {
+    using unsigned_type = typename std::make_unsigned<T>::type;
+    return static_cast<T>(static_cast<unsigned_type>(lhs) + static_cast<unsigned_type>(rhs));
+}
+
+template <typename T>
+T _rpn_simd_scalar_sum(const T* values, size_t size) {
+    T out = 0;
+    for (size_t index = 0; index < size; ++index) {
+        out = _rpn_simd_wrap_add(out, values[index]);
+    }
+
+    return out;
+}
+
+template <typename T>
+struct rpn_simd_tables {
+    static const rpn_simd_functions<T>* get(rpn_simd_isa isa) {
+        static const rpn_simd_functions<T> scalar {
+            rpn_simd_isa::Scalar,
+            _rpn_simd_scalar_add<T>,
+            _rpn_simd_scalar_sub<T>,
+            _rpn_simd_scalar_mul<T>,
+            _rpn_simd_scalar_div<T>,
+            _rpn_simd_scalar_mod<T>,
+            _rpn_simd_scalar_abs<T>,
+            _rpn_simd_scalar_divisor<T>,
+            _rpn_simd_scalar_compare<T>,
+            _rpn_simd_scalar_accumulate<T>,
+            _rpn_simd_scalar_min<T>,
+            _rpn_simd_scalar_max<T>
+        };
+
+        return (rpn_simd_isa::Scalar == isa) ? &scalar : nullptr;
+    }
+};
+
+template <typename T>
+struct rpn_simd_integer_tables {
+    static const rpn_simd_integer_functions<T>* get(rpn_simd_isa isa) {
+        static const rpn_simd_integer_functions<T> scalar {
+            rpn_simd_isa::Scalar,
+            _rpn_simd_scalar_sum<T>,
+            _rpn_simd_scalar_min<T>,
+            _rpn_simd_scalar_max<T>
+        };
+
+        return (rpn_simd_isa::Scalar == isa) ? &scalar : nullptr;
+    }
+};
+
+#if RPNLIB_SIMD_X86
+
+// Only `double` columns are vectorized. Loops handle the full vectors, the rest is passed to the scalar version
+
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_add(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        _mm_storeu_pd(lhs + index, _mm_add_pd(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_add(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_sub(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        _mm_storeu_pd(lhs + index, _mm_sub_pd(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_sub(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_mul(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        _mm_storeu_pd(lhs + index, _mm_mul_pd(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_mul(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_div(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        _mm_storeu_pd(lhs + index, _mm_div_pd(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_div(lhs + index, rhs + index, size - index);
+}
+
+// fabs() only clears the sign bit, so does this
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_abs(double* lhs, size_t size) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        _mm_storeu_pd(lhs + index, _mm_andnot_pd(sign, _mm_loadu_pd(lhs + index)));
+    }
+    _rpn_simd_scalar_abs(lhs + index, size - index);
+}
+
+// Invalid divisors are rare, so only the vectors containing them are checked again to find out which error it is.
+// Not-less-than comparison is also true for NaN
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_divisor(const double* rhs, size_t size, rpn_value_error* errors) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        const __m128d value = _mm_loadu_pd(rhs + index);
+        const __m128d invalid = _mm_or_pd(
+            _mm_cmpeq_pd(value, zero),
+            _mm_cmpnlt_pd(_mm_andnot_pd(sign, value), inf));
+        if (_mm_movemask_pd(invalid)) {
+            _rpn_simd_scalar_divisor(rhs + index, 2, errors + index);
+        }
+    }
+    _rpn_simd_scalar_divisor(rhs + index, size - index, errors + index);
+}
+
+// Zeros of different sign are equal, and the vector lanes could have found any one of them. Scalar loop keeps the first one
+template <typename T>
+T _rpn_simd_first_equal(const T* values, size_t size, T value) {
+    if (static_cast<T>(0.0) != value) {
+        return value;
+    }
+
+    for (size_t index = 0; index < size; ++index) {
+        if (value == values[index]) {
+            return values[index];
+        }
+    }
+
+    return value;
+}
+
+// Every comparison is the ordered one, which is false for NaN. Same as the scalar comparison operators
+__attribute__((target("sse2")))
+inline __m128d _rpn_simd_sse2_mask(__m128d lhs, __m128d rhs, rpn_simd_comparison comparison) {
+    switch (comparison) {
+    case rpn_simd_comparison::Gt:
+        return _mm_cmpgt_pd(lhs, rhs);
+    case rpn_simd_comparison::Lt:
+        return _mm_cmplt_pd(lhs, rhs);
+    case rpn_simd_comparison::Eq:
+    case rpn_simd_comparison::Ne:
+    case rpn_simd_comparison::Ge:
+    case rpn_simd_comparison::Le:
+        break;
+    }
+
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    const __m128d epsilon = _mm_set1_pd(std::numeric_limits<double>::epsilon());
+
+    const __m128d equals = _mm_and_pd(
+        _mm_and_pd(
+            _mm_cmplt_pd(_mm_andnot_pd(sign, lhs), inf),
+            _mm_cmplt_pd(_mm_andnot_pd(sign, rhs), inf)),
+        _mm_cmple_pd(_mm_andnot_pd(sign, _mm_sub_pd(lhs, rhs)), epsilon));
+
+    switch (comparison) {
+    case rpn_simd_comparison::Ne:
+        return _mm_xor_pd(equals, _mm_castsi128_pd(_mm_set1_epi32(-1)));
+    case rpn_simd_comparison::Ge:
+        return _mm_or_pd(equals, _mm_cmpgt_pd(lhs, rhs));
+    case rpn_simd_comparison::Le:
+        return _mm_or_pd(equals, _mm_cmplt_pd(lhs, rhs));
+    case rpn_simd_comparison::Eq:
+    case rpn_simd_comparison::Gt:
+    case rpn_simd_comparison::Lt:
+        break;
+    }
+
+    return equals;
+}
+
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_compare(double* lhs, const double* rhs, size_t size, rpn_simd_comparison comparison) {
+    const __m128d one = _mm_set1_pd(1.0);
+
+    size_t index = 0;
+    for (; index + 2 <= size; index += 2) {
+        const __m128d mask = _rpn_simd_sse2_mask(_mm_loadu_pd(lhs + index), _mm_loadu_pd(rhs + index), comparison);
+        _mm_storeu_pd(lhs + index, _mm_and_pd(mask, one));
+    }
+    _rpn_simd_scalar_compare(lhs + index, rhs + index, size - index, comparison);
+}
+
+__attribute__((target("sse2")))
+void _rpn_simd_sse2_accumulate(const double* values, size_t size, double* acc) {
+    __m128d low = _mm_loadu_pd(acc);
+    __m128d high = _mm_loadu_pd(acc + 2);
+
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        low = _mm_add_pd(low, _mm_loadu_pd(values + index));
+        high = _mm_add_pd(high, _mm_loadu_pd(values + index + 2));
+    }
+
+    _mm_storeu_pd(acc, low);
+    _mm_storeu_pd(acc + 2, high);
+    _rpn_simd_scalar_accumulate(values + index, size - index, acc);
+}
+
+// minpd and maxpd return the second argument unless the first one is less / greater, same as the scalar loop
+__attribute__((target("sse2")))
+double _rpn_simd_sse2_min(const double* values, size_t size) {
+    if (size < 4) {
+        return _rpn_simd_scalar_min(values, size);
+    }
+
+    __m128d acc = _mm_loadu_pd(values);
+
+    size_t index = 2;
+    for (; index + 2 <= size; index += 2) {
+        acc = _mm_min_pd(_mm_loadu_pd(values + index), acc);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+
+    double out = _rpn_simd_scalar_min(lanes, 2);
+    if ((index < size) && (values[index] < out)) {
+        out = values[index];
+    }
+
+    return _rpn_simd_first_equal(values, size, out);
+}
+
+__attribute__((target("sse2")))
+double _rpn_simd_sse2_max(const double* values, size_t size) {
+    if (size < 4) {
+        return _rpn_simd_scalar_max(values, size);
+    }
+
+    __m128d acc = _mm_loadu_pd(values);
+
+    size_t index = 2;
+    for (; index + 2 <= size; index += 2) {
+        acc = _mm_max_pd(_mm_loadu_pd(values + index), acc);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+
+    double out = _rpn_simd_scalar_max(lanes, 2);
+    if ((index < size) && (values[index] > out)) {
+        out = values[index];
+    }
+
+    return _rpn_simd_first_equal(values, size, out);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_add(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        _mm256_storeu_pd(lhs + index, _mm256_add_pd(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_add(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_sub(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        _mm256_storeu_pd(lhs + index, _mm256_sub_pd(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_sub(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_mul(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        _mm256_storeu_pd(lhs + index, _mm256_mul_pd(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_mul(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_div(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        _mm256_storeu_pd(lhs + index, _mm256_div_pd(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index)));
+    }
+    _rpn_simd_scalar_div(lhs + index, rhs + index, size - index);
+}
+
+// Same operations as the scalar version, in the same order. Multiplication and subtraction are never fused here
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_mod(double* lhs, const double* rhs, size_t size) {
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        const __m256d a = _mm256_loadu_pd(lhs + index);
+        const __m256d b = _mm256_loadu_pd(rhs + index);
+        const __m256d quotient = _mm256_floor_pd(_mm256_div_pd(a, b));
+        _mm256_storeu_pd(lhs + index, _mm256_sub_pd(a, _mm256_mul_pd(quotient, b)));
+    }
+    _rpn_simd_scalar_mod(lhs + index, rhs + index, size - index);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_abs(double* lhs, size_t size) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        _mm256_storeu_pd(lhs + index, _mm256_andnot_pd(sign, _mm256_loadu_pd(lhs + index)));
+    }
+    _rpn_simd_scalar_abs(lhs + index, size - index);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_divisor(const double* rhs, size_t size, rpn_value_error* errors) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        const __m256d value = _mm256_loadu_pd(rhs + index);
+        const __m256d invalid = _mm256_or_pd(
+            _mm256_cmp_pd(value, zero, _CMP_EQ_OQ),
+            _mm256_cmp_pd(_mm256_andnot_pd(sign, value), inf, _CMP_NLT_UQ));
+        if (_mm256_movemask_pd(invalid)) {
+            _rpn_simd_scalar_divisor(rhs + index, 4, errors + index);
+        }
+    }
+    _rpn_simd_scalar_divisor(rhs + index, size - index, errors + index);
+}
+
+__attribute__((target("avx2")))
+inline __m256d _rpn_simd_avx2_mask(__m256d lhs, __m256d rhs, rpn_simd_comparison comparison) {
+    switch (comparison) {
+    case rpn_simd_comparison::Gt:
+        return _mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ);
+    case rpn_simd_comparison::Lt:
+        return _mm256_cmp_pd(lhs, rhs, _CMP_LT_OQ);
+    case rpn_simd_comparison::Eq:
+    case rpn_simd_comparison::Ne:
+    case rpn_simd_comparison::Ge:
+    case rpn_simd_comparison::Le:
+        break;
+    }
+
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d epsilon = _mm256_set1_pd(std::numeric_limits<double>::epsilon());
+
+    const __m256d equals = _mm256_and_pd(
+        _mm256_and_pd(
+            _mm256_cmp_pd(_mm256_andnot_pd(sign, lhs), inf, _CMP_LT_OQ),
+            _mm256_cmp_pd(_mm256_andnot_pd(sign, rhs), inf, _CMP_LT_OQ)),
+        _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(lhs, rhs)), epsilon, _CMP_LE_OQ));
+
+    switch (comparison) {
+    case rpn_simd_comparison::Ne:
+        return _mm256_xor_pd(equals, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)));
+    case rpn_simd_comparison::Ge:
+        return _mm256_or_pd(equals, _mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ));
+    case rpn_simd_comparison::Le:
+        return _mm256_or_pd(equals, _mm256_cmp_pd(lhs, rhs, _CMP_LT_OQ));
+    case rpn_simd_comparison::Eq:
+    case rpn_simd_comparison::Gt:
+    case rpn_simd_comparison::Lt:
+        break;
+    }
+
+    return equals;
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_compare(double* lhs, const double* rhs, size_t size, rpn_simd_comparison comparison) {
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        const __m256d mask = _rpn_simd_avx2_mask(_mm256_loadu_pd(lhs + index), _mm256_loadu_pd(rhs + index), comparison);
+        _mm256_storeu_pd(lhs + index, _mm256_and_pd(mask, one));
+    }
+    _rpn_simd_scalar_compare(lhs + index, rhs + index, size - index, comparison);
+}
+
+__attribute__((target("avx2")))
+void _rpn_simd_avx2_accumulate(const double* values, size_t size, double* acc) {
+    __m256d sum = _mm256_loadu_pd(acc);
+
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(values + index));
+    }
+
+    _mm256_storeu_pd(acc, sum);
+    _rpn_simd_scalar_accumulate(values + index, size - index, acc);
+}
+
+__attribute__((target("avx2")))
+double _rpn_simd_avx2_min(const double* values, size_t size) {
+    if (size < 8) {
+        return _rpn_simd_scalar_min(values, size);
+    }
+
+    __m256d acc = _mm256_loadu_pd(values);
+
+    size_t index = 4;
+    for (; index + 4 <= size; index += 4) {
+        acc = _mm256_min_pd(_mm256_loadu_pd(values + index), acc);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+
+    double out = _rpn_simd_scalar_min(lanes, 4);
+    if (index < size) {
+        const double rest = _rpn_simd_scalar_min(values + index, size - index);
+        if (rest < out) {
+            out = rest;
+        }
+    }
+
+    return _rpn_simd_first_equal(values, size, out);
+}
+
+__attribute__((target("avx2")))
+double _rpn_simd_avx2_max(const double* values, size_t size) {
+    if (size < 8) {
+        return _rpn_simd_scalar_max(values, size);
+    }
+
+    __m256d acc = _mm256_loadu_pd(values);
+
+    size_t index = 4;
+    for (; index + 4 <= size; index += 4) {
+        acc = _mm256_max_pd(_mm256_loadu_pd(values + index), acc);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+
+    double out = _rpn_simd_scalar_max(lanes, 4);
+    if (index < size) {
+        const double rest = _rpn_simd_scalar_max(values + index, size - index);
+        if (rest > out) {
+            out = rest;
+        }
+    }
+
+    return _rpn_simd_first_equal(values, size, out);
+}
+
+// SSE2 has no floor(), so `mod` stays scalar
+template <>
+struct rpn_simd_tables<double> {
+    static const rpn_simd_functions<double>* get(rpn_simd_isa isa) {
+        static const rpn_simd_functions<double> scalar {
+            rpn_simd_isa::Scalar,
+            _rpn_simd_scalar_add<double>,
+            _rpn_simd_scalar_sub<double>,
+            _rpn_simd_scalar_mul<double>,
+            _rpn_simd_scalar_div<double>,
+            _rpn_simd_scalar_mod<double>,
+            _rpn_simd_scalar_abs<double>,
+            _rpn_simd_scalar_divisor<double>,
+            _rpn_simd_scalar_compare<double>,
+            _rpn_simd_scalar_accumulate<double>,
+            _rpn_simd_scalar_min<double>,
+            _rpn_simd_scalar_max<double>
+        };
+
+        static const rpn_simd_functions<double> sse2 {
+            rpn_simd_isa::SSE2,
+            _rpn_simd_sse2_add,
+            _rpn_simd_sse2_sub,
+            _rpn_simd_sse2_mul,
+            _rpn_simd_sse2_div,
+            _rpn_simd_scalar_mod<double>,
+            _rpn_simd_sse2_abs,
+            _rpn_simd_sse2_divisor,
+            _rpn_simd_sse2_compare,
+            _rpn_simd_sse2_accumulate,
+            _rpn_simd_sse2_min,
+            _rpn_simd_sse2_max
+        };
+
+        static const rpn_simd_functions<double> avx2 {
+            rpn_simd_isa::AVX2,
+            _rpn_simd_avx2_add,
+            _rpn_simd_avx2_sub,
+            _rpn_simd_avx2_mul,
+            _rpn_simd_avx2_div,
+            _rpn_simd_avx2_mod,
+            _rpn_simd_avx2_abs,
+            _rpn_simd_avx2_divisor,
+            _rpn_simd_avx2_compare,
+            _rpn_simd_avx2_accumulate,
+            _rpn_simd_avx2_min,
+            _rpn_simd_avx2_max
+        };
+
+        switch (isa) {
+        case rpn_simd_isa::Scalar:
+            return &scalar;
+        case rpn_simd_isa::SSE2:
+            return __builtin_cpu_supports("sse2") ? &sse2 : nullptr;
+        case rpn_simd_isa::AVX2:
+            return __builtin_cpu_supports("avx2") ? &avx2 : nullptr;
+        }
+
+        return nullptr;
+    }
+};
+
+// Integer lanes. There is no unsigned comparison, so the sign bit is flipped first.
+// SSE2 also has no 64-bit comparison, `min` and `max` of those stay scalar
+struct rpn_simd_sse2_i32 {
+    using value_type = int32_t;
+    static constexpr size_t Size = 4;
+    static constexpr bool Compare = true;
+
+    __attribute__((target("sse2")))
+    static __m128i add(__m128i lhs, __m128i rhs) {
+        return _mm_add_epi32(lhs, rhs);
+    }
+
+    __attribute__((target("sse2")))
+    static __m128i greater(__m128i lhs, __m128i rhs) {
+        return _mm_cmpgt_epi32(lhs, rhs);
+    }
+};
+
+struct rpn_simd_sse2_u32 {
+    using value_type = uint32_t;
+    static constexpr size_t Size = 4;
+    static constexpr bool Compare = true;
+
+    __attribute__((target("sse2")))
+    static __m128i add(__m128i lhs, __m128i rhs) {
+        return _mm_add_epi32(lhs, rhs);
+    }
+
+    __attribute__((target("sse2")))
+    static __m128i greater(__m128i lhs, __m128i rhs) {
+        const __m128i sign = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+        return _mm_cmpgt_epi32(_mm_xor_si128(lhs, sign), _mm_xor_si128(rhs, sign));
+    }
+};
+
+struct rpn_simd_sse2_i64 {
+    using value_type = int64_t;
+    static constexpr size_t Size = 2;
+    static constexpr bool Compare = false;
+
+    __attribute__((target("sse2")))
+    static __m128i add(__m128i lhs, __m128i rhs) {
+        return _mm_add_epi64(lhs, rhs);
+    }
+};
+
+struct rpn_simd_sse2_u64 {
+    using value_type = uint64_t;
+    static constexpr size_t Size = 2;
+    static constexpr bool Compare = false;
+
+    __attribute__((target("sse2")))
+    static __m128i add(__m128i lhs, __m128i rhs) {
+        return _mm_add_epi64(lhs, rhs);
+    }
+};
+
+struct rpn_simd_avx2_i32 {
+    using value_type = int32_t;
+    static constexpr size_t Size = 8;
+
+    __attribute__((target("avx2")))
+    static __m256i add(__m256i lhs, __m256i rhs) {
+        return _mm256_add_epi32(lhs, rhs);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i greater(__m256i lhs, __m256i rhs) {
+        return _mm256_cmpgt_epi32(lhs, rhs);
+    }
+};
+
+struct rpn_simd_avx2_u32 {
+    using value_type = uint32_t;
+    static constexpr size_t Size = 8;
+
+    __attribute__((target("avx2")))
+    static __m256i add(__m256i lhs, __m256i rhs) {
+        return _mm256_add_epi32(lhs, rhs);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i greater(__m256i lhs, __m256i rhs) {
+        const __m256i sign = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+        return _mm256_cmpgt_epi32(_mm256_xor_si256(lhs, sign), _mm256_xor_si256(rhs, sign));
+    }
+};
+
+struct rpn_simd_avx2_i64 {
+    using value_type = int64_t;
+    static constexpr size_t Size = 4;
+
+    __attribute__((target("avx2")))
+    static __m256i add(__m256i lhs, __m256i rhs) {
+        return _mm256_add_epi64(lhs, rhs);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i greater(__m256i lhs, __m256i rhs) {
+        return _mm256_cmpgt_epi64(lhs, rhs);
+    }
+};
+
+struct rpn_simd_avx2_u64 {
+    using value_type = uint64_t;
+    static constexpr size_t Size = 4;
+
+    __attribute__((target("avx2")))
+    static __m256i add(__m256i lhs, __m256i rhs) {
+        return _mm256_add_epi64(lhs, rhs);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i greater(__m256i lhs, __m256i rhs) {
+        const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(lhs, sign), _mm256_xor_si256(rhs, sign));
+    }
+};
+
+template <typename T, bool Max>
+T _rpn_simd_scalar_pick(const T* values, size_t size) {
+    return Max
+        ? _rpn_simd_scalar_max(values, size)
+        : _rpn_simd_scalar_min(values, size);
+}
+
+// Equal integers are the same value, any lane could have found the result
+template <typename T, bool Max>
+T _rpn_simd_pick_rest(const T* lanes, size_t lanes_size, const T* values, size_t size) {
+    T out = _rpn_simd_scalar_pick<T, Max>(lanes, lanes_size);
+    if (size) {
+        const T rest = _rpn_simd_scalar_pick<T, Max>(values, size);
+        if (Max ? (rest > out) : (rest < out)) {
+            out = rest;
+        }
+    }
+
+    return out;
+}
+
+template <typename Lanes, typename T = typename Lanes::value_type>
+__attribute__((target("sse2")))
+T _rpn_simd_sse2_sum(const T* values, size_t size) {
+    __m128i acc = _mm_setzero_si128();
+
+    size_t index = 0;
+    for (; index + Lanes::Size <= size; index += Lanes::Size) {
+        acc = Lanes::add(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + index)));
+    }
+
+    T lanes[Lanes::Size];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+
+    return _rpn_simd_wrap_add(
+        _rpn_simd_scalar_sum(lanes, Lanes::Size),
+        _rpn_simd_scalar_sum(values + index, size - index));
+}
+
+template <typename Lanes, bool Max, typename T = typename Lanes::value_type>
+__attribute__((target("sse2")))
+T _rpn_simd_sse2_pick(const T* values, size_t size) {
+    if (size < (2 * Lanes::Size)) {
+        return _rpn_simd_scalar_pick<T, Max>(values, size);
+    }
+
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+
+    size_t index = Lanes::Size;
+    for (; index + Lanes::Size <= size; index += Lanes::Size) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + index));
+        const __m128i mask = Max
+            ? Lanes::greater(value, acc)
+            : Lanes::greater(acc, value);
+        acc = _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, acc));
+    }
+
+    T lanes[Lanes::Size];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+
+    return _rpn_simd_pick_rest<T, Max>(lanes, Lanes::Size, values + index, size - index);
+}
+
+template <typename Lanes, bool Compare = Lanes::Compare>
+struct rpn_simd_sse2_picks {
+    using value_type = typename Lanes::value_type;
+
+    static value_type min(const value_type* values, size_t size) {
+        return _rpn_simd_sse2_pick<Lanes, false>(values, size);
+    }
+
+    static value_type max(const value_type* values, size_t size) {
+        return _rpn_simd_sse2_pick<Lanes, true>(values, size);
+    }
+};
+
+template <typename Lanes>
+struct rpn_simd_sse2_picks<Lanes, false> {
+    using value_type = typename Lanes::value_type;
+
+    static value_type min(const value_type* values, size_t size) {
+        return _rpn_simd_scalar_min(values, size);
+    }
+
+    static value_type max(const value_type* values, size_t size) {
+        return _rpn_simd_scalar_max(values, size);
+    }
+};
+
+template <typename Lanes, typename T = typename Lanes::value_type>
+__attribute__((target("avx2")))
+T _rpn_simd_avx2_sum(const T* values, size_t size) {
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t index = 0;
+    for (; index + Lanes::Size <= size; index += Lanes::Size) {
+        acc = Lanes::add(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + index)));
+    }
+
+    T lanes[Lanes::Size];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+
+    return _rpn_simd_wrap_add(
+        _rpn_simd_scalar_sum(lanes, Lanes::Size),
+        _rpn_simd_scalar_sum(values + index, size - index));
+}
+
+template <typename Lanes, bool Max, typename T = typename Lanes::value_type>
+__attribute__((target("avx2")))
+T _rpn_simd_avx2_pick(const T* values, size_t size) {
+    if (size < (2 * Lanes::Size)) {
+        return _rpn_simd_scalar_pick<T, Max>(values, size);
+    }
+
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+
+    size_t index = Lanes::Size;
+    for (; index + Lanes::Size <= size; index += Lanes::Size) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + index));
+        const __m256i mask = Max
+            ? Lanes::greater(value, acc)
+            : Lanes::greater(acc, value);
+        // not blendv, some GCC versions fold it into `mask < 0` of `char`, which is never true with -funsigned-char
+        acc = _mm256_or_si256(_mm256_and_si256(mask, value), _mm256_andnot_si256(mask, acc));
+    }
+
+    T lanes[Lanes::Size];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+
+    return _rpn_simd_pick_rest<T, Max>(lanes, Lanes::Size, values + index, size - index);
+}
+
+template <typename Sse2, typename Avx2, typename T = typename Sse2::value_type>
+struct rpn_simd_x86_integer_tables {
+    static const rpn_simd_integer_functions<T>* get(rpn_simd_isa isa) {
+        static const rpn_simd_integer_functions<T> scalar {
+            rpn_simd_isa::Scalar,
+            _rpn_simd_scalar_sum<T>,
+            _rpn_simd_scalar_min<T>,
+            _rpn_simd_scalar_max<T>
+        };
+
+        static const rpn_simd_integer_functions<T> sse2 {
+            rpn_simd_isa::SSE2,
+            _rpn_simd_sse2_sum<Sse2>,
+            rpn_simd_sse2_picks<Sse2>::min,
+            rpn_simd_sse2_picks<Sse2>::max
+        };
+
+        static const rpn_simd_integer_functions<T> avx2 {
+            rpn_simd_isa::AVX2,
+            _rpn_simd_avx2_sum<Avx2>,
+            _rpn_simd_avx2_pick<Avx2, false>,
+            _rpn_simd_avx2_pick<Avx2, true>
+        };
+
+        switch (isa) {
+        case rpn_simd_isa::Scalar:
+            return &scalar;
+        case rpn_simd_isa::SSE2:
+            return __builtin_cpu_supports("sse2") ? &sse2 : nullptr;
+        case rpn_simd_isa::AVX2:
+            return __builtin_cpu_supports("avx2") ? &avx2 : nullptr;
+        }
+
+        return nullptr;
+    }
+};
+
+template <>
+struct rpn_simd_integer_tables<int32_t> : public rpn_simd_x86_integer_tables<rpn_simd_sse2_i32, rpn_simd_avx2_i32> {
+};
+
+template <>
+struct rpn_simd_integer_tables<uint32_t> : public rpn_simd_x86_integer_tables<rpn_simd_sse2_u32, rpn_simd_avx2_u32> {
+};
+
+template <>
+struct rpn_simd_integer_tables<int64_t> : public rpn_simd_x86_integer_tables<rpn_simd_sse2_i64, rpn_simd_avx2_i64> {
+};
+
+template <>
+struct rpn_simd_integer_tables<uint64_t> : public rpn_simd_x86_integer_tables<rpn_simd_sse2_u64, rpn_simd_avx2_u64> {
+};
+
+#endif
+
+using rpn_simd_float_table = rpn_simd_tables<rpn_float>;
+using rpn_simd_int_table = rpn_simd_integer_tables<rpn_int>;
+using rpn_simd_uint_table = rpn_simd_integer_tables<rpn_uint>;
+
+struct rpn_simd_selection {
+    const rpn_simd_functions<rpn_float>* floats;
+    const rpn_simd_integer_functions<rpn_int>* integers;
+    const rpn_simd_integer_functions<rpn_uint>* unsigned_integers;
+};
+
+// Integer types without the vector version use plain loops instead
+template <typename Table>
+auto _rpn_simd_integer(rpn_simd_isa isa) -> decltype(Table::get(isa)) {
+    auto* result = Table::get(isa);
+    if (!result) {
+        result = Table::get(rpn_simd_isa::Scalar);
+    }
+
+    return result;
+}
+
+rpn_simd_selection _rpn_simd_selection(const rpn_simd_functions<rpn_float>* floats) {
+    return rpn_simd_selection {
+        floats,
+        _rpn_simd_integer<rpn_simd_int_table>(floats->isa),
+        _rpn_simd_integer<rpn_simd_uint_table>(floats->isa)
+    };
+}
+
+rpn_simd_selection _rpn_simd_best() {
+    const rpn_simd_functions<rpn_float>* result = rpn_simd_float_table::get(rpn_simd_isa::AVX2);
+    if (!result) {
+        result = rpn_simd_float_table::get(rpn_simd_isa::SSE2);
+    }
+    if (!result) {
+        result = rpn_simd_float_table::get(rpn_simd_isa::Scalar);
+    }
+
+    return _rpn_simd_selection(result);
+}
+
+// Instruction set is detected once, on the first call
+rpn_simd_selection& _rpn_simd() {
+    static rpn_simd_selection selection = _rpn_simd_best();
+    return selection;
+}
+
+} // namespace
+
+rpn_simd_isa rpn_simd_current() {
+    return _rpn_simd().floats->isa;
+}
+
+bool rpn_simd_select(rpn_simd_isa isa) {
+    auto* functions = rpn_simd_float_table::get(isa);
+    if (!functions) {
+        return false;
+    }
+
+    _rpn_simd() = _rpn_simd_selection(functions);
+    return true;
+}
+
+void rpn_simd_add(rpn_float* lhs, const rpn_float* rhs, size_t size) {
+    _rpn_simd().floats->add(lhs, rhs, size);
+}
+
+void rpn_simd_sub(rpn_float* lhs, const rpn_float* rhs, size_t size) {
+    _rpn_simd().floats->sub(lhs, rhs, size);
+}
+
+void rpn_simd_mul(rpn_float* lhs, const rpn_float* rhs, size_t size) {
+    _rpn_simd().floats->mul(lhs, rhs, size);
+}
+
+void rpn_simd_div(rpn_float* lhs, const rpn_float* rhs, size_t size) {
+    _rpn_simd().floats->div(lhs, rhs, size);
+}
+
+void rpn_simd_mod(rpn_float* lhs, const rpn_float* rhs, size_t size) {
+    _rpn_simd().floats->mod(lhs, rhs, size);
+}
+
+void rpn_simd_abs(rpn_float* lhs, size_t size) {
+    _rpn_simd().floats->abs(lhs, size);
+}
+
+void rpn_simd_divisor(const rpn_float* rhs, size_t size, rpn_value_error* errors) {
+    _rpn_simd().floats->divisor(rhs, size, errors);
+}
+
+void rpn_simd_compare(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_simd_comparison comparison) {
+    _rpn_simd().floats->compare(lhs, rhs, size, comparison);
+}
+
+void rpn_simd_accumulate(const rpn_float* values, size_t size, rpn_float* acc) {
+    _rpn_simd().floats->accumulate(values, size, acc);
+}
+
+rpn_float rpn_simd_min(const rpn_float* values, size_t size) {
+    return _rpn_simd().floats->min(values, size);
+}
+
+rpn_float rpn_simd_max(const rpn_float* values, size_t size) {
+    return _rpn_simd().floats->max(values, size);
+}
+
+rpn_int rpn_simd_min(const rpn_int* values, size_t size) {
+    return _rpn_simd().integers->min(values, size);
+}
+
+rpn_int rpn_simd_max(const rpn_int* values, size_t size) {
+    return _rpn_simd().integers->max(values, size);
+}
+
+rpn_uint rpn_simd_min(const rpn_uint* values, size_t size) {
+    return _rpn_simd().unsigned_integers->min(values, size);
+}
+
+rpn_uint rpn_simd_max(const rpn_uint* values, size_t size) {
+    return _rpn_simd().unsigned_integers->max(values, size);
+}
+
+rpn_int rpn_simd_sum(const rpn_int* values, size_t size) {
+    return _rpn_simd().integers->sum(values, size);
+}
+
+rpn_uint rpn_simd_sum(const rpn_uint* values, size_t size) {
+    return _rpn_simd().unsigned_integers->sum(values, size);
+}
@@ -0,0 +1,82 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <cstddef>
+
+// Element-wise math over the contiguous columns of rpn_float, used by the batch kernels of the math and comparison operators,
+// and reductions over the runs of numbers of the same type, used by the array operators.
+// Every function gives the exact same result as the rpn_value operators, only the number of elements processed at once is different.
+// x86 hosts select SSE2 or AVX2 at runtime, when the CPU supports it. Everything else (and RPNLIB_SIMD=0) uses plain loops
+enum class rpn_simd_isa {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+rpn_simd_isa rpn_simd_current();
+
+// returns `false` when the CPU does not support the instruction set
+bool rpn_simd_select(rpn_simd_isa);
+
+void rpn_simd_add(rpn_float* lhs, const rpn_float* rhs, size_t size);
+void rpn_simd_sub(rpn_float* lhs, const rpn_float* rhs, size_t size);
+void rpn_simd_mul(rpn_float* lhs, const rpn_float* rhs, size_t size);
+void rpn_simd_div(rpn_float* lhs, const rpn_float* rhs, size_t size);
+void rpn_simd_mod(rpn_float* lhs, const rpn_float* rhs, size_t size);
+void rpn_simd_abs(rpn_float* lhs, size_t size);
+
+// Same checks as the rpn_value division. Rows with zero, infinite or NaN divisor are marked in `errors`, unless the row already had an error
+void rpn_simd_divisor(const rpn_float* rhs, size_t size, rpn_value_error* errors);
+
+// Replaces `lhs` with the mask of the comparison, 1.0 where it is true and 0.0 otherwise (which is what the Boolean result converts to).
+// Same rules as the `eq`, `ne`, `gt`, `ge`, `lt` and `le` operators: equality allows the difference of up to epsilon, and is never true for inf or NaN
+enum class rpn_simd_comparison {
+    Eq,
+    Ne,
+    Gt,
+    Ge,
+    Lt,
+    Le
+};
+
+void rpn_simd_compare(rpn_float* lhs, const rpn_float* rhs, size_t size, rpn_simd_comparison);
+
+// Reductions of the array operators.
+// Adds values[index] to acc[index % 4], `size` must be a multiple of 4. Every instruction set keeps the four sums in the same order
+void rpn_simd_accumulate(const rpn_float* values, size_t size, rpn_float* acc);
+
+// First smallest or largest value of the non-empty run, as if every value was compared with `<` or `>` one by one.
+// Floating point values must not contain NaN
+rpn_float rpn_simd_min(const rpn_float* values, size_t size);
+rpn_float rpn_simd_max(const rpn_float* values, size_t size);
+rpn_int rpn_simd_min(const rpn_int* values, size_t size);
+rpn_int rpn_simd_max(const rpn_int* values, size_t size);
+rpn_uint rpn_simd_min(const rpn_uint* values, size_t size);
+rpn_uint rpn_simd_max(const rpn_uint* values, size_t size);
+
+// Integers wrap around, same as with the rpn_value `+`
+rpn_int rpn_simd_sum(const rpn_int* values, size_t size);
+rpn_uint rpn_simd_sum(const rpn_uint* values, size_t size);
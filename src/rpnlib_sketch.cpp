@@ -0,0 +1,210 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_sketch.h"
+
+extern "C" {
+    #include "fs_math.h"
+}
+
+#include <algorithm>
+#include <cmath>
+
+// anonymous namespace binds all of the functions below to this compilation unit
+// this has the same effect as if these functions were `static`
+namespace {
+
+constexpr rpn_float Pi { 3.14159265358979323846 };
+
+// k1 scale function from the t-digest paper, k(q) = compression / 2pi * asin(2q - 1).
+// Every centroid may only span a single unit of `k`, which makes them smaller closer to the 0 and 1.
+// Limit of the next centroid is q(k(q0) + 1). With s = 2q0 - 1 and step = 2pi / compression, it expands into
+// sin(asin(s) + step) = s * cos(step) + sqrt(1 - s^2) * sin(step), so only the fs_math cos and sqrt are needed.
+// Once asin(s) + step reaches pi/2 (s >= cos(step)), the rest of the quantiles fit into the last centroid
+struct rpn_sketch_scale {
+    explicit rpn_sketch_scale(rpn_float compression) :
+        cos_step(fs_cos((2.0 * Pi) / compression)),
+        sin_step(fs_cos(((2.0 * Pi) / compression) - (Pi / 2.0)))
+    {}
+
+    rpn_float next(rpn_float q) const {
+        const rpn_float s = 2.0 * q - 1.0;
+        if (s >= cos_step) {
+            return 1.0;
+        }
+
+        return (s * cos_step + fs_sqrt(std::max(static_cast<rpn_float>(1.0 - s * s), static_cast<rpn_float>(0.0))) * sin_step + 1.0) / 2.0;
+    }
+
+    rpn_float cos_step;
+    rpn_float sin_step;
+};
+
+bool _rpn_sketch_less(const rpn_sketch::centroid_type& lhs, const rpn_sketch::centroid_type& rhs) {
+    return lhs.mean < rhs.mean;
+}
+
+} // namespace anonymous
+
+// ----------------------------------------------------------------------------
+// Sketch methods
+// ----------------------------------------------------------------------------
+
+rpn_sketch::rpn_sketch(size_t compression) :
+    _compression(std::max(compression, static_cast<size_t>(2)))
+{
+    _centroids.reserve(_compression);
+    _buffer.reserve(_compression);
+}
+
+void rpn_sketch::push(rpn_float value) {
+    if (!_count) {
+        _min = value;
+        _max = value;
+    } else {
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+
+    _count += 1.0;
+    _buffer.push_back(value);
+
+    if (_buffer.size() >= _compression) {
+        _compress();
+    }
+}
+
+void rpn_sketch::merge(const rpn_sketch& other) {
+    if (!other._count) {
+        return;
+    }
+
+    if (!_count) {
+        _min = other._min;
+        _max = other._max;
+    } else {
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+
+    _compress();
+
+    // _compress() does not expect anything in the buffer, so the other sketch centroids are appended as-is
+    _centroids.insert(_centroids.end(), other._centroids.begin(), other._centroids.end());
+    for (auto value : other._buffer) {
+        _centroids.push_back(centroid_type{value, 1.0});
+    }
+
+    _count += other._count;
+    _compress();
+}
+
+void rpn_sketch::clear() {
+    _centroids.clear();
+    _buffer.clear();
+    _count = 0.0;
+    _min = 0.0;
+    _max = 0.0;
+}
+
+// Buffered samples become centroids with the weight of 1. Every centroid, in order, is then either merged into
+// the current one when the result does not exceed the size limit for it's position, or starts a new one
+void rpn_sketch::_compress() {
+    for (auto value : _buffer) {
+        _centroids.push_back(centroid_type{value, 1.0});
+    }
+    _buffer.clear();
+
+    if (_centroids.size() < 2) {
+        return;
+    }
+
+    std::sort(_centroids.begin(), _centroids.end(), _rpn_sketch_less);
+
+    const rpn_sketch_scale scale(static_cast<rpn_float>(_compression));
+
+    rpn_float total { 0.0 };
+    for (auto& centroid : _centroids) {
+        total += centroid.weight;
+    }
+
+    rpn_float merged { 0.0 };
+    rpn_float limit = total * scale.next(0.0);
+
+    auto current = _centroids.begin();
+    for (auto it = current + 1; it != _centroids.end(); ++it) {
+        if ((merged + (*current).weight + (*it).weight) <= limit) {
+            rpn_float weight = (*current).weight + (*it).weight;
+            (*current).mean += ((*it).mean - (*current).mean) * (*it).weight / weight;
+            (*current).weight = weight;
+            continue;
+        }
+
+        merged += (*current).weight;
+        limit = total * scale.next(merged / total);
+
+        ++current;
+        *current = *it;
+    }
+
+    _centroids.erase(current + 1, _centroids.end());
+}
+
+// Every centroid is treated as if it's samples are spread around the mean, and the quantile is interpolated
+// between the closest centroid means. Known minimum and maximum bound the first and the last centroids
+rpn_float rpn_sketch::quantile(rpn_float q) {
+    _compress();
+
+    if (!_count) {
+        return 0.0;
+    }
+
+    if ((q <= 0.0) || (_centroids.size() == 1)) {
+        return (q <= 0.0) ? _min : _centroids.front().mean;
+    }
+
+    if (q >= 1.0) {
+        return _max;
+    }
+
+    const rpn_float target = q * _count;
+
+    rpn_float prev_mean = _min;
+    rpn_float prev_position = 0.0;
+    rpn_float cumulative = 0.0;
+
+    for (auto& centroid : _centroids) {
+        rpn_float position = cumulative + (centroid.weight / 2.0);
+        if (target < position) {
+            rpn_float span = position - prev_position;
+            return prev_mean + (centroid.mean - prev_mean) * ((target - prev_position) / span);
+        }
+
+        cumulative += centroid.weight;
+        prev_mean = centroid.mean;
+        prev_position = position;
+    }
+
+    rpn_float span = _count - prev_position;
+    return prev_mean + (_max - prev_mean) * ((target - prev_position) / span);
+}
@@ -0,0 +1,78 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <vector>
+
+// Quantile sketch, based on the merging t-digest. Samples are added to the buffer, which is merged with
+// existing centroids when it is full. Centroids near the tails are kept smaller than the ones in the middle,
+// so the extreme quantiles (p95, p99) remain accurate. Both buffer and centroids are limited by the `compression` size
+struct rpn_sketch {
+    struct centroid_type {
+        rpn_float mean;
+        rpn_float weight;
+    };
+
+    using centroids_type = std::vector<centroid_type>;
+    using buffer_type = std::vector<rpn_float>;
+
+    rpn_sketch() = delete;
+    explicit rpn_sketch(size_t compression);
+
+    size_t compression() const {
+        return _compression;
+    }
+
+    rpn_float count() const {
+        return _count;
+    }
+
+    rpn_float min() const {
+        return _min;
+    }
+
+    rpn_float max() const {
+        return _max;
+    }
+
+    void push(rpn_float value);
+    void merge(const rpn_sketch& other);
+    void clear();
+
+    // `q` is between 0 and 1. Sketch is compressed beforehand, so it might change the internal state
+    rpn_float quantile(rpn_float q);
+
+    private:
+
+    void _compress();
+
+    size_t _compression;
+    centroids_type _centroids;
+    buffer_type _buffer;
+
+    rpn_float _count { 0.0 };
+    rpn_float _min { 0.0 };
+    rpn_float _max { 0.0 };
+};
@@ -24,6 +24,10 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #include "rpnlib_stack.h"
 #include "rpnlib_variable.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 // ----------------------------------------------------------------------------
 // Stack methods
 // ----------------------------------------------------------------------------
@@ -42,7 +46,7 @@ namespace {
 
 // we only can manipulate the current stack
 // stack shifting, push and pop is only handled via the [ and ] keywords
-bool _rpn_stack_get(rpn_nested_stack::stack_type& stack, unsigned char index, rpn_value& out) {
+bool _rpn_stack_get(rpn_nested_stack::stack_type& stack, size_t index, rpn_value& out) {
     const auto size = stack.size();
     if (index >= size) return false;
 
@@ -53,18 +57,49 @@ bool _rpn_stack_get(rpn_nested_stack::stack_type& stack, unsigned char index, rp
     return true;
 }
 
-bool _rpn_stack_get(rpn_context & ctxt, unsigned char index, rpn_value& out) {
+// Everything below the mark was never touched since the checkpoint, and the rest is in the log.
+// Log may contain the same slot more than once (when nested checkpoint was released), the oldest entry is the one we need
+template <typename T>
+void _rpn_stack_restore(std::vector<T>& values, std::vector<std::pair<size_t, T>>& log, size_t log_begin, size_t mark, size_t depth) {
+    mark = std::min(mark, depth);
+    values.erase(values.begin() + mark, values.end());
+
+    std::vector<size_t> positions(depth - mark, log.size());
+    for (size_t position = log.size(); position > log_begin; --position) {
+        const auto index = log[position - 1].first;
+        if ((index >= mark) && (index < depth)) {
+            positions[index - mark] = position - 1;
+        }
+    }
+
+    for (auto position : positions) {
+        values.push_back(std::move(log[position].second));
+    }
+
+    log.erase(log.begin() + log_begin, log.end());
+}
+
+// nothing else can see the value when it is only referenced by the stack, so it is moved instead of copied
+void _rpn_stack_take(rpn_stack_value& slot, rpn_value& out) {
+    if ((slot.type == rpn_stack_value::Type::Value) && (slot.value.use_count() == 1)) {
+        out = std::move(*slot.value);
+    } else {
+        out = *slot.value;
+    }
+}
+
+bool _rpn_stack_get(rpn_context & ctxt, size_t index, rpn_value& out) {
     auto& stack = ctxt.stack.get();
     return _rpn_stack_get(stack, index, out);
 }
 
 } // namespace
 
-bool rpn_stack_get(rpn_context & ctxt, unsigned char index, rpn_value& out) {
+bool rpn_stack_get(rpn_context & ctxt, size_t index, rpn_value& out) {
     return _rpn_stack_get(ctxt, index, out);
 }
 
-rpn_value rpn_stack_pop(rpn_context & ctxt, unsigned char index) {
+rpn_value rpn_stack_get(rpn_context & ctxt, size_t index) {
     rpn_value result;
     rpn_stack_get(ctxt, index, result);
     return result;
@@ -72,11 +107,35 @@ rpn_value rpn_stack_pop(rpn_context & ctxt, unsigned char index) {
 
 bool rpn_stack_pop(rpn_context & ctxt, rpn_value& out) {
     auto& stack = ctxt.stack.get();
-    if (_rpn_stack_get(stack, 0, out)) {
-        stack.pop_back();
-        return true;
+    if (!stack.size() || !stack.back().value) {
+        return false;
     }
-    return false;
+
+    _rpn_stack_take(stack.back(), out);
+    stack.pop_back();
+
+    return true;
+}
+
+bool rpn_stack_pop(rpn_context & ctxt, std::vector<rpn_value>& out) {
+    auto& stack = ctxt.stack.get();
+    out.reserve(out.size() + stack.size());
+
+    for (auto& slot : stack) {
+        out.emplace_back();
+        if (slot.value) {
+            _rpn_stack_take(slot, out.back());
+        }
+    }
+
+    stack.clear();
+
+    return true;
+}
+
+rpn_stack_view rpn_stack_values(rpn_context & ctxt) {
+    const auto& stack = ctxt.stack.get();
+    return rpn_stack_view(stack.data(), stack.size());
 }
 
 rpn_value rpn_stack_pop(rpn_context & ctxt) {
@@ -104,19 +163,131 @@ rpn_stack_value::Type rpn_stack_inspect(rpn_context & ctxt) {
     return rpn_stack_value::Type::None;
 }
 
+bool rpn_stack_checkpoint(rpn_context & ctxt) {
+    ctxt.stack.checkpoint_push();
+    return true;
+}
+
+bool rpn_stack_rollback(rpn_context & ctxt) {
+    if (ctxt.stack.checkpoint_rollback()) {
+        rpn_variables_unref(ctxt);
+        return true;
+    }
+
+    return false;
+}
+
+bool rpn_stack_release(rpn_context & ctxt) {
+    return ctxt.stack.checkpoint_release();
+}
+
+size_t rpn_stack_checkpoints(rpn_context & ctxt) {
+    return ctxt.stack.checkpoints_size();
+}
+
 void rpn_nested_stack::stacks_merge() {
-    auto& prev = *(_stacks.end() - 2);
-    auto& current = get();
+    auto size = _current.size();
+    frames_save();
+    _current._offset = _frames.back();
+    _frames.pop_back();
 
-    prev.insert(
-        prev.end(),
-        current.begin(),
-        current.end()
-    );
-    prev.emplace_back(
+    _values.emplace_back(
         rpn_stack_value::Type::Array,
-        rpn_value(static_cast<rpn_uint>(current.size()))
+        rpn_value(static_cast<rpn_uint>(size))
     );
+}
+
+// values are saved top to bottom, so the mark only ever moves down until the checkpoint is gone
+void rpn_stack_frame::save(size_t index) {
+    auto& log = _owner->_values_log;
+    while (_mark > index) {
+        --_mark;
+        log.emplace_back(_mark, (*_values)[_mark]);
+    }
+}
+
+void rpn_nested_stack::frames_save() {
+    if (_frames.size() && (_frames.size() - 1 < _frames_mark)) {
+        --_frames_mark;
+        _frames_log.emplace_back(_frames_mark, _frames[_frames_mark]);
+    }
+}
+
+void rpn_nested_stack::checkpoint_push() {
+    _checkpoints.push_back(checkpoint_type{
+        _values.size(), _frames.size(), _current._offset,
+        _values_log.size(), _frames_log.size(), _aggregates_log.size(),
+        _current._mark, _frames_mark});
+
+    _current._mark = _values.size();
+    _frames_mark = _frames.size();
+}
+
+bool rpn_nested_stack::checkpoint_rollback() {
+    if (!_checkpoints.size()) {
+        return false;
+    }
+
+    const auto checkpoint = _checkpoints.back();
+    _checkpoints.pop_back();
+
+    _rpn_stack_restore(_values, _values_log, checkpoint.values_log, _current._mark, checkpoint.depth);
+    _rpn_stack_restore(_frames, _frames_log, checkpoint.frames_log, _frames_mark, checkpoint.frames);
+
+    // newest first, so the contents saved by the oldest entry are the ones that stay
+    for (size_t position = _aggregates_log.size(); position > checkpoint.aggregates_log; --position) {
+        auto& entry = _aggregates_log[position - 1];
+        *entry.first = std::move(entry.second);
+    }
+    _aggregates_log.erase(_aggregates_log.begin() + checkpoint.aggregates_log, _aggregates_log.end());
+
+    _current._offset = checkpoint.offset;
+    _current._mark = checkpoint.values_mark;
+    _frames_mark = checkpoint.frames_mark;
+
+    return true;
+}
+
+// outer checkpoint needs everything the released one saved, so the log is kept as-is
+bool rpn_nested_stack::checkpoint_release() {
+    if (!_checkpoints.size()) {
+        return false;
+    }
+
+    const auto checkpoint = _checkpoints.back();
+    _checkpoints.pop_back();
+
+    if (!_checkpoints.size()) {
+        checkpoints_clear();
+        return true;
+    }
+
+    _current._mark = std::min(_current._mark, checkpoint.values_mark);
+    _frames_mark = std::min(_frames_mark, checkpoint.frames_mark);
+
+    return true;
+}
+
+// only the first modification since the latest checkpoint needs the copy
+void rpn_nested_stack::aggregate_save(const rpn_stack_value::ValuePtr& ptr) {
+    if (!_checkpoints.size()) {
+        return;
+    }
+
+    for (size_t position = _checkpoints.back().aggregates_log; position < _aggregates_log.size(); ++position) {
+        if (_aggregates_log[position].first == ptr) {
+            return;
+        }
+    }
+
+    _aggregates_log.emplace_back(ptr, *ptr);
+}
 
-    stacks_pop();
+void rpn_nested_stack::checkpoints_clear() {
+    _checkpoints.clear();
+    _values_log.clear();
+    _frames_log.clear();
+    _aggregates_log.clear();
+    _current._mark = 0;
+    _frames_mark = 0;
 }
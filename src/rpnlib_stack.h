@@ -25,14 +25,18 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #include "rpnlib.h"
 #include "rpnlib_value.h"
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
+#include <utility>
+#include <vector>
 
 struct rpn_context;
 
 // TODO: 0.5.0 direct class methods instead of c style functions
 //       return this struct as 'optional' type instead of bool
 struct rpn_stack_value {
-    using ValuePtr = std::shared_ptr<rpn_value>;
+    using ValuePtr = rpn_value_ptr;
 
     enum class Type {
         None,
@@ -52,7 +56,7 @@ struct rpn_stack_value {
     template <typename Value>
     rpn_stack_value(Type type, Value&& value) :
         type(type),
-        value(std::make_shared<rpn_value>(std::forward<Value>(value)))
+        value(rpn_make_value(std::forward<Value>(value)))
     {}
 
     rpn_stack_value(Type type, ValuePtr ptr) :
@@ -76,63 +80,514 @@ struct rpn_stack_value {
     ValuePtr value;
 };
 
+struct rpn_nested_stack;
+
+// See rpn_stack_values()
+struct rpn_stack_view {
+    struct iterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = rpn_value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const rpn_value*;
+        using reference = const rpn_value&;
+
+        iterator() = default;
+
+        explicit iterator(const rpn_stack_value* it) :
+            _it(it)
+        {}
+
+        reference operator*() const {
+            return *(_it - 1)->value;
+        }
+
+        pointer operator->() const {
+            return &(**this);
+        }
+
+        reference operator[](difference_type offset) const {
+            return *(*this + offset);
+        }
+
+        iterator& operator++() {
+            --_it;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto out = *this;
+            --_it;
+            return out;
+        }
+
+        iterator& operator--() {
+            ++_it;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            auto out = *this;
+            ++_it;
+            return out;
+        }
+
+        iterator& operator+=(difference_type offset) {
+            _it -= offset;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type offset) {
+            _it += offset;
+            return *this;
+        }
+
+        iterator operator+(difference_type offset) const {
+            return iterator(_it - offset);
+        }
+
+        friend iterator operator+(difference_type offset, const iterator& it) {
+            return it + offset;
+        }
+
+        iterator operator-(difference_type offset) const {
+            return iterator(_it + offset);
+        }
+
+        difference_type operator-(const iterator& other) const {
+            return other._it - _it;
+        }
+
+        bool operator==(const iterator& other) const {
+            return _it == other._it;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return _it != other._it;
+        }
+
+        bool operator<(const iterator& other) const {
+            return _it > other._it;
+        }
+
+        bool operator>(const iterator& other) const {
+            return _it < other._it;
+        }
+
+        bool operator<=(const iterator& other) const {
+            return _it >= other._it;
+        }
+
+        bool operator>=(const iterator& other) const {
+            return _it <= other._it;
+        }
+
+        private:
+
+        // points right above the current value, just like the std::reverse_iterator
+        const rpn_stack_value* _it { nullptr };
+    };
+
+    rpn_stack_view(const rpn_stack_value* data, size_t size) :
+        _data(data),
+        _size(size)
+    {}
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return !_size;
+    }
+
+    const rpn_value& operator[](size_t index) const {
+        return *(_data + (_size - index - 1))->value;
+    }
+
+    iterator begin() const {
+        return iterator(_data + _size);
+    }
+
+    iterator end() const {
+        return iterator(_data);
+    }
+
+    private:
+
+    const rpn_stack_value* _data;
+    size_t _size;
+};
+
+// Values of the current stack, which is the topmost frame of the nested stack.
+// Behaves like a vector, but only sees the values above the frame offset.
+// Mutable access to the values below the latest checkpoint saves them into the undo log first, see rpn_nested_stack
+struct rpn_stack_frame {
+    using container_type = std::vector<rpn_stack_value>;
+    using value_type = container_type::value_type;
+    using const_iterator = container_type::const_iterator;
+    using const_reverse_iterator = container_type::const_reverse_iterator;
+
+    struct iterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = rpn_stack_value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = rpn_stack_value*;
+        using reference = rpn_stack_value&;
+
+        iterator() = default;
+
+        iterator(rpn_stack_frame* frame, container_type::iterator it) :
+            _frame(frame),
+            _it(it)
+        {}
+
+        operator const_iterator() const {
+            return _it;
+        }
+
+        reference operator*() const {
+            _frame->touch(_it);
+            return *_it;
+        }
+
+        pointer operator->() const {
+            return &(**this);
+        }
+
+        reference operator[](difference_type offset) const {
+            return *(*this + offset);
+        }
+
+        iterator& operator++() {
+            ++_it;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto out = *this;
+            ++_it;
+            return out;
+        }
+
+        iterator& operator--() {
+            --_it;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            auto out = *this;
+            --_it;
+            return out;
+        }
+
+        iterator& operator+=(difference_type offset) {
+            _it += offset;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type offset) {
+            _it -= offset;
+            return *this;
+        }
+
+        iterator operator+(difference_type offset) const {
+            return iterator(_frame, _it + offset);
+        }
+
+        friend iterator operator+(difference_type offset, const iterator& it) {
+            return it + offset;
+        }
+
+        iterator operator-(difference_type offset) const {
+            return iterator(_frame, _it - offset);
+        }
+
+        difference_type operator-(const iterator& other) const {
+            return _it - other._it;
+        }
+
+        bool operator==(const iterator& other) const {
+            return _it == other._it;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return _it != other._it;
+        }
+
+        bool operator<(const iterator& other) const {
+            return _it < other._it;
+        }
+
+        bool operator>(const iterator& other) const {
+            return _it > other._it;
+        }
+
+        bool operator<=(const iterator& other) const {
+            return _it <= other._it;
+        }
+
+        bool operator>=(const iterator& other) const {
+            return _it >= other._it;
+        }
+
+        private:
+
+        rpn_stack_frame* _frame { nullptr };
+        container_type::iterator _it;
+    };
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    rpn_stack_frame(rpn_nested_stack& owner, container_type& values, size_t offset) :
+        _owner(&owner),
+        _values(&values),
+        _offset(offset)
+    {}
+
+    size_t size() const {
+        return _values->size() - _offset;
+    }
+
+    bool empty() const {
+        return !size();
+    }
+
+    iterator begin() {
+        return iterator(this, _values->begin() + _offset);
+    }
+
+    iterator end() {
+        return iterator(this, _values->end());
+    }
+
+    const_iterator begin() const {
+        return _values->cbegin() + _offset;
+    }
+
+    const_iterator end() const {
+        return _values->cend();
+    }
+
+    reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rbegin() const {
+        return _values->crbegin();
+    }
+
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    const rpn_stack_value* data() const {
+        return _values->data() + _offset;
+    }
+
+    rpn_stack_value& operator[](size_t index) {
+        auto it = _values->begin() + _offset + index;
+        touch(it);
+        return *it;
+    }
+
+    const rpn_stack_value& at(size_t index) const {
+        return _values->at(_offset + index);
+    }
+
+    rpn_stack_value& back() {
+        touch(_values->end() - 1);
+        return _values->back();
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        _values->emplace_back(std::forward<Args>(args)...);
+    }
+
+    void push_back(const rpn_stack_value& value) {
+        _values->push_back(value);
+    }
+
+    void push_back(rpn_stack_value&& value) {
+        _values->push_back(std::move(value));
+    }
+
+    void pop_back() {
+        touch(_values->end() - 1);
+        _values->pop_back();
+    }
+
+    iterator insert(const_iterator pos, const rpn_stack_value& value) {
+        touch(pos);
+        return iterator(this, _values->insert(pos, value));
+    }
+
+    iterator erase(const_iterator pos) {
+        touch(pos);
+        return iterator(this, _values->erase(pos));
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        touch(first);
+        return iterator(this, _values->erase(first, last));
+    }
+
+    void clear() {
+        erase(begin(), end());
+    }
+
+    private:
+
+    friend struct rpn_nested_stack;
+
+    // values below the mark were not yet saved for the latest checkpoint
+    void touch(const_iterator it) {
+        const auto index = static_cast<size_t>(it - _values->cbegin());
+        if (index < _mark) {
+            save(index);
+        }
+    }
+
+    void save(size_t index);
+
+    rpn_nested_stack* _owner;
+    container_type* _values;
+    size_t _offset;
+    size_t _mark { 0 };
+};
+
+// Every stack lives in the same vector, one after another. `[` only remembers where the new stack starts,
+// `]` forgets about it and appends the size, leaving the values in place. Neither one moves or copies the values.
+//
+// Checkpoint only remembers the current depth. Values below it are copied into the undo log (as handles, sharing the value)
+// right before they are modified or removed, and rollback puts them back. Series and sketches are modified in place through
+// the handle, so their contents are copied instead (see aggregate_save()). Checkpoints can be nested, and are discarded by stacks_clear()
 struct rpn_nested_stack {
-    using stack_type = std::vector<rpn_stack_value>;
-    using stacks_type = std::vector<stack_type>;
+    using stack_type = rpn_stack_frame;
+    using values_type = stack_type::container_type;
+    using frames_type = std::vector<size_t>;
+
+    struct checkpoint_type {
+        size_t depth;
+        size_t frames;
+        size_t offset;
+        size_t values_log;
+        size_t frames_log;
+        size_t aggregates_log;
+        size_t values_mark;
+        size_t frames_mark;
+    };
+
+    using checkpoints_type = std::vector<checkpoint_type>;
+    using values_log_type = std::vector<std::pair<size_t, rpn_stack_value>>;
+    using frames_log_type = std::vector<std::pair<size_t, size_t>>;
+    using aggregates_log_type = std::vector<std::pair<rpn_stack_value::ValuePtr, rpn_value>>;
 
     rpn_nested_stack() :
-        _stacks({{}}),
-        _current(&_stacks.back())
+        _current(*this, _values, 0)
     {}
 
     rpn_nested_stack(const rpn_nested_stack& other) :
-        _stacks(other._stacks),
-        _current(&_stacks.back())
+        _values(other._values),
+        _frames(other._frames),
+        _current(*this, _values, other._current._offset)
     {}
 
     rpn_nested_stack(rpn_nested_stack&& other) noexcept :
-        _stacks(std::move(other._stacks)),
-        _current(&_stacks.back())
+        _values(std::move(other._values)),
+        _frames(std::move(other._frames)),
+        _current(*this, _values, other._current._offset)
     {}
 
+    rpn_nested_stack& operator=(const rpn_nested_stack& other) {
+        _values = other._values;
+        _frames = other._frames;
+        _current._offset = other._current._offset;
+        checkpoints_clear();
+        return *this;
+    }
+
+    rpn_nested_stack& operator=(rpn_nested_stack&& other) noexcept {
+        _values = std::move(other._values);
+        _frames = std::move(other._frames);
+        _current._offset = other._current._offset;
+        checkpoints_clear();
+        return *this;
+    }
+
     stack_type& get() {
-        return *_current;
+        return _current;
     }
 
     // notice that we clear the whole chain, not just the current stack
     void stacks_clear() {
-        _stacks.resize(1);
-        _current = &_stacks.back();
-        (*_current).clear();
+        checkpoints_clear();
+        _values.clear();
+        _frames.clear();
+        _current._offset = 0;
     }
 
     // pop out of the stack without changing anything
     void stacks_pop() {
-        if (_stacks.size() > 1) {
-            _stacks.pop_back();
-            _current = &_stacks.back();
+        if (_frames.size()) {
+            _current.erase(_current.begin(), _current.end());
+            frames_save();
+            _current._offset = _frames.back();
+            _frames.pop_back();
         }
     }
 
     // create a new stack and select it as the current one
     void stacks_push() {
-        _stacks.resize(_stacks.size() + 1);
-        _current = &_stacks.back();
+        _frames.push_back(_current._offset);
+        _current._offset = _values.size();
     }
 
-    // create a new stack and select it as the current one
+    // number of stacks, including the current one
     size_t stacks_size() {
-        return _stacks.size();
+        return _frames.size() + 1;
     }
 
     // merge current stack with the previous one + insert size value
     // then, pop out of the stack
     void stacks_merge();
 
+    // remember the current state of the stack
+    void checkpoint_push();
+
+    // restore the state of the latest checkpoint and forget about it
+    bool checkpoint_rollback();
+
+    // forget about the latest checkpoint, keeping the current state
+    bool checkpoint_release();
+
+    // remember the contents of the series or the sketch, right before it is modified in place
+    void aggregate_save(const rpn_stack_value::ValuePtr&);
+
+    size_t checkpoints_size() {
+        return _checkpoints.size();
+    }
+
     private:
 
-    stacks_type _stacks;
-    stack_type* _current;
+    friend struct rpn_stack_frame;
+
+    void checkpoints_clear();
+    void frames_save();
+
+    values_type _values;
+    frames_type _frames;
+    stack_type _current;
+
+    checkpoints_type _checkpoints;
+    values_log_type _values_log;
+    frames_log_type _frames_log;
+    aggregates_log_type _aggregates_log;
+    size_t _frames_mark { 0 };
 };
 
 rpn_stack_value::Type rpn_stack_inspect(rpn_context & ctxt);
@@ -143,8 +598,24 @@ bool rpn_stack_clear(rpn_context &);
 bool rpn_stack_push(rpn_context & ctxt, const rpn_value& value);
 bool rpn_stack_push(rpn_context & ctxt, rpn_value&& value);
 
-bool rpn_stack_get(rpn_context & ctxt, unsigned char index, rpn_value& out);
+bool rpn_stack_get(rpn_context & ctxt, size_t index, rpn_value& out);
 bool rpn_stack_pop(rpn_context & ctxt, rpn_value& out);
 
 rpn_value rpn_stack_pop(rpn_context & ctxt);
-rpn_value rpn_stack_get(rpn_context & ctxt, unsigned char index);
+rpn_value rpn_stack_get(rpn_context & ctxt, size_t index);
+
+// Read-only view of the current stack, without copying the values. Index 0 is the top of the stack, same as with rpn_stack_get(),
+// and iteration also starts at the top. View is only valid until the stack is modified
+rpn_stack_view rpn_stack_values(rpn_context & ctxt);
+
+// Moves every value of the current stack into `out`, from the bottom to the top (so `out.back()` is the former top of the stack).
+// Values that are shared with variables or with other stack values are copied instead
+bool rpn_stack_pop(rpn_context & ctxt, std::vector<rpn_value>& out);
+
+// Remember the current state of the stack, so it can be restored after a failed or speculative evaluation.
+// Checkpoint itself is O(1), values are only saved when they are about to be modified or removed.
+// Only the stack is restored, variables keep their values
+bool rpn_stack_checkpoint(rpn_context & ctxt);
+bool rpn_stack_rollback(rpn_context & ctxt);
+bool rpn_stack_release(rpn_context & ctxt);
+size_t rpn_stack_checkpoints(rpn_context & ctxt);
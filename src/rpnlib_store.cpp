@@ -0,0 +1,191 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_store.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+bool _rpn_variable_store_reading(rpn_variable_store& store, uint32_t epoch) {
+    for (auto& slot : store.slots) {
+        const uint32_t value = slot.epoch.load();
+        if (value && (static_cast<int32_t>(value - epoch) <= 0)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Snapshot retired at epoch `e` could only be loaded by the readers that started at `e` or before it
+void _rpn_variable_store_reclaim(rpn_variable_store& store) {
+    auto end = std::remove_if(store.retired.begin(), store.retired.end(), [&](const rpn_variable_store::retired_type::value_type& retired) {
+        if (_rpn_variable_store_reading(store, retired.second)) {
+            return false;
+        }
+        delete retired.first;
+        return true;
+    });
+
+    store.retired.erase(end, store.retired.end());
+}
+
+template <typename Callback>
+bool _rpn_variable_store_publish(rpn_variable_store& store, Callback&& callback) {
+    std::lock_guard<rpn_variable_store::mutex_type> lock(store.mutex);
+
+    auto* previous = store.current.load();
+    auto* next = new rpn_variable_store_snapshot(*previous);
+    if (!callback(next->values)) {
+        delete next;
+        return false;
+    }
+
+    store.current.store(next);
+
+    // epoch 0 is reserved for the slots that are not reading. Wrap-around goes straight to 1,
+    // so the readers loading the epoch at the same time never observe 0
+    uint32_t epoch = store.epoch.load();
+    uint32_t following;
+    do {
+        following = epoch + 1;
+        if (!following) {
+            following = 1;
+        }
+    } while (!store.epoch.compare_exchange_weak(epoch, following));
+
+    store.retired.emplace_back(previous, epoch);
+    _rpn_variable_store_reclaim(store);
+
+    return true;
+}
+
+} // namespace
+
+rpn_variable_store::rpn_variable_store() :
+    current(new rpn_variable_store_snapshot)
+{}
+
+rpn_variable_store::~rpn_variable_store() {
+    for (auto& snapshot : retired) {
+        delete snapshot.first;
+    }
+
+    delete current.load();
+}
+
+bool rpn_variable_store_set(rpn_variable_store & store, const String& name, const rpn_value& value) {
+    if (!name.length() || (name.indexOf(' ') >= 0)) {
+        return false;
+    }
+
+    return _rpn_variable_store_publish(store, [&](rpn_variable_store_snapshot::values_type& values) {
+        for (auto& entry : values) {
+            if (entry.first == name) {
+                entry.second = value;
+                return true;
+            }
+        }
+
+        values.emplace_back(name, value);
+        return true;
+    });
+}
+
+bool rpn_variable_store_del(rpn_variable_store & store, const String& name) {
+    return _rpn_variable_store_publish(store, [&](rpn_variable_store_snapshot::values_type& values) {
+        auto it = std::find_if(values.begin(), values.end(), [&](const rpn_variable_store_snapshot::values_type::value_type& entry) {
+            return entry.first == name;
+        });
+        if (it == values.end()) {
+            return false;
+        }
+
+        values.erase(it);
+        return true;
+    });
+}
+
+size_t rpn_variable_store_size(rpn_variable_store & store) {
+    std::lock_guard<rpn_variable_store::mutex_type> lock(store.mutex);
+    return store.current.load()->values.size();
+}
+
+size_t rpn_variable_store_retired(rpn_variable_store & store) {
+    std::lock_guard<rpn_variable_store::mutex_type> lock(store.mutex);
+    return store.retired.size();
+}
+
+bool rpn_variable_store_attach(rpn_context & ctxt, rpn_variable_store & store) {
+    if (ctxt.store) {
+        return false;
+    }
+
+    std::lock_guard<rpn_variable_store::mutex_type> lock(store.mutex);
+    store.slots.emplace_back(store);
+    ctxt.store = &store.slots.back();
+
+    return true;
+}
+
+bool rpn_variable_store_detach(rpn_context & ctxt) {
+    if (!ctxt.store) {
+        return false;
+    }
+
+    auto* slot = ctxt.store;
+    auto& store = slot->store;
+
+    std::lock_guard<rpn_variable_store::mutex_type> lock(store.mutex);
+    store.slots.remove_if([slot](const rpn_variable_store_slot& other) {
+        return &other == slot;
+    });
+    ctxt.store = nullptr;
+
+    return true;
+}
+
+// Epoch is announced before loading the snapshot, so the writer that replaces it afterwards knows it is still in use
+bool rpn_variable_store_get(rpn_context & ctxt, const char* name, rpn_value& out) {
+    auto* slot = ctxt.store;
+    if (!slot) {
+        return false;
+    }
+
+    slot->epoch.store(slot->store.epoch.load());
+
+    bool found = false;
+    for (auto& entry : slot->store.current.load()->values) {
+        if (entry.first.equals(name)) {
+            out = entry.second;
+            found = true;
+            break;
+        }
+    }
+
+    slot->epoch.store(0, std::memory_order_release);
+
+    return found;
+}
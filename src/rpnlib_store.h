@@ -0,0 +1,96 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
+
+#if RPNLIB_STORE_MUTEX
+#include <mutex>
+#endif
+
+// Contents of the store are never modified in place. Writers copy the current snapshot, change the copy and publish it instead
+struct rpn_variable_store_snapshot {
+    using values_type = std::vector<std::pair<String, rpn_value>>;
+    values_type values;
+};
+
+struct rpn_variable_store;
+
+// Every attached context announces the epoch it started reading at, 0 when it is not reading anything
+struct rpn_variable_store_slot {
+    explicit rpn_variable_store_slot(rpn_variable_store& store) :
+        store(store)
+    {}
+
+    rpn_variable_store& store;
+    std::atomic<uint32_t> epoch { 0 };
+};
+
+// Variables shared by several contexts. Readers never block and never free anything, while writers publish
+// the new snapshot and free the old ones once every reader that could still see them is done (epoch-based reclamation).
+// Writers are serialized with a mutex, except on ESP8266 where only one writer can run at a time (see RPNLIB_STORE_MUTEX).
+// Contexts must be detached before the store is destroyed
+struct rpn_variable_store {
+#if RPNLIB_STORE_MUTEX
+    using mutex_type = std::mutex;
+#else
+    struct mutex_type {
+        void lock() {}
+        void unlock() {}
+    };
+#endif
+
+    using retired_type = std::vector<std::pair<const rpn_variable_store_snapshot*, uint32_t>>;
+
+    rpn_variable_store();
+    ~rpn_variable_store();
+
+    rpn_variable_store(const rpn_variable_store&) = delete;
+    rpn_variable_store& operator=(const rpn_variable_store&) = delete;
+
+    std::atomic<const rpn_variable_store_snapshot*> current;
+    std::atomic<uint32_t> epoch { 1 };
+
+    // writers, slots and the retired snapshots
+    mutex_type mutex;
+    std::list<rpn_variable_store_slot> slots;
+    retired_type retired;
+};
+
+bool rpn_variable_store_set(rpn_variable_store &, const String& name, const rpn_value& value);
+bool rpn_variable_store_del(rpn_variable_store &, const String& name);
+
+size_t rpn_variable_store_size(rpn_variable_store &);
+size_t rpn_variable_store_retired(rpn_variable_store &);
+
+// Variables of the store are visible to the expression after the ones from the context and its parent. Only the values can be read, `&name` is never bound to the store
+bool rpn_variable_store_attach(rpn_context &, rpn_variable_store &);
+bool rpn_variable_store_detach(rpn_context &);
+
+bool rpn_variable_store_get(rpn_context &, const char* name, rpn_value& out);
@@ -0,0 +1,241 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_stream.h"
+
+#include <iterator>
+
+// anonymous namespace binds all of the functions below to this compilation unit
+// this has the same effect as if these functions were `static`
+namespace {
+
+// ----------------------------------------------------------------------------
+// Stream state
+// ----------------------------------------------------------------------------
+
+bool _rpn_stream_same(const rpn_value_weak_ptr& lhs, const rpn_value_ptr& rhs) {
+    return !lhs.owner_before(rhs) && !rhs.owner_before(lhs);
+}
+
+// State is reset when either the operator or it's window changes. States of the removed variables are purged
+// during the same walk over the list, only unlinking the ones that actually expired
+rpn_stream& _rpn_stream_get(rpn_context & ctxt, rpn_stream::Type type, const rpn_value_ptr& handle, size_t window = 0) {
+    auto& streams = ctxt.streams;
+
+    rpn_stream* result = nullptr;
+    for (auto prev = streams.before_begin(), it = streams.begin(); it != streams.end();) {
+        if ((*it).handle.expired()) {
+            it = streams.erase_after(prev);
+            continue;
+        }
+
+        if (!result && _rpn_stream_same((*it).handle, handle)) {
+            result = &(*it);
+        }
+
+        prev = it++;
+    }
+
+    if (result) {
+        if ((result->type != type) || (result->window != window)) {
+            *result = rpn_stream(type, handle, window);
+        }
+        return *result;
+    }
+
+    streams.emplace_front(type, handle, window);
+    return streams.front();
+}
+
+// Every operator expects `&var` at the top of the stack, and number(s) below it
+rpn_error _rpn_stream_args(rpn_context & ctxt, size_t argc, rpn_float* args) {
+    auto& stack = ctxt.stack.get();
+
+    auto& top = stack.back();
+    if (top.type != rpn_stack_value::Type::Variable) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto it = stack.end() - 1 - argc;
+    for (size_t index = 0; index < argc; ++index, ++it) {
+        auto conversion = (*it).value->checkedToFloat();
+        if (!conversion.ok()) {
+            return conversion.error();
+        }
+        args[index] = conversion.value();
+    }
+
+    return 0;
+}
+
+size_t _rpn_stream_window_size(rpn_float value) {
+    return (value >= 1.0) ? static_cast<size_t>(value) : 0;
+}
+
+// Variable always contains the last result, operators below replace their arguments with a copy of it
+void _rpn_stream_result(rpn_context & ctxt, size_t argc, rpn_value&& value) {
+    auto& stack = ctxt.stack.get();
+    *stack.back().value = value;
+
+    stack.erase(stack.end() - 1 - argc, stack.end());
+    stack.emplace_back(std::move(value));
+}
+
+// [a b &var] -> [c]
+// Exponential moving average of `a` with the smoothing factor `b`, 0 < `b` <= 1.
+// Variable is the state itself. When it does not contain a number, the average starts with `a`
+rpn_error _rpn_stream_ema(rpn_context & ctxt) {
+    rpn_float args[2];
+
+    auto error = _rpn_stream_args(ctxt, 2, args);
+    if (0 != error.code) {
+        return error;
+    }
+
+    if (!(args[1] > 0.0) || (args[1] > 1.0)) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto& state = *ctxt.stack.get().back().value;
+
+    rpn_float average = args[0];
+    if (state.isNumber()) {
+        average = state.toFloat();
+        average += args[1] * (args[0] - average);
+    }
+
+    _rpn_stream_result(ctxt, 2, rpn_value(average));
+
+    return 0;
+}
+
+// [a &var] -> [b c]
+// Running mean `b` and population variance `c` of every `a` seen so far, using Welford's algorithm.
+// Variable is set to the current mean
+rpn_error _rpn_stream_welford(rpn_context & ctxt) {
+    rpn_float sample;
+
+    auto error = _rpn_stream_args(ctxt, 1, &sample);
+    if (0 != error.code) {
+        return error;
+    }
+
+    auto& stream = _rpn_stream_get(ctxt, rpn_stream::Type::Welford, ctxt.stack.get().back().value);
+
+    ++stream.count;
+    rpn_float delta = sample - stream.mean;
+    stream.mean += delta / static_cast<rpn_float>(stream.count);
+    stream.m2 += delta * (sample - stream.mean);
+
+    rpn_float variance = stream.m2 / static_cast<rpn_float>(stream.count);
+
+    _rpn_stream_result(ctxt, 1, rpn_value(stream.mean));
+    rpn_stack_push(ctxt, rpn_value(variance));
+
+    return 0;
+}
+
+// Samples in the deque are kept in order, such that the front is always the result. Every new sample removes
+// the ones it 'beats' from the back, and the front is removed when it is older than the window
+template <typename Compare>
+rpn_float _rpn_stream_window_push(rpn_stream& stream, rpn_float value, Compare compare) {
+    auto& samples = stream.samples;
+    if (samples.size() != stream.window) {
+        samples.resize(stream.window);
+    }
+
+    const size_t index = stream.count++;
+
+    while (stream.size && !compare(samples[(stream.head + stream.size - 1) % stream.window].value, value)) {
+        --stream.size;
+    }
+
+    if (stream.size && ((samples[stream.head].index + stream.window) <= index)) {
+        stream.head = (stream.head + 1) % stream.window;
+        --stream.size;
+    }
+
+    samples[(stream.head + stream.size) % stream.window] = rpn_stream::sample_type{index, value};
+    ++stream.size;
+
+    return samples[stream.head].value;
+}
+
+// [a b &var] -> [c]
+// Where `c` is either the smallest or the largest `a` out of `b` last samples
+template <typename Compare>
+rpn_error _rpn_stream_window(rpn_context & ctxt, rpn_stream::Type type, Compare compare) {
+    rpn_float args[2];
+
+    auto error = _rpn_stream_args(ctxt, 2, args);
+    if (0 != error.code) {
+        return error;
+    }
+
+    auto window = _rpn_stream_window_size(args[1]);
+    if (!window) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto& stream = _rpn_stream_get(ctxt, type, ctxt.stack.get().back().value, window);
+    rpn_float result = _rpn_stream_window_push(stream, args[0], compare);
+
+    _rpn_stream_result(ctxt, 2, rpn_value(result));
+
+    return 0;
+}
+
+rpn_error _rpn_stream_wmin(rpn_context & ctxt) {
+    return _rpn_stream_window(ctxt, rpn_stream::Type::WindowMin, [](rpn_float lhs, rpn_float rhs) {
+        return lhs < rhs;
+    });
+}
+
+rpn_error _rpn_stream_wmax(rpn_context & ctxt) {
+    return _rpn_stream_window(ctxt, rpn_stream::Type::WindowMax, [](rpn_float lhs, rpn_float rhs) {
+        return lhs > rhs;
+    });
+}
+
+} // namespace anonymous
+
+// ----------------------------------------------------------------------------
+// Streams methods
+// ----------------------------------------------------------------------------
+
+size_t rpn_streams_size(rpn_context & ctxt) {
+    return std::distance(ctxt.streams.begin(), ctxt.streams.end());
+}
+
+bool rpn_streams_clear(rpn_context & ctxt) {
+    ctxt.streams.clear();
+    return true;
+}
+
+bool rpn_operators_stream_init(rpn_context & ctxt) {
+    rpn_operator_set(ctxt, "ema", 3, _rpn_stream_ema);
+    rpn_operator_set(ctxt, "welford", 2, _rpn_stream_welford);
+    rpn_operator_set(ctxt, "wmin", 3, _rpn_stream_wmin);
+    rpn_operator_set(ctxt, "wmax", 3, _rpn_stream_wmax);
+    return true;
+}
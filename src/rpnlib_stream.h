@@ -0,0 +1,72 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+#include "rpnlib_value.h"
+
+#include <memory>
+#include <vector>
+
+// Persistent state of the streaming statistics operators. Every state is bound to the variable,
+// which reference was passed to the operator as `&var`, and is removed together with the variable
+struct rpn_stream {
+    enum class Type {
+        Welford,
+        WindowMin,
+        WindowMax
+    };
+
+    struct sample_type {
+        size_t index;
+        rpn_float value;
+    };
+
+    using samples_type = std::vector<sample_type>;
+
+    rpn_stream() = delete;
+    rpn_stream(Type type, rpn_value_weak_ptr handle, size_t window) :
+        type(type),
+        handle(handle),
+        window(window)
+    {}
+
+    Type type;
+    rpn_value_weak_ptr handle;
+
+    // Running mean and the sum of squared differences from it
+    size_t count { 0ul };
+    rpn_float mean { 0.0 };
+    rpn_float m2 { 0.0 };
+
+    // Monotonic deque of the last `window` samples, stored as a ring buffer
+    size_t window;
+    size_t head { 0ul };
+    size_t size { 0ul };
+    samples_type samples;
+};
+
+bool rpn_operators_stream_init(rpn_context &);
+
+size_t rpn_streams_size(rpn_context &);
+bool rpn_streams_clear(rpn_context &);
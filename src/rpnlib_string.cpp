@@ -0,0 +1,134 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_string.h"
+
+#include <cstring>
+#include <new>
+
+namespace {
+
+// every pool (and every pool that was cleared) gets a new id, so entries of different pools are never confused
+uint32_t _rpn_string_pool_id() {
+    static std::atomic<uint32_t> id { 0 };
+    return ++id;
+}
+
+rpn_string_entry* _rpn_string_entry(uint32_t pool, const char* data, size_t length) {
+    void* memory = ::operator new(offsetof(rpn_string_entry, data) + length + 1);
+
+    auto* entry = new (memory) rpn_string_entry;
+    entry->references = 1;
+    entry->pool = pool;
+    entry->length = length;
+    std::memcpy(entry->data, data, length);
+    entry->data[length] = '\0';
+
+    return entry;
+}
+
+void _rpn_string_pool_release(rpn_string_pool& pool) {
+    for (auto* entry : pool.entries) {
+        rpn_string_release(entry);
+    }
+    pool.entries.clear();
+}
+
+} // namespace
+
+rpn_string_entry* rpn_string_acquire(rpn_string_entry* entry) {
+    ++entry->references;
+    return entry;
+}
+
+void rpn_string_release(rpn_string_entry* entry) {
+    if (0 == --entry->references) {
+        entry->~rpn_string_entry();
+        ::operator delete(entry);
+    }
+}
+
+rpn_string_pool::rpn_string_pool() :
+    id(_rpn_string_pool_id())
+{}
+
+rpn_string_pool::~rpn_string_pool() {
+    _rpn_string_pool_release(*this);
+}
+
+rpn_string_pool::rpn_string_pool(const rpn_string_pool& other) :
+    enabled(other.enabled),
+    id(_rpn_string_pool_id()),
+    entries(other.entries)
+{
+    for (auto* entry : entries) {
+        rpn_string_acquire(entry);
+    }
+}
+
+rpn_string_pool& rpn_string_pool::operator=(const rpn_string_pool& other) {
+    if (this != &other) {
+        _rpn_string_pool_release(*this);
+        enabled = other.enabled;
+        id = _rpn_string_pool_id();
+        entries = other.entries;
+        for (auto* entry : entries) {
+            rpn_string_acquire(entry);
+        }
+    }
+
+    return *this;
+}
+
+rpn_value rpn_string_pool_value(rpn_string_pool& pool, const char* data, size_t length) {
+    if (!pool.enabled) {
+        return rpn_value(data, length);
+    }
+
+    for (auto* entry : pool.entries) {
+        if ((entry->length == length) && (0 == std::memcmp(entry->data, data, length))) {
+            return rpn_value(entry);
+        }
+    }
+
+    auto* entry = _rpn_string_entry(pool.id, data, length);
+    pool.entries.push_back(entry);
+
+    return rpn_value(entry);
+}
+
+bool rpn_strings_intern(rpn_context & ctxt, bool enabled) {
+    ctxt.strings.enabled = enabled;
+    return true;
+}
+
+size_t rpn_strings_size(rpn_context & ctxt) {
+    return ctxt.strings.entries.size();
+}
+
+// values keep their entries, pool starts over with the new id
+bool rpn_strings_clear(rpn_context & ctxt) {
+    _rpn_string_pool_release(ctxt.strings);
+    ctxt.strings.id = _rpn_string_pool_id();
+    return true;
+}
@@ -0,0 +1,70 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct rpn_context;
+struct rpn_value;
+
+// Immutable string buffer, shared by every value using it. References are always counted atomically, since the same entry
+// may be copied by several readers at once, either by the engine threads or by the const rpn_process() overload
+// (e.g. from the word body of the shared context). Device builds have the readers on the other core (ESP32) or task
+struct rpn_string_entry {
+    using references_type = std::atomic<size_t>;
+
+    references_type references;
+    uint32_t pool;
+    size_t length;
+    char data[1];
+};
+
+rpn_string_entry* rpn_string_acquire(rpn_string_entry*);
+void rpn_string_release(rpn_string_entry*);
+
+// Interned string literals of the context, disabled by default. Every literal with the same contents refers to the same entry,
+// so `eq` only needs to compare pointers when both strings come from the same pool.
+// Entries stay in the pool until it is cleared, and are freed once the last value using them is gone
+struct rpn_string_pool {
+    using entries_type = std::vector<rpn_string_entry*>;
+
+    rpn_string_pool();
+    ~rpn_string_pool();
+
+    rpn_string_pool(const rpn_string_pool&);
+    rpn_string_pool& operator=(const rpn_string_pool&);
+
+    bool enabled { false };
+    uint32_t id;
+    entries_type entries;
+};
+
+// When the pool is enabled, returns the value referring to the pooled entry. Otherwise, just a copy of the string
+rpn_value rpn_string_pool_value(rpn_string_pool&, const char* data, size_t length);
+
+bool rpn_strings_intern(rpn_context &, bool enabled);
+size_t rpn_strings_size(rpn_context &);
+bool rpn_strings_clear(rpn_context &);
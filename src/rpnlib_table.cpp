@@ -0,0 +1,191 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "rpnlib.h"
+#include "rpnlib_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+// anonymous namespace binds all of the functions below to this compilation unit
+// this has the same effect as if these functions were `static`
+namespace {
+
+// ----------------------------------------------------------------------------
+// Lookup tables
+// ----------------------------------------------------------------------------
+
+bool _rpn_table_valid(const char* name, const rpn_float* x, const rpn_float* y, size_t size) {
+    if (!strlen(name) || !x || !y || (size < 2)) {
+        return false;
+    }
+
+    for (size_t index = 1; index < size; ++index) {
+        if (!(x[index - 1] < x[index])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Tables are never modified by the operators, so the ones from the parent context are visible as well
+const rpn_table* _rpn_table_find(const rpn_context & ctxt, const char* name) {
+    for (auto* current = &ctxt; current; current = current->parent) {
+        auto result = std::find_if(current->tables.begin(), current->tables.end(), [name](const rpn_table& table) {
+            return table.name.equals(name);
+        });
+
+        if (result != current->tables.end()) {
+            return &(*result);
+        }
+    }
+
+    return nullptr;
+}
+
+// Segment is found with the binary search over `x`. Values outside of the table are clamped to the first or the last `y`.
+// NaN fails both clamps and would make the search return the end of the table, so it is passed through instead
+rpn_float _rpn_table_interp(const rpn_table& table, rpn_float value) {
+    if (std::isnan(value)) {
+        return value;
+    }
+
+    const rpn_float* x = table.x;
+    const rpn_float* y = table.y;
+
+    if (value <= x[0]) {
+        return y[0];
+    }
+
+    if (value >= x[table.size - 1]) {
+        return y[table.size - 1];
+    }
+
+    size_t upper = std::upper_bound(x, x + table.size, value) - x;
+    size_t lower = upper - 1;
+
+    return y[lower] + (y[upper] - y[lower]) * ((value - x[lower]) / (x[upper] - x[lower]));
+}
+
+// [a "name"] -> [b]
+// Where `b` is the value of `a` interpolated using the table `name`
+rpn_error _rpn_interp(rpn_context & ctxt) {
+    auto& stack = ctxt.stack.get();
+
+    auto& name = *stack.back().value;
+    if (!name.isString()) {
+        return rpn_operator_error::InvalidType;
+    }
+
+    auto* table = _rpn_table_find(ctxt, name.toString().c_str());
+    if (!table) {
+        return rpn_operator_error::InvalidArgument;
+    }
+
+    auto conversion = (*(stack.end() - 2)).value->checkedToFloat();
+    if (!conversion.ok()) {
+        return conversion.error();
+    }
+
+    rpn_float result = _rpn_table_interp(*table, conversion.value());
+
+    stack.erase(stack.end() - 2, stack.end());
+    stack.emplace_back(rpn_value(result));
+
+    return 0;
+}
+
+} // namespace anonymous
+
+// ----------------------------------------------------------------------------
+// Tables methods
+// ----------------------------------------------------------------------------
+
+bool rpn_table_set(rpn_context & ctxt, const char* name, const rpn_float* x, const rpn_float* y, size_t size) {
+    if (!_rpn_table_valid(name, x, y, size)) {
+        return false;
+    }
+
+    rpn_table::values_type storage;
+    storage.reserve(size * 2);
+    storage.insert(storage.end(), x, x + size);
+    storage.insert(storage.end(), y, y + size);
+
+    rpn_table_del(ctxt, name);
+    ctxt.tables.emplace_front(name, std::move(storage), size);
+
+    return true;
+}
+
+bool rpn_table_set_ref(rpn_context & ctxt, const char* name, const rpn_float* x, const rpn_float* y, size_t size) {
+    if (!_rpn_table_valid(name, x, y, size)) {
+        return false;
+    }
+
+    rpn_table_del(ctxt, name);
+    ctxt.tables.emplace_front(name, x, y, size);
+
+    return true;
+}
+
+bool rpn_table_interp(rpn_context & ctxt, const char* name, rpn_float value, rpn_float& out) {
+    auto* table = _rpn_table_find(ctxt, name);
+    if (!table) {
+        return false;
+    }
+
+    out = _rpn_table_interp(*table, value);
+    return true;
+}
+
+bool rpn_table_del(rpn_context & ctxt, const char* name) {
+    auto end = ctxt.tables.end();
+    auto prev = ctxt.tables.before_begin();
+    auto table = prev;
+
+    while (table != end) {
+        prev = table++;
+        if ((table != end) && (*table).name.equals(name)) {
+            ctxt.tables.erase_after(prev);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t rpn_tables_size(rpn_context & ctxt) {
+    return std::distance(ctxt.tables.begin(), ctxt.tables.end());
+}
+
+bool rpn_tables_clear(rpn_context & ctxt) {
+    ctxt.tables.clear();
+    return true;
+}
+
+bool rpn_operators_table_init(rpn_context & ctxt) {
+    rpn_operator_set(ctxt, "interp", 2, _rpn_interp);
+    return true;
+}
@@ -0,0 +1,80 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include "rpnlib.h"
+
+#include <vector>
+
+// Piecewise-linear lookup table, referenced by name from the expression.
+// Breakpoints are either copied into the table, or the table only refers to the external constant arrays
+// (e.g. placed in flash), which must outlive the context
+struct rpn_table {
+    using values_type = std::vector<rpn_float>;
+
+    rpn_table(const rpn_table&) = delete;
+    rpn_table(rpn_table&& other) noexcept :
+        name(std::move(other.name)),
+        storage(std::move(other.storage)),
+        x(other.x),
+        y(other.y),
+        size(other.size)
+    {}
+
+    template <typename Name>
+    rpn_table(Name&& name, const rpn_float* x, const rpn_float* y, size_t size) :
+        name(std::forward<Name>(name)),
+        x(x),
+        y(y),
+        size(size)
+    {}
+
+    template <typename Name>
+    rpn_table(Name&& name, values_type&& storage, size_t size) :
+        name(std::forward<Name>(name)),
+        storage(std::move(storage)),
+        x(this->storage.data()),
+        y(this->storage.data() + size),
+        size(size)
+    {}
+
+    String name;
+    values_type storage;
+
+    const rpn_float* x;
+    const rpn_float* y;
+    size_t size;
+};
+
+// `x` values must be in strictly ascending order, table needs at least 2 breakpoints
+bool rpn_table_set(rpn_context &, const char* name, const rpn_float* x, const rpn_float* y, size_t size);
+bool rpn_table_set_ref(rpn_context &, const char* name, const rpn_float* x, const rpn_float* y, size_t size);
+
+bool rpn_table_interp(rpn_context &, const char* name, rpn_float value, rpn_float& out);
+
+bool rpn_table_del(rpn_context &, const char* name);
+
+size_t rpn_tables_size(rpn_context &);
+bool rpn_tables_clear(rpn_context &);
+
+bool rpn_operators_table_init(rpn_context &);
@@ -39,6 +39,13 @@ void rpn_variables_foreach(rpn_context & ctxt, Callback callback) {
     }
 }
 
+template <typename Callback>
+void rpn_words_foreach(rpn_context & ctxt, Callback callback) {
+    for (auto& word : ctxt.words) {
+        callback(word.name, word.body);
+    }
+}
+
 template <typename Callback>
 void rpn_operators_foreach(rpn_context & ctxt, Callback callback) {
     for (auto& op : ctxt.operators) {
@@ -96,6 +103,15 @@ struct rpn_error_decoder {
         case rpn_processing_error::InputBufferOverflow:
             callback("Token is larger than the available buffer");
             break;
+        case rpn_processing_error::UnbalancedBlock:
+            callback("Unbalanced if / else / then block");
+            break;
+        case rpn_processing_error::InvalidDefinition:
+            callback("Invalid word definition");
+            break;
+        case rpn_processing_error::WordDepthExceeded:
+            callback("Too many nested word calls");
+            break;
         }
     }
 
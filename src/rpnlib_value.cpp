@@ -22,6 +22,9 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "rpnlib.h"
 #include "rpnlib_value.h"
+#include "rpnlib_series.h"
+#include "rpnlib_sketch.h"
+#include "rpnlib_string.h"
 
 #include <limits>
 
@@ -60,6 +63,12 @@ rpn_value_error _rpn_can_divide_by(const rpn_value& value) {
         break;
     }
 
+    case rpn_value::Type::Fixed:
+        if (0 == value.toFixed().raw) {
+            result = rpn_value_error::DivideByZero;
+        }
+        break;
+
     case rpn_value::Type::Null:
         return rpn_value_error::IsNull;
 
@@ -95,6 +104,8 @@ rpn_value_error _rpn_can_divide_by(const rpn_value& value) {
     case rpn_value::Type::Error:
     case rpn_value::Type::Boolean:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         result = rpn_value_error::InvalidOperation;
         break;
 
@@ -180,27 +191,128 @@ rpn_value::rpn_value(rpn_float value) :
 {}
 
 rpn_value::rpn_value(const char* value) :
-    type(rpn_value::Type::String)
+    type(rpn_value::Type::Null)
 {
-    new (&as_string) String(value);
+    if (!value) {
+        value = "";
+    }
+    assignString(value, strlen(value));
 }
 
+rpn_value::rpn_value(const char* data, size_t length) :
+    type(rpn_value::Type::Null)
+{
+    assignString(data, length);
+}
+
+rpn_value::rpn_value(rpn_fixed value) :
+    type(rpn_value::Type::Fixed),
+    as_fixed(value)
+{}
+
 rpn_value::rpn_value(const String& value) :
-    type(rpn_value::Type::String)
+    type(rpn_value::Type::Null)
 {
-    new (&as_string) String(value);
+    assignString(value.c_str(), value.length());
 }
 
 rpn_value::rpn_value(String&& value) :
-    type(rpn_value::Type::String)
+    type(rpn_value::Type::Null)
 {
+    type = rpn_value::Type::String;
+    storage = StringStorage::Heap;
     new (&as_string) String(std::move(value));
 }
 
+rpn_value::rpn_value(rpn_string_entry* entry) :
+    type(rpn_value::Type::String),
+    storage(StringStorage::Interned),
+    as_interned(rpn_string_acquire(entry))
+{}
+
+rpn_value::rpn_value(const rpn_series& value) :
+    type(rpn_value::Type::Series),
+    as_series(new rpn_series(value))
+{}
+
+rpn_value::rpn_value(rpn_series&& value) :
+    type(rpn_value::Type::Series),
+    as_series(new rpn_series(std::move(value)))
+{}
+
+rpn_value::rpn_value(const rpn_sketch& value) :
+    type(rpn_value::Type::Sketch),
+    as_sketch(new rpn_sketch(value))
+{}
+
+rpn_value::rpn_value(rpn_sketch&& value) :
+    type(rpn_value::Type::Sketch),
+    as_sketch(new rpn_sketch(std::move(value)))
+{}
+
 rpn_value::~rpn_value() {
-    if (type == rpn_value::Type::String) {
-        as_string.~String();
+    reset();
+}
+
+// String, Series and Sketch own their data, which needs to be released before the value type changes
+void rpn_value::reset() noexcept {
+    switch (type) {
+    case rpn_value::Type::String:
+        switch (storage) {
+        case StringStorage::Heap:
+            as_string.~String();
+            break;
+        case StringStorage::Interned:
+            rpn_string_release(as_interned);
+            break;
+        }
+        break;
+    case rpn_value::Type::Series:
+        delete as_series;
+        break;
+    case rpn_value::Type::Sketch:
+        delete as_sketch;
+        break;
+    case rpn_value::Type::Null:
+    case rpn_value::Type::Error:
+    case rpn_value::Type::Boolean:
+    case rpn_value::Type::Integer:
+    case rpn_value::Type::Unsigned:
+    case rpn_value::Type::Float:
+    case rpn_value::Type::Fixed:
+        break;
+    }
+
+    type = rpn_value::Type::Null;
+}
+
+// value must not contain anything that needs to be released
+// length is explicit, so the string may contain NUL characters
+void rpn_value::assignString(const char* data, size_t length) {
+    type = rpn_value::Type::String;
+    storage = StringStorage::Heap;
+    new (&as_string) String();
+    as_string.concat(data, length);
+}
+
+const char* rpn_value::stringData() const {
+    if (storage == StringStorage::Interned) {
+        return as_interned->data;
+    }
+
+    return as_string.c_str();
+}
+
+size_t rpn_value::stringLength() const {
+    if (storage == StringStorage::Interned) {
+        return as_interned->length;
     }
+
+    return as_string.length();
+}
+
+rpn_value::StringStorage rpn_value::stringStorage() const {
+    return storage;
 }
 
 void rpn_value::assignPrimitive(const rpn_value& other) noexcept {
@@ -222,7 +334,12 @@ void rpn_value::assignPrimitive(const rpn_value& other) noexcept {
     case rpn_value::Type::Float:
         as_float = other.as_float;
         break;
+    case rpn_value::Type::Fixed:
+        as_fixed = other.as_fixed;
+        break;
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         // XXX: handled externally, noexcept
         return;
     }
@@ -242,6 +359,9 @@ rpn_value_error rpn_value::toError() const {
     case rpn_value::Type::Unsigned:
     case rpn_value::Type::Float:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
+    case rpn_value::Type::Fixed:
     case rpn_value::Type::Null:
         break;
     }
@@ -265,11 +385,18 @@ bool rpn_value::toBoolean() const {
     case rpn_value::Type::Float:
         result = static_cast<rpn_float>(0.0) != as_float;
         break;
-    case rpn_value::Type::String: {
-        using size_type = decltype(std::declval<String>().length());
-        result = static_cast<size_type>(0ul) < as_string.length();
+    case rpn_value::Type::Fixed:
+        result = 0 != as_fixed.raw;
+        break;
+    case rpn_value::Type::String:
+        result = stringLength() > 0;
+        break;
+    case rpn_value::Type::Series:
+        result = as_series->size() > 0;
+        break;
+    case rpn_value::Type::Sketch:
+        result = as_sketch->count() > 0.0;
         break;
-    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
         break;
@@ -314,9 +441,20 @@ rpn_optional<rpn_int> rpn_value::checkedToInt() const {
         result = rpn_value_error::OutOfRangeConversion;
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto value = as_fixed.round(0).raw / rpn_fixed::One;
+        if ((std::numeric_limits<rpn_int>::min() <= value) && (value <= std::numeric_limits<rpn_int>::max())) {
+            result = static_cast<rpn_int>(value);
+            break;
+        }
+        result = rpn_value_error::OutOfRangeConversion;
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -365,9 +503,20 @@ rpn_optional<rpn_uint> rpn_value::checkedToUint() const {
         result = rpn_value_error::OutOfRangeConversion;
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto value = as_fixed.round(0).raw / rpn_fixed::One;
+        if ((0 <= value) && (static_cast<rpn_fixed::unsigned_wide_type>(value) <= std::numeric_limits<rpn_uint>::max())) {
+            result = static_cast<rpn_uint>(value);
+            break;
+        }
+        result = rpn_value_error::OutOfRangeConversion;
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -399,9 +548,14 @@ rpn_optional<rpn_float> rpn_value::checkedToFloat() const {
     case rpn_value::Type::Unsigned:
         result = static_cast<rpn_float>(as_unsigned);
         break;
+    case rpn_value::Type::Fixed:
+        result = static_cast<rpn_float>(as_fixed.raw) / static_cast<rpn_float>(rpn_fixed::One);
+        break;
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -412,6 +566,64 @@ rpn_float rpn_value::toFloat() const {
     return isFloat() ? as_float : checkedToFloat().value();
 }
 
+// Integer conversions are exact, floating point is rounded to the nearest representable value
+rpn_optional<rpn_fixed> rpn_value::checkedToFixed() const {
+    rpn_optional<rpn_fixed> result(
+        rpn_fixed::fromRaw(0),
+        rpn_value_error::ImpossibleConversion
+    );
+
+    using wide_type = rpn_fixed::wide_type;
+    constexpr wide_type upper = rpn_fixed::Max / rpn_fixed::One;
+    constexpr wide_type lower = rpn_fixed::Min / rpn_fixed::One;
+
+    switch (type) {
+    case rpn_value::Type::Fixed:
+        result = as_fixed;
+        break;
+    case rpn_value::Type::Boolean:
+        result = rpn_fixed::fromRaw(as_boolean ? rpn_fixed::One : 0);
+        break;
+    case rpn_value::Type::Integer:
+        if ((lower <= as_integer) && (as_integer <= upper)) {
+            result = rpn_fixed::fromRaw(static_cast<rpn_fixed::raw_type>(as_integer * rpn_fixed::One));
+            break;
+        }
+        result = rpn_value_error::OutOfRangeConversion;
+        break;
+    case rpn_value::Type::Unsigned:
+        if (static_cast<rpn_fixed::unsigned_wide_type>(as_unsigned) <= static_cast<rpn_fixed::unsigned_wide_type>(upper)) {
+            result = rpn_fixed::fromRaw(static_cast<rpn_fixed::raw_type>(as_unsigned * rpn_fixed::One));
+            break;
+        }
+        result = rpn_value_error::OutOfRangeConversion;
+        break;
+    case rpn_value::Type::Float: {
+        const rpn_float value = rpnlib_round(as_float * static_cast<rpn_float>(rpn_fixed::One));
+        if ((static_cast<rpn_float>(rpn_fixed::Min) <= value) && (value <= static_cast<rpn_float>(rpn_fixed::Max))) {
+            result = rpn_fixed::fromRaw(static_cast<rpn_fixed::raw_type>(value));
+            break;
+        }
+        result = std::isnan(value)
+            ? rpn_value_error::IEEE754
+            : rpn_value_error::OutOfRangeConversion;
+        break;
+    }
+    case rpn_value::Type::Null:
+    case rpn_value::Type::Error:
+    case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
+        break;
+    }
+
+    return result;
+}
+
+rpn_fixed rpn_value::toFixed() const {
+    return isFixed() ? as_fixed : checkedToFixed().value();
+}
+
 String rpn_value::toString() const {
     String result("");
 
@@ -436,8 +648,27 @@ String rpn_value::toString() const {
     case rpn_value::Type::Float:
         result = String(as_float);
         break;
+    case rpn_value::Type::Fixed:
+        result = as_fixed.toString();
+        break;
     case rpn_value::Type::String:
-        result = as_string;
+        if (storage == StringStorage::Heap) {
+            result = as_string;
+        } else {
+            result.concat(stringData(), stringLength());
+        }
+        break;
+    case rpn_value::Type::Series:
+        result = F("<rpn_series:");
+        result += String(as_series->size());
+        result += F("/");
+        result += String(as_series->capacity());
+        result += F(">");
+        break;
+    case rpn_value::Type::Sketch:
+        result = F("<rpn_sketch:");
+        result += String(as_sketch->count());
+        result += F(">");
         break;
     }
 
@@ -478,10 +709,19 @@ bool rpn_value::operator<(const rpn_value& other) const {
         }
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (conversion.ok()) {
+            result = as_fixed < conversion.value();
+        }
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::Boolean:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -518,10 +758,19 @@ bool rpn_value::operator>(const rpn_value& other) const {
         }
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (conversion.ok()) {
+            result = as_fixed > conversion.value();
+        }
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::Boolean:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -584,8 +833,32 @@ bool rpn_value::operator==(const rpn_value& other) const {
 
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (conversion.ok()) {
+            result = as_fixed == conversion.value();
+        }
+        break;
+    }
+    // strings of the same pool are never duplicated, different entries always have different contents
     case rpn_value::Type::String:
-        result = (as_string == other.as_string);
+        if ((storage == StringStorage::Interned) && (other.storage == StringStorage::Interned)) {
+            if (as_interned == other.as_interned) {
+                result = true;
+                break;
+            }
+
+            if (as_interned->pool == other.as_interned->pool) {
+                break;
+            }
+        }
+
+        if (stringLength() == other.stringLength()) {
+            result = 0 == std::memcmp(stringData(), other.stringData(), stringLength());
+        }
+        break;
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -623,13 +896,14 @@ rpn_value rpn_value::operator+(const rpn_value& other) {
         }
         val.type = rpn_value::Type::String;
 
-        const auto our_size = as_string.length();
-        const auto other_size = other.as_string.length();
+        const auto our_size = stringLength();
+        const auto other_size = other.stringLength();
 
+        val.storage = StringStorage::Heap;
         new (&val.as_string) String();
         val.as_string.reserve(our_size + other_size + 1);
-        val.as_string += as_string;
-        val.as_string += other.as_string;
+        val.as_string.concat(stringData(), our_size);
+        val.as_string.concat(other.stringData(), other_size);
         break;
     }
     // just do generic math
@@ -670,8 +944,20 @@ rpn_value rpn_value::operator+(const rpn_value& other) {
         val.as_float = as_float + conversion.value();
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (!conversion.ok()) {
+            val = rpn_value(conversion.error());
+            break;
+        }
+        val.type = rpn_value::Type::Fixed;
+        val.as_fixed = as_fixed + conversion.value();
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -724,9 +1010,21 @@ rpn_value rpn_value::operator-(const rpn_value& other) {
         val.as_float = as_float - conversion.value();
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (!conversion.ok()) {
+            val = rpn_value(conversion.error());
+            break;
+        }
+        val.type = rpn_value::Type::Fixed;
+        val.as_fixed = as_fixed - conversion.value();
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -778,9 +1076,21 @@ rpn_value rpn_value::operator*(const rpn_value& other) {
         val.as_float = as_float * conversion.value();
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (!conversion.ok()) {
+            val = rpn_value(conversion.error());
+            break;
+        }
+        val.type = rpn_value::Type::Fixed;
+        val.as_fixed = as_fixed * conversion.value();
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -841,9 +1151,25 @@ rpn_value rpn_value::operator/(const rpn_value& other) {
         val.as_float = as_float / conversion.value();
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (!conversion.ok()) {
+            val = rpn_value(conversion.error());
+            break;
+        }
+        if (0 == conversion.value().raw) {
+            val = rpn_value(rpn_value_error::DivideByZero);
+            break;
+        }
+        val.type = rpn_value::Type::Fixed;
+        val.as_fixed = as_fixed / conversion.value();
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -904,9 +1230,25 @@ rpn_value rpn_value::operator%(const rpn_value& other) {
         val.as_float = as_float - (std::floor(as_float / conversion.value()) * conversion.value());
         break;
     }
+    case rpn_value::Type::Fixed: {
+        auto conversion = other.checkedToFixed();
+        if (!conversion.ok()) {
+            val = rpn_value(conversion.error());
+            break;
+        }
+        if (0 == conversion.value().raw) {
+            val = rpn_value(rpn_value_error::DivideByZero);
+            break;
+        }
+        val.type = rpn_value::Type::Fixed;
+        val.as_fixed = as_fixed % conversion.value();
+        break;
+    }
     case rpn_value::Type::Null:
     case rpn_value::Type::Error:
     case rpn_value::Type::String:
+    case rpn_value::Type::Series:
+    case rpn_value::Type::Sketch:
         break;
     }
 
@@ -917,13 +1259,41 @@ rpn_value rpn_value::operator%(const rpn_value& other) {
 // TODO: note that both are used for ctors as well
 
 rpn_value& rpn_value::operator=(const rpn_value& other) {
+    if (this == &other) {
+        return *this;
+    }
+
     if (other.type == Type::String) {
-        if (type == rpn_value::Type::String) {
+        if ((type == rpn_value::Type::String) && (storage == StringStorage::Heap) && (other.storage == StringStorage::Heap)) {
             as_string = other.as_string;
         } else {
-            new (&as_string) String(other.as_string);
+            reset();
+            switch (other.storage) {
+            case StringStorage::Heap:
+                new (&as_string) String(other.as_string);
+                break;
+            case StringStorage::Interned:
+                as_interned = rpn_string_acquire(other.as_interned);
+                break;
+            }
+            storage = other.storage;
+        }
+    } else if (other.type == Type::Series) {
+        if (type == rpn_value::Type::Series) {
+            *as_series = *other.as_series;
+        } else {
+            reset();
+            as_series = new rpn_series(*other.as_series);
+        }
+    } else if (other.type == Type::Sketch) {
+        if (type == rpn_value::Type::Sketch) {
+            *as_sketch = *other.as_sketch;
+        } else {
+            reset();
+            as_sketch = new rpn_sketch(*other.as_sketch);
         }
     } else {
+        reset();
         assignPrimitive(other);
     }
     type = other.type;
@@ -931,13 +1301,30 @@ rpn_value& rpn_value::operator=(const rpn_value& other) {
 }
 
 rpn_value& rpn_value::operator=(rpn_value&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
     if (other.type == rpn_value::Type::String) {
-        if (type == rpn_value::Type::String) {
-            as_string = std::move(other.as_string);
-        } else {
+        reset();
+        switch (other.storage) {
+        case StringStorage::Heap:
             new (&as_string) String(std::move(other.as_string));
+            other.as_string.~String();
+            break;
+        case StringStorage::Interned:
+            as_interned = other.as_interned;
+            break;
         }
+        storage = other.storage;
+    } else if (other.type == rpn_value::Type::Series) {
+        reset();
+        as_series = other.as_series;
+    } else if (other.type == rpn_value::Type::Sketch) {
+        reset();
+        as_sketch = other.as_sketch;
     } else {
+        reset();
         assignPrimitive(other);
     }
     type = other.type;
@@ -965,14 +1352,42 @@ bool rpn_value::isString() const {
     return is(rpn_value::Type::String);
 }
 
+bool rpn_value::isSeries() const {
+    return is(rpn_value::Type::Series);
+}
+
+rpn_series& rpn_value::toSeries() {
+    return *as_series;
+}
+
+const rpn_series& rpn_value::toSeries() const {
+    return *as_series;
+}
+
+bool rpn_value::isSketch() const {
+    return is(rpn_value::Type::Sketch);
+}
+
+rpn_sketch& rpn_value::toSketch() {
+    return *as_sketch;
+}
+
+const rpn_sketch& rpn_value::toSketch() const {
+    return *as_sketch;
+}
+
 bool rpn_value::isNumber() const {
-    return is(rpn_value::Type::Float) || is(rpn_value::Type::Integer) || is(rpn_value::Type::Unsigned);
+    return is(rpn_value::Type::Float) || is(rpn_value::Type::Integer) || is(rpn_value::Type::Unsigned) || is(rpn_value::Type::Fixed);
 }
 
 bool rpn_value::isFloat() const {
     return is(rpn_value::Type::Float);
 }
 
+bool rpn_value::isFixed() const {
+    return is(rpn_value::Type::Fixed);
+}
+
 bool rpn_value::isInt() const {
     return is(rpn_value::Type::Integer);
 }
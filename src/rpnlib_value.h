@@ -30,6 +30,11 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 #include <limits>
 
 #include "rpnlib_error.h"
+#include "rpnlib_fixed.h"
+
+struct rpn_series;
+struct rpn_sketch;
+struct rpn_string_entry;
 
 template <typename T>
 struct rpn_optional {
@@ -84,7 +89,10 @@ struct rpn_value {
         Integer,
         Unsigned,
         Float,
-        String
+        String,
+        Series,
+        Sketch,
+        Fixed
     };
 
     rpn_value();
@@ -96,9 +104,18 @@ struct rpn_value {
     explicit rpn_value(rpn_int);
     explicit rpn_value(rpn_uint);
     explicit rpn_value(rpn_float);
+    explicit rpn_value(rpn_fixed);
     explicit rpn_value(const char*);
+    rpn_value(const char*, size_t);
     explicit rpn_value(const String&);
     explicit rpn_value(String&&);
+    explicit rpn_value(const rpn_series&);
+    explicit rpn_value(rpn_series&&);
+    explicit rpn_value(const rpn_sketch&);
+    explicit rpn_value(rpn_sketch&&);
+
+    // Takes a new reference to the interned string, see rpn_string_pool
+    explicit rpn_value(rpn_string_entry*);
 
     template <typename T>
     explicit rpn_value(rpn_optional<T> value) :
@@ -136,13 +153,22 @@ struct rpn_value {
     rpn_int toInt() const;
     rpn_uint toUint() const;
     rpn_float toFloat() const;
+    rpn_fixed toFixed() const;
     String toString() const;
 
+    // Series and Sketch are only available by reference, and must be checked with isSeries() or isSketch() beforehand
+    rpn_series& toSeries();
+    const rpn_series& toSeries() const;
+
+    rpn_sketch& toSketch();
+    const rpn_sketch& toSketch() const;
+
     // Optional result when we need to ensure that target
     // value did convert without any issues
     rpn_optional<rpn_int> checkedToInt() const;
     rpn_optional<rpn_uint> checkedToUint() const;
     rpn_optional<rpn_float> checkedToFloat() const;
+    rpn_optional<rpn_fixed> checkedToFixed() const;
 
     bool is(Type) const;
     bool isError() const;
@@ -151,13 +177,32 @@ struct rpn_value {
     bool isInt() const;
     bool isUint() const;
     bool isFloat() const;
+    bool isFixed() const;
     bool isNumber() const;
     bool isString() const;
+    bool isSeries() const;
+    bool isSketch() const;
+
+    // Interned strings share the buffer of the pool entry, every other string owns a String
+    enum class StringStorage : uint8_t {
+        Heap,
+        Interned
+    };
+
+    StringStorage stringStorage() const;
+
+    // Contents of the string value, without copying them into a String. Must be checked with isString() beforehand
+    const char* stringData() const;
+    size_t stringLength() const;
 
     Type type;
 
 private:
     void assignPrimitive(const rpn_value&) noexcept;
+    void assignString(const char*, size_t);
+    void reset() noexcept;
+
+    StringStorage storage { StringStorage::Heap };
 
     union {
         rpn_value_error as_error;
@@ -165,7 +210,12 @@ private:
         rpn_int as_integer;
         rpn_uint as_unsigned;
         rpn_float as_float;
+        rpn_fixed as_fixed;
         String as_string;
+        rpn_string_entry* as_interned;
+        rpn_series* as_series;
+        rpn_sketch* as_sketch;
     };
 };
 
+#include "rpnlib_value_ptr.h"
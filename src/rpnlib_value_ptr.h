@@ -0,0 +1,245 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Shared handle of the value, used by the stack and the variables.
+// By default, this is std::shared_ptr. RPNLIB_INTRUSIVE_REFCOUNT=1 allocates reference counters together with the value,
+// and counts references with plain integers instead of the atomic ones. Handles must not be shared between threads in that case
+#if RPNLIB_INTRUSIVE_REFCOUNT
+
+struct rpn_value_node {
+    rpn_value* get() {
+        return reinterpret_cast<rpn_value*>(&storage);
+    }
+
+    // value is destroyed when the last strong reference is gone, node itself when the weak ones are gone too
+    size_t strong;
+    size_t weak;
+    std::aligned_storage<sizeof(rpn_value), alignof(rpn_value)>::type storage;
+};
+
+struct rpn_value_weak_ptr;
+
+struct rpn_value_ptr {
+    rpn_value_ptr() = default;
+
+    rpn_value_ptr(std::nullptr_t) noexcept
+    {}
+
+    rpn_value_ptr(const rpn_value_ptr& other) noexcept :
+        _node(other._node)
+    {
+        if (_node) {
+            ++_node->strong;
+        }
+    }
+
+    rpn_value_ptr(rpn_value_ptr&& other) noexcept :
+        _node(other._node)
+    {
+        other._node = nullptr;
+    }
+
+    ~rpn_value_ptr() {
+        reset();
+    }
+
+    rpn_value_ptr& operator=(const rpn_value_ptr& other) noexcept {
+        rpn_value_ptr(other).swap(*this);
+        return *this;
+    }
+
+    rpn_value_ptr& operator=(rpn_value_ptr&& other) noexcept {
+        rpn_value_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(rpn_value_ptr& other) noexcept {
+        std::swap(_node, other._node);
+    }
+
+    void reset() noexcept {
+        if (!_node) {
+            return;
+        }
+
+        auto* node = _node;
+        _node = nullptr;
+
+        if (0 == --node->strong) {
+            node->get()->~rpn_value();
+            if (0 == node->weak) {
+                delete node;
+            }
+        }
+    }
+
+    rpn_value* get() const noexcept {
+        return _node ? _node->get() : nullptr;
+    }
+
+    rpn_value& operator*() const noexcept {
+        return *get();
+    }
+
+    rpn_value* operator->() const noexcept {
+        return get();
+    }
+
+    long use_count() const noexcept {
+        return _node ? static_cast<long>(_node->strong) : 0;
+    }
+
+    explicit operator bool() const noexcept {
+        return nullptr != _node;
+    }
+
+    bool operator==(const rpn_value_ptr& other) const noexcept {
+        return _node == other._node;
+    }
+
+    bool operator!=(const rpn_value_ptr& other) const noexcept {
+        return _node != other._node;
+    }
+
+    template <typename Other>
+    bool owner_before(const Other& other) const noexcept {
+        return _node < other._node;
+    }
+
+    private:
+
+    friend struct rpn_value_weak_ptr;
+
+    template <typename... Args>
+    friend rpn_value_ptr rpn_make_value(Args&&...);
+
+    explicit rpn_value_ptr(rpn_value_node* node) noexcept :
+        _node(node)
+    {}
+
+    rpn_value_node* _node { nullptr };
+};
+
+struct rpn_value_weak_ptr {
+    rpn_value_weak_ptr() = default;
+
+    rpn_value_weak_ptr(const rpn_value_ptr& ptr) noexcept :
+        _node(ptr._node)
+    {
+        if (_node) {
+            ++_node->weak;
+        }
+    }
+
+    rpn_value_weak_ptr(const rpn_value_weak_ptr& other) noexcept :
+        rpn_value_weak_ptr(other._node)
+    {}
+
+    rpn_value_weak_ptr(rpn_value_weak_ptr&& other) noexcept :
+        _node(other._node)
+    {
+        other._node = nullptr;
+    }
+
+    ~rpn_value_weak_ptr() {
+        reset();
+    }
+
+    rpn_value_weak_ptr& operator=(const rpn_value_weak_ptr& other) noexcept {
+        rpn_value_weak_ptr(other).swap(*this);
+        return *this;
+    }
+
+    rpn_value_weak_ptr& operator=(rpn_value_weak_ptr&& other) noexcept {
+        rpn_value_weak_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(rpn_value_weak_ptr& other) noexcept {
+        std::swap(_node, other._node);
+    }
+
+    void reset() noexcept {
+        if (!_node) {
+            return;
+        }
+
+        auto* node = _node;
+        _node = nullptr;
+
+        if ((0 == --node->weak) && (0 == node->strong)) {
+            delete node;
+        }
+    }
+
+    bool expired() const noexcept {
+        return !_node || !_node->strong;
+    }
+
+    template <typename Other>
+    bool owner_before(const Other& other) const noexcept {
+        return _node < other._node;
+    }
+
+    private:
+
+    friend struct rpn_value_ptr;
+
+    explicit rpn_value_weak_ptr(rpn_value_node* node) noexcept :
+        _node(node)
+    {
+        if (_node) {
+            ++_node->weak;
+        }
+    }
+
+    rpn_value_node* _node { nullptr };
+};
+
+template <typename... Args>
+rpn_value_ptr rpn_make_value(Args&&... args) {
+    auto* node = new rpn_value_node;
+    new (&node->storage) rpn_value(std::forward<Args>(args)...);
+    node->strong = 1;
+    node->weak = 0;
+
+    return rpn_value_ptr(node);
+}
+
+#else
+
+using rpn_value_ptr = std::shared_ptr<rpn_value>;
+using rpn_value_weak_ptr = std::weak_ptr<rpn_value>;
+
+template <typename... Args>
+rpn_value_ptr rpn_make_value(Args&&... args) {
+    return std::make_shared<rpn_value>(std::forward<Args>(args)...);
+}
+
+#endif
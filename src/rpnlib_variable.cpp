@@ -60,7 +60,7 @@ bool _rpn_variable_set(rpn_context & ctxt, const String& name, Value&& value) {
         return true;
     }
 
-    ctxt.variables.emplace_front(name, std::make_shared<rpn_value>(std::forward<Value>(value)));
+    ctxt.variables.emplace_front(name, rpn_make_value(std::forward<Value>(value)));
     return true;
 }
 
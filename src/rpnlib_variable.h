@@ -37,7 +37,7 @@ struct rpn_variable {
     {}
 
     template <typename Name>
-    rpn_variable(Name&& name, std::shared_ptr<rpn_value> value) :
+    rpn_variable(Name&& name, rpn_value_ptr value) :
         name(std::forward<Name>(name)),
         value(value)
     {}
@@ -45,11 +45,11 @@ struct rpn_variable {
     template <typename Name, typename Value>
     rpn_variable(Name&& name, Value&& value) :
         name(std::forward<Name>(name)),
-        value(std::make_shared<rpn_value>(std::forward<Value>(value)))
+        value(rpn_make_value(std::forward<Value>(value)))
     {}
 
     String name;
-    std::shared_ptr<rpn_value> value;
+    rpn_value_ptr value;
 };
 
 bool rpn_variable_set(rpn_context &, const String& name, const rpn_value& value);
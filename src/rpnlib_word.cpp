@@ -0,0 +1,56 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "rpnlib.h"
+#include "rpnlib_word.h"
+
+#include <iterator>
+
+// ----------------------------------------------------------------------------
+// Words methods
+// ----------------------------------------------------------------------------
+
+// note that rpn_word_set() lives in rpnlib.cpp, since it needs the expression tokenizer
+
+bool rpn_word_del(rpn_context & ctxt, const char * name) {
+    auto end = ctxt.words.end();
+    auto prev = ctxt.words.before_begin();
+    auto word = prev;
+
+    while (word != end) {
+        prev = word++;
+        if ((word != end) && (*word).name.equals(name)) {
+            ctxt.words.erase_after(prev);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t rpn_words_size(rpn_context & ctxt) {
+    return std::distance(ctxt.words.begin(), ctxt.words.end());
+}
+
+bool rpn_words_clear(rpn_context & ctxt) {
+    ctxt.words.clear();
+    return true;
+}
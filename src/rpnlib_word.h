@@ -0,0 +1,86 @@
+/*
+
+RPNlib
+
+Copyright (C) 2020 by Maxim Prokhorov <prokhorov dot max at outlook dot com>
+
+The rpnlib library is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+The rpnlib library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "rpnlib.h"
+#include "rpnlib_value.h"
+
+#include <vector>
+
+// Pre-parsed expression token. Literals are converted into the value when the word is defined,
+// variables and words are still resolved by their name when the instruction is executed
+struct rpn_instruction {
+    enum class Type {
+        Value,
+        VariableValue,
+        VariableReference,
+        StackPush,
+        StackPop,
+        Word
+    };
+
+    rpn_instruction() = delete;
+
+    explicit rpn_instruction(Type type) :
+        type(type)
+    {}
+
+    rpn_instruction(Type type, rpn_value&& value) :
+        type(type),
+        value(std::move(value))
+    {}
+
+    rpn_instruction(Type type, const char* name) :
+        type(type),
+        name(name)
+    {}
+
+    Type type;
+    rpn_value value;
+    String name;
+};
+
+// User-defined word, either created from the expression using `: name ... ;` or via rpn_word_set()
+struct rpn_word {
+    using body_type = std::vector<rpn_instruction>;
+
+    rpn_word(const rpn_word&) = default;
+    rpn_word(rpn_word&& other) noexcept :
+        name(std::move(other.name)),
+        body(std::move(other.body))
+    {}
+
+    template <typename Name>
+    rpn_word(Name&& name, body_type&& body) :
+        name(std::forward<Name>(name)),
+        body(std::move(body))
+    {}
+
+    String name;
+    body_type body;
+};
+
+bool rpn_word_set(rpn_context &, const char * name, const char * expression);
+bool rpn_word_del(rpn_context &, const char * name);
+
+size_t rpn_words_size(rpn_context &);
+bool rpn_words_clear(rpn_context &);
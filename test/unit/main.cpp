@@ -44,6 +44,11 @@ along with the rpnlib library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <rpnlib.h>
 
+#if RPNLIB_ENGINE
+#include <atomic>
+#include <thread>
+#endif
+
 // -----------------------------------------------------------------------------
 // Helper methods
 // -----------------------------------------------------------------------------
@@ -79,8 +84,14 @@ const char* explain_type(rpn_value::Type type) {
         return "Unsigned";
     case rpn_value::Type::Float:
         return "Float";
+    case rpn_value::Type::Fixed:
+        return "Fixed";
     case rpn_value::Type::String:
         return "String";
+    case rpn_value::Type::Series:
+        return "Series";
+    case rpn_value::Type::Sketch:
+        return "Sketch";
     case rpn_value::Type::Boolean:
         return "Boolean";
     case rpn_value::Type::Null:
@@ -100,6 +111,8 @@ int explain_contents(char* output, size_t output_size, const rpn_value& value) {
         return snprintf(output, output_size - 1, "%" PRIuMAX, static_cast<std::uintmax_t>(value.toUint()));
     case rpn_value::Type::Float:
         return snprintf(output, output_size - 1, "%f", value.toFloat());
+    case rpn_value::Type::Fixed:
+        return snprintf(output, output_size - 1, "%sq", value.toString().c_str());
     case rpn_value::Type::String:
         return snprintf(output, output_size - 1, "\"%s\"", value.toString().c_str());
     case rpn_value::Type::Boolean:
@@ -392,6 +405,76 @@ void test_trig() {
 #endif
 }
 
+// documented max error of the approximations, see rpnlib_fmath.h
+void test_fmath_fast() {
+    rpn_float error = 0.0;
+    for (rpn_float x = -1e5; x <= 1e5; x += 0.731) {
+        error = std::fmax(error, std::fabs(rpn_fmath_fast_sin(x) - std::sin(x)));
+        error = std::fmax(error, std::fabs(rpn_fmath_fast_cos(x) - std::cos(x)));
+    }
+    TEST_ASSERT_TRUE(error <= 1.5e-7);
+
+    error = 0.0;
+    for (rpn_float x = -700.0; x <= 700.0; x += 0.0731) {
+        error = std::fmax(error, std::fabs(rpn_fmath_fast_exp(x) - std::exp(x)) / std::exp(x));
+    }
+    TEST_ASSERT_TRUE(error <= 2e-7);
+
+    error = 0.0;
+    for (rpn_float x = 1e-300; x <= 1e300; x *= 1.0731) {
+        error = std::fmax(error, std::fabs(rpn_fmath_fast_log(x) - std::log(x)));
+        error = std::fmax(error, 2.0 * std::fabs(rpn_fmath_fast_log10(x) - std::log10(x)));
+    }
+    TEST_ASSERT_TRUE(error <= 3e-8);
+
+    error = 0.0;
+    for (rpn_float x = 0.01; x <= 100.0; x *= 1.0731) {
+        for (rpn_float y = -10.0; y <= 10.0; y += 0.731) {
+            auto expected = std::pow(x, y);
+            error = std::fmax(error, std::fabs(rpn_fmath_fast_pow(x, y) - expected) / expected / (1.0 + std::fabs(y)));
+        }
+    }
+    TEST_ASSERT_TRUE(error <= 2e-7);
+
+    TEST_ASSERT_EQUAL_FLOAT(-8.0, rpn_fmath_fast_pow(-2.0, 3.0));
+    TEST_ASSERT_TRUE(std::isnan(rpn_fmath_fast_pow(-2.0, 0.5)));
+
+    // zero keeps it's sign with odd integer exponents
+    TEST_ASSERT_TRUE(std::isinf(rpn_fmath_fast_pow(-0.0, -1.0)) && std::signbit(rpn_fmath_fast_pow(-0.0, -1.0)));
+    TEST_ASSERT_TRUE(std::isinf(rpn_fmath_fast_pow(-0.0, -2.0)) && !std::signbit(rpn_fmath_fast_pow(-0.0, -2.0)));
+    TEST_ASSERT_TRUE(std::isinf(rpn_fmath_fast_pow(0.0, -1.0)) && !std::signbit(rpn_fmath_fast_pow(0.0, -1.0)));
+    TEST_ASSERT_TRUE((rpn_fmath_fast_pow(-0.0, 3.0) == 0.0) && std::signbit(rpn_fmath_fast_pow(-0.0, 3.0)));
+    TEST_ASSERT_TRUE((rpn_fmath_fast_pow(-0.0, 2.0) == 0.0) && !std::signbit(rpn_fmath_fast_pow(-0.0, 2.0)));
+    TEST_ASSERT_TRUE(std::isnan(rpn_fmath_fast_pow(0.0, std::numeric_limits<rpn_float>::quiet_NaN())));
+
+    // non-finite inputs of sin, cos and tan are NaN
+    const rpn_float non_finite[] {
+        std::numeric_limits<rpn_float>::quiet_NaN(),
+        std::numeric_limits<rpn_float>::infinity(),
+        -std::numeric_limits<rpn_float>::infinity(),
+    };
+    for (auto x : non_finite) {
+        TEST_ASSERT_TRUE(std::isnan(rpn_fmath_fast_sin(x)));
+        TEST_ASSERT_TRUE(std::isnan(rpn_fmath_fast_cos(x)));
+        TEST_ASSERT_TRUE(std::isnan(rpn_fmath_fast_tan(x)));
+    }
+
+#ifdef RPNLIB_ADVANCED_MATH
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_fmath(ctxt, rpn_fmath_mode::Fast));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "0.5 sin -1 tan"));
+    TEST_ASSERT_FLOAT_WITHIN(2.5e-7, std::tan(-1.0), rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(1.5e-7, std::sin(0.5), rpn_stack_pop(ctxt).toFloat());
+
+    TEST_ASSERT_TRUE(rpn_fmath(ctxt, rpn_fmath_mode::Exact));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "-1 sin 4 sin"));
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, std::sin(4.0), rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, std::sin(-1.0), rpn_stack_pop(ctxt).toFloat());
+#endif
+}
+
 void test_cast() {
     run_and_compare("pi 2 round pi 4 round 1.1 floor 1.1 ceil",
             rpn_values(3.14, 3.1416, 1.0, 2.0));
@@ -420,6 +503,159 @@ void test_index() {
     run_and_error("index", rpn_operator_error::ArgumentCountMismatch);
 }
 
+void test_array_aggregates() {
+    run_and_compare("[ 1 2 3 4 5 ] sum", rpn_values(15.0));
+    run_and_compare("[ 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 ] sum", rpn_values(210.0));
+    run_and_compare("[ ] sum", rpn_values(0.0));
+    run_and_compare("[ 1 2 3 4 ] avg", rpn_values(2.5));
+    run_and_compare("[ 3 -1 5i 2 ] min", rpn_values(-1.0));
+    run_and_compare("[ 3 -1 5i 2 ] max", rpn_values<rpn_int>(5));
+    run_and_compare("[ 3 -1 5 2 ] count", rpn_values<rpn_uint>(4));
+    run_and_compare("100 [ 1 2 ] sum", rpn_values(100.0, 3.0));
+    run_and_compare("1 2 3 3 sum", rpn_values(6.0));
+    run_and_compare("[ 1i 2i 3i ] sum", rpn_values<rpn_int>(6));
+    run_and_compare("[ 1u 2u 3u ] sum", rpn_values<rpn_uint>(6u));
+    run_and_compare("[ 1i 2.5 ] sum", rpn_values(3.5));
+    run_and_compare("[ 1i 2i ] avg", rpn_values(1.5));
+
+    run_and_error("[ ] avg", rpn_operator_error::InvalidArgument);
+    run_and_error("[ ] min", rpn_operator_error::InvalidArgument);
+    run_and_error("[ 1 \"two\" ] sum", rpn_operator_error::InvalidType);
+    run_and_error("[ 1 \"two\" ] max", rpn_operator_error::InvalidType);
+    run_and_error("1 2 3 sum", rpn_operator_error::InvalidArgument);
+    run_and_error("sum", rpn_operator_error::ArgumentCountMismatch);
+}
+
+void test_array_selection() {
+    run_and_compare("[ 5 1 4 2 3 ] median", rpn_values(3.0));
+    run_and_compare("[ 6 1 5 2 4 3 ] median", rpn_values(3.5));
+    run_and_compare("[ 7i ] median", rpn_values(7.0));
+    run_and_compare("[ 1 2 3 100 2 1 ] median", rpn_values(2.0));
+
+    run_and_compare("50 [ 5 1 4 2 3 ] percentile", rpn_values(3.0));
+    run_and_compare("0 [ 5 1 4 2 3 ] percentile", rpn_values(1.0));
+    run_and_compare("100 [ 5 1 4 2 3 ] percentile", rpn_values(5.0));
+    run_and_compare("90 [ 10 40 30 20 ] percentile", rpn_values(37.0));
+
+    run_and_compare("0 [ 30 10 20 ] nth", rpn_values(10.0));
+    run_and_compare("1 [ 30 10 20 ] nth", rpn_values(20.0));
+    run_and_compare("-1 [ 30 10 20i ] nth", rpn_values(30.0));
+    run_and_compare("2 [ 30 10 20i ] nth", rpn_values<rpn_float>(30.0));
+    run_and_compare("123 0 [ 3 2 1 ] nth", rpn_values(123.0, 1.0));
+
+    // mixed arrays are ordered by the float value of every member
+    run_and_compare("[ 3u -1i 2i 2.5 ] median", rpn_values(2.25));
+    run_and_compare("1 [ 3u -1i 2.5 ] nth", rpn_values(2.5));
+    run_and_compare("2 [ 3u -1i 2.5 ] nth", rpn_values<rpn_uint>(3u));
+    run_and_compare("0 [ 3u -1i 2.5 ] nth", rpn_values<rpn_int>(-1));
+    run_and_compare("50 [ 4u 1i 3.0 2u ] percentile", rpn_values(2.5));
+
+    // member is picked by its position, integers that have the same float value are not mixed up
+    if (std::numeric_limits<rpn_int>::digits > std::numeric_limits<rpn_float>::digits) {
+        run_and_compare("2 [ 9007199254740992i 9007199254740993i 5i ] nth",
+            rpn_values<rpn_int>(static_cast<rpn_int>(INT64_C(9007199254740993))));
+    }
+
+    // arrays larger than RPNLIB_ARRAY_SELECT_SIZE work the same way
+    String large("[");
+    for (int value = (2 * RPNLIB_ARRAY_SELECT_SIZE) + 1; value > 0; --value) {
+        large += ' ';
+        large += String(value);
+    }
+    large += " ]";
+    run_and_compare((large + " median").c_str(), rpn_values<rpn_float>(RPNLIB_ARRAY_SELECT_SIZE + 1));
+    run_and_compare((String("-1 ") + large + " nth").c_str(), rpn_values<rpn_float>((2 * RPNLIB_ARRAY_SELECT_SIZE) + 1));
+
+    run_and_error("[ ] median", rpn_operator_error::InvalidArgument);
+    run_and_error("[ 1 \"two\" 3 ] median", rpn_operator_error::InvalidType);
+    run_and_error("[ 1 nan 3 ] median", rpn_value_error::IEEE754);
+    run_and_error("101 [ 1 2 3 ] percentile", rpn_operator_error::InvalidArgument);
+    run_and_error("[ 1 2 3 ] percentile", rpn_operator_error::ArgumentCountMismatch);
+    run_and_error("3 [ 1 2 3 ] nth", rpn_operator_error::InvalidArgument);
+    run_and_error("-4 [ 1 2 3 ] nth", rpn_operator_error::InvalidArgument);
+}
+
+void test_series() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "3 series &temp = drop"));
+    TEST_ASSERT_TRUE(rpn_variable_get(ctxt, "temp").isSeries());
+    TEST_ASSERT_EQUAL(0, rpn_stack_size(ctxt));
+
+    run_and_error_ctx(ctxt, "&temp avg", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    run_and_compare_ctx(ctxt, "5 &temp push 1 swap push 3 swap push count", rpn_values<rpn_uint>(3));
+    run_and_compare_ctx(ctxt, "&temp sum &temp avg &temp min &temp max", rpn_values(9.0, 3.0, 1.0, 5.0));
+
+    // oldest sample is removed from the series
+    run_and_compare_ctx(ctxt, "4 &temp push drop &temp sum &temp min &temp max", rpn_values(8.0, 1.0, 4.0));
+    run_and_compare_ctx(ctxt, "6 &temp push drop &temp sum &temp min &temp max", rpn_values(13.0, 3.0, 6.0));
+    run_and_compare_ctx(ctxt, "&temp 2 last", (rpn_values<rpn_float, rpn_float, rpn_uint>(4.0, 6.0, 2u)));
+    run_and_compare_ctx(ctxt, "&temp 3 last avg", rpn_values(13.0 / 3.0));
+    run_and_compare_ctx(ctxt, "&temp count", rpn_values<rpn_uint>(3));
+
+    run_and_error_ctx(ctxt, "&temp 4 last", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "1 2 push", rpn_operator_error::InvalidType);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "0 series", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // values are copied, including the series
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "$temp 10 swap push sum"));
+    TEST_ASSERT_EQUAL_FLOAT(20.0, rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_EQUAL_FLOAT(13.0, rpn_variable_get(ctxt, "temp").toSeries().sum());
+
+    // long-running series keeps the result within the last N samples
+    rpn_series series(4);
+    for (int sample = 0; sample < 1000; ++sample) {
+        series.push(static_cast<rpn_float>(sample % 7));
+    }
+    TEST_ASSERT_EQUAL(4, series.size());
+    TEST_ASSERT_EQUAL_FLOAT(2.0, series.min());
+    TEST_ASSERT_EQUAL_FLOAT(5.0, series.max());
+    TEST_ASSERT_EQUAL_FLOAT(14.0, series.sum());
+}
+
+void test_sketch() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "16 sketch &low = drop 16 sketch &high = drop"));
+    TEST_ASSERT_TRUE(rpn_variable_get(ctxt, "low").isSketch());
+
+    run_and_error_ctx(ctxt, "&low 0.5 quantile", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // samples are shuffled, so that the sketch does not receive them in order
+    for (int sample = 0; sample < 1000; ++sample) {
+        int value = ((sample * 337) % 1000) + 1;
+        String expression(value);
+        expression += (value <= 500) ? " &low push drop" : " &high push drop";
+        TEST_ASSERT_TRUE(rpn_process(ctxt, expression.c_str()));
+    }
+
+    run_and_compare_ctx(ctxt, "&low count &low min &low max", (rpn_values<rpn_uint, rpn_float, rpn_float>(500u, 1.0, 500.0)));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "&low &high merge drop"));
+    run_and_compare_ctx(ctxt, "&low count", rpn_values<rpn_uint>(1000u));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "&low 0.5 quantile &low median 99 &low percentile &low 0 quantile &low 1 quantile"));
+    TEST_ASSERT_EQUAL_FLOAT(1000.0, rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_EQUAL_FLOAT(1.0, rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(5.0, 990.0, rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(25.0, 500.0, rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(25.0, 500.0, rpn_stack_pop(ctxt).toFloat());
+
+    run_and_error_ctx(ctxt, "&low 2 quantile", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "1 &low merge", rpn_operator_error::InvalidType);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "1 sketch", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+}
+
 void test_nth() {
     rpn_context ctxt;
     TEST_ASSERT_TRUE(rpn_operator_set(ctxt, "nth", 2, [](rpn_context & ctxt) -> rpn_error {
@@ -460,6 +696,41 @@ void test_conditionals() {
     run_and_compare("4 end 1 2 3 ifn", rpn_values(2.0));
 }
 
+void test_conditional_blocks() {
+    run_and_compare("true if 1 else 2 then", rpn_values(1.0));
+    run_and_compare("false if 1 else 2 then", rpn_values(2.0));
+    run_and_compare("1 2 lt if 3 then 4", rpn_values(3.0, 4.0));
+    run_and_compare("1 2 gt if 3 then 4", rpn_values(4.0));
+    run_and_compare("true if false if 1 else 2 then else 3 then", rpn_values(2.0));
+    run_and_compare("false if true if 1 else 2 then else 3 then", rpn_values(3.0));
+    run_and_compare("false if 1 if 2 else 3 then 4 then 5", rpn_values(5.0));
+
+    run_and_error("if", rpn_operator_error::ArgumentCountMismatch);
+    run_and_error("true if 1", rpn_processing_error::UnbalancedBlock);
+    run_and_error("false if 1", rpn_processing_error::UnbalancedBlock);
+    run_and_error("1 else 2 then", rpn_processing_error::UnbalancedBlock);
+    run_and_error("1 then", rpn_processing_error::UnbalancedBlock);
+    run_and_error("true if 1 else 2 else 3 then", rpn_processing_error::UnbalancedBlock);
+
+    // untaken branch is never evaluated
+    static int calls = 0;
+
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+    TEST_ASSERT_TRUE(rpn_operator_set(ctxt, "expensive", 0, [](rpn_context & ctxt) -> rpn_error {
+        ++calls;
+        rpn_stack_push(ctxt, rpn_value(static_cast<rpn_float>(42.0)));
+        return 0;
+    }));
+
+    run_and_compare_ctx(ctxt, "false if expensive sqrt &var = else 1 then", rpn_values(1.0));
+    TEST_ASSERT_EQUAL(0, calls);
+    TEST_ASSERT_EQUAL(0, rpn_variables_size(ctxt));
+
+    run_and_compare_ctx(ctxt, "true if expensive else expensive then", rpn_values(42.0));
+    TEST_ASSERT_EQUAL(1, calls);
+}
+
 void test_stack() {
     run_and_compare("1 3 dup unrot swap - *", rpn_values(6.0));
     run_and_compare("1 2 3 rot", rpn_values(2.0, 3.0, 1.0));
@@ -679,6 +950,784 @@ void test_variable_cleanup() {
     TEST_ASSERT_TRUE(rpn_clear(ctxt));
 }
 
+void test_stream_operators() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    // first sample seeds the average, variable keeps the last result
+    run_and_compare_ctx(ctxt, "10 0.5 &avg ema", rpn_values(10.0));
+    run_and_compare_ctx(ctxt, "20 0.5 &avg ema", rpn_values(15.0));
+    TEST_ASSERT_EQUAL_FLOAT(15.0, rpn_variable_get(ctxt, "avg").toFloat());
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "20 1.5 &avg ema", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "20 0.5 1 ema", rpn_operator_error::InvalidType);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // population variance of 2 4 4 4 5 5 7 9 is 4
+    const char* samples[] { "2", "4", "4", "4", "5", "5", "7" };
+    for (auto* sample : samples) {
+        TEST_ASSERT_TRUE(rpn_process(ctxt, (String(sample) + " &stat welford").c_str()));
+        TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    }
+    run_and_compare_ctx(ctxt, "9 &stat welford", rpn_values(5.0, 4.0));
+    TEST_ASSERT_EQUAL_FLOAT(5.0, rpn_variable_get(ctxt, "stat").toFloat());
+    TEST_ASSERT_EQUAL(1, rpn_streams_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // window of 3 samples
+    const char* window[] { "5", "3", "4", "6", "7", "2" };
+    const rpn_float min[] { 5.0, 3.0, 3.0, 3.0, 4.0, 2.0 };
+    const rpn_float max[] { 5.0, 5.0, 5.0, 6.0, 7.0, 7.0 };
+    for (size_t index = 0; index < (sizeof(window) / sizeof(window[0])); ++index) {
+        String expression(window[index]);
+        expression += " 3 &low wmin ";
+        expression += window[index];
+        expression += " 3 &high wmax";
+        run_and_compare_ctx(ctxt, expression.c_str(), rpn_values(min[index], max[index]));
+    }
+    TEST_ASSERT_EQUAL(3, rpn_streams_size(ctxt));
+
+    // changing the window resets the state
+    run_and_compare_ctx(ctxt, "10 2 &low wmin", rpn_values(10.0));
+    run_and_error_ctx(ctxt, "10 0 &low wmin", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // state is removed together with the variable
+    TEST_ASSERT_TRUE(rpn_variable_del(ctxt, "high"));
+    TEST_ASSERT_TRUE(rpn_variable_del(ctxt, "stat"));
+    run_and_compare_ctx(ctxt, "1 3 &low wmin", rpn_values(1.0));
+    TEST_ASSERT_EQUAL(1, rpn_streams_size(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_clear(ctxt));
+    TEST_ASSERT_EQUAL(0, rpn_streams_size(ctxt));
+}
+
+void test_filters() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    const rpn_float average[] { 1.0 / 3.0, 1.0 / 3.0, 1.0 / 3.0 };
+    TEST_ASSERT_TRUE(rpn_filter_fir(ctxt, "avg", average, 3));
+
+    run_and_compare_ctx(ctxt, "3 \"avg\" filter", rpn_values(1.0));
+    run_and_compare_ctx(ctxt, "6 \"avg\" filter", rpn_values(3.0));
+    run_and_compare_ctx(ctxt, "9 \"avg\" filter 12 \"avg\" filter", rpn_values(6.0, 9.0));
+
+    // y = 0.5 * x + 0.5 * y[-1]
+    const rpn_float lowpass[] { 0.5, 0.0, 0.0, -0.5, 0.0 };
+    TEST_ASSERT_TRUE(rpn_filter_biquad(ctxt, "lowpass", lowpass, 1));
+    run_and_compare_ctx(ctxt, "1 \"lowpass\" filter 1 \"lowpass\" filter 1 \"lowpass\" filter", rpn_values(0.5, 0.75, 0.875));
+
+    TEST_ASSERT_TRUE(rpn_filter_reset(ctxt, "lowpass"));
+    run_and_compare_ctx(ctxt, "1 \"lowpass\" filter", rpn_values(0.5));
+
+    run_and_error_ctx(ctxt, "1 \"unknown\" filter", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "1 2 filter", rpn_operator_error::InvalidType);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // block processing produces the same result as feeding the samples one by one
+    const rpn_float taps[] { 0.1, 0.2, 0.3, 0.2, 0.1 };
+    TEST_ASSERT_TRUE(rpn_filter_fir(ctxt, "block", taps, 5));
+    TEST_ASSERT_TRUE(rpn_filter_fir(ctxt, "sample", taps, 5));
+
+    rpn_float samples[11];
+    for (size_t index = 0; index < 11; ++index) {
+        samples[index] = static_cast<rpn_float>((index * 7) % 5);
+    }
+
+    rpn_float block[11];
+    TEST_ASSERT_TRUE(rpn_filter_process(ctxt, "block", samples, block, 6));
+    TEST_ASSERT_TRUE(rpn_filter_process(ctxt, "block", samples + 6, block + 6, 5));
+
+    for (size_t index = 0; index < 11; ++index) {
+        rpn_float sample;
+        TEST_ASSERT_TRUE(rpn_filter_process(ctxt, "sample", &samples[index], &sample, 1));
+        TEST_ASSERT_EQUAL_FLOAT(sample, block[index]);
+    }
+
+    // output can replace the input, with the scratch buffer re-used from the previous calls
+    TEST_ASSERT_TRUE(rpn_filter_reset(ctxt, "block"));
+    rpn_float in_place[11];
+    std::copy(samples, samples + 11, in_place);
+    TEST_ASSERT_TRUE(rpn_filter_process(ctxt, "block", in_place, in_place, 11));
+    for (size_t index = 0; index < 11; ++index) {
+        TEST_ASSERT_EQUAL_FLOAT(block[index], in_place[index]);
+    }
+
+    // names longer than the inline string storage are found as well
+    TEST_ASSERT_TRUE(rpn_filter_fir(ctxt, "moving average of the last three", average, 3));
+    run_and_compare_ctx(ctxt, "3 \"moving average of the last three\" filter", rpn_values(1.0));
+    TEST_ASSERT_TRUE(rpn_filter_del(ctxt, "moving average of the last three"));
+
+    TEST_ASSERT_EQUAL(4, rpn_filters_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_filter_del(ctxt, "sample"));
+    TEST_ASSERT_FALSE(rpn_filter_process(ctxt, "sample", samples, block, 1));
+    TEST_ASSERT_EQUAL(3, rpn_filters_size(ctxt));
+}
+
+void test_tables() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    const rpn_float x[] { 0.0, 10.0, 20.0, 40.0 };
+    const rpn_float y[] { 100.0, 80.0, 70.0, 30.0 };
+
+    TEST_ASSERT_TRUE(rpn_table_set(ctxt, "copy", x, y, 4));
+    TEST_ASSERT_TRUE(rpn_table_set_ref(ctxt, "ref", x, y, 4));
+
+    run_and_compare_ctx(ctxt, "5 \"copy\" interp", rpn_values(90.0));
+    run_and_compare_ctx(ctxt, "10 \"copy\" interp 30 \"ref\" interp", rpn_values(80.0, 50.0));
+    run_and_compare_ctx(ctxt, "-5 \"ref\" interp 50 \"ref\" interp", rpn_values(100.0, 30.0));
+
+    rpn_float out;
+    TEST_ASSERT_TRUE(rpn_table_interp(ctxt, "copy", 15.0, out));
+    TEST_ASSERT_EQUAL_FLOAT(75.0, out);
+
+    // NaN is not clamped to either end of the table
+    TEST_ASSERT_TRUE(rpn_table_interp(ctxt, "copy", std::numeric_limits<rpn_float>::quiet_NaN(), out));
+    TEST_ASSERT_TRUE(std::isnan(out));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "nan \"ref\" interp"));
+    TEST_ASSERT_EQUAL(1, rpn_stack_size(ctxt));
+    TEST_ASSERT_TRUE(std::isnan(rpn_stack_pop(ctxt).toFloat()));
+
+    run_and_error_ctx(ctxt, "1 \"unknown\" interp", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    const rpn_float unsorted[] { 0.0, 20.0, 10.0 };
+    TEST_ASSERT_FALSE(rpn_table_set(ctxt, "unsorted", unsorted, y, 3));
+    TEST_ASSERT_FALSE(rpn_table_set(ctxt, "single", x, y, 1));
+
+    TEST_ASSERT_EQUAL(2, rpn_tables_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_table_del(ctxt, "ref"));
+    TEST_ASSERT_EQUAL(1, rpn_tables_size(ctxt));
+}
+
+void test_polynomials() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    // 2x^3 - x + 5
+    const rpn_float cubic[] { 2.0, 0.0, -1.0, 5.0 };
+    TEST_ASSERT_TRUE(rpn_polynomial_set(ctxt, "cubic", cubic, 4));
+
+    run_and_compare_ctx(ctxt, "2 \"cubic\" poly", rpn_values(19.0));
+    run_and_compare_ctx(ctxt, "0 \"cubic\" poly -1 \"cubic\" poly", rpn_values(5.0, 4.0));
+
+    rpn_float out;
+    TEST_ASSERT_TRUE(rpn_polynomial_eval(ctxt, "cubic", 3.0, out));
+    TEST_ASSERT_EQUAL_FLOAT(56.0, out);
+
+    // same polynomial, using the array of coefficients
+    run_and_compare_ctx(ctxt, "2 [ 2 0 -1 5 ] poly", rpn_values(19.0));
+    run_and_compare_ctx(ctxt, "100 3 [ 7 ] poly", rpn_values(100.0, 7.0));
+
+    run_and_error_ctx(ctxt, "2 \"unknown\" poly", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "2 [ ] poly", rpn_operator_error::InvalidArgument);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "2 [ 1 \"a\" ] poly", rpn_operator_error::InvalidType);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    TEST_ASSERT_EQUAL(1, rpn_polynomials_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_polynomial_del(ctxt, "cubic"));
+    TEST_ASSERT_EQUAL(0, rpn_polynomials_size(ctxt));
+}
+
+void test_batch() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    constexpr size_t Rows = 200;
+
+    rpn_float temp[Rows];
+    rpn_float hum[Rows];
+    for (size_t row = 0; row < Rows; ++row) {
+        temp[row] = static_cast<rpn_float>(row) - 50.0;
+        hum[row] = static_cast<rpn_float>(row % 10);
+    }
+
+    const rpn_batch_column columns[] {
+        {"temp", temp},
+        {"hum", hum}
+    };
+
+    rpn_float out[Rows];
+    rpn_error errors[Rows];
+
+    // every 10th row is divided by zero
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$temp 1.8 * 32 + $hum /", columns, 2, Rows, out, errors));
+    for (size_t row = 0; row < Rows; ++row) {
+        if (0.0 == hum[row]) {
+            TEST_ASSERT_TRUE(std::isnan(out[row]));
+            TEST_ASSERT_EQUAL(rpn_error_category::Value, errors[row].category);
+            TEST_ASSERT_EQUAL(static_cast<int>(rpn_value_error::DivideByZero), errors[row].code);
+            continue;
+        }
+        TEST_ASSERT_EQUAL(0, errors[row].code);
+        TEST_ASSERT_EQUAL_FLOAT(((temp[row] * 1.8) + 32.0) / hum[row], out[row]);
+    }
+
+    // user-defined word and the conditional block are called row by row, with the same results
+    TEST_ASSERT_TRUE(rpn_word_set(ctxt, "f", "1.8 * 32 +"));
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$temp f $hum /", columns, 2, Rows, out, errors));
+    TEST_ASSERT_EQUAL(static_cast<int>(rpn_value_error::DivideByZero), errors[0].code);
+    TEST_ASSERT_TRUE(std::isnan(out[0]));
+    TEST_ASSERT_EQUAL_FLOAT(((temp[1] * 1.8) + 32.0) / hum[1], out[1]);
+
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$temp 0 lt if 0 else $temp then", columns, 2, Rows, out));
+    TEST_ASSERT_EQUAL_FLOAT(0.0, out[10]);
+    TEST_ASSERT_EQUAL_FLOAT(100.0, out[150]);
+
+    // column variables are only bound while processing
+    TEST_ASSERT_EQUAL(0, rpn_variables_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "temp", rpn_value(static_cast<rpn_float>(1.0))));
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "offset", rpn_value(static_cast<rpn_float>(0.5))));
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$temp abs $offset + f", columns, 2, Rows, out, errors));
+    TEST_ASSERT_EQUAL_FLOAT((50.5 * 1.8) + 32.0, out[0]);
+    TEST_ASSERT_EQUAL(2, rpn_variables_size(ctxt));
+    TEST_ASSERT_EQUAL_FLOAT(1.0, rpn_variable_get(ctxt, "temp").toFloat());
+    TEST_ASSERT_EQUAL(0, rpn_stack_size(ctxt));
+
+    // custom operators can also provide the column kernel, which is called once per block of rows
+    TEST_ASSERT_TRUE(rpn_operator_set(ctxt, "sq", 1, [](void*, const rpn_operator_args& args, rpn_value& out) -> rpn_error {
+        rpn_value value(args[0]);
+        out = value * value;
+        return 0;
+    }));
+
+    static size_t blocks;
+    blocks = 0;
+    TEST_ASSERT_TRUE(rpn_operator_set_batch(ctxt, "sq", [](rpn_float* lhs, const rpn_float*, size_t size, rpn_value_error*) {
+        for (size_t index = 0; index < size; ++index) {
+            lhs[index] *= lhs[index];
+        }
+        ++blocks;
+    }));
+    TEST_ASSERT_FALSE(rpn_operator_set_batch(ctxt, "pi", nullptr));
+
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$hum sq 2 -", columns, 2, Rows, out));
+    TEST_ASSERT_EQUAL((Rows + RPNLIB_BATCH_BLOCK_SIZE - 1) / RPNLIB_BATCH_BLOCK_SIZE, blocks);
+    TEST_ASSERT_EQUAL_FLOAT(79.0, out[199]);
+
+    // comparison can only be the last operator, Boolean value is not a number for the next one
+    blocks = 0;
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$hum sq 20 gt", columns, 2, Rows, out));
+    TEST_ASSERT_EQUAL((Rows + RPNLIB_BATCH_BLOCK_SIZE - 1) / RPNLIB_BATCH_BLOCK_SIZE, blocks);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, out[4]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0, out[5]);
+
+    blocks = 0;
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$hum 4 gt sq", columns, 2, Rows, out));
+    TEST_ASSERT_EQUAL(0, blocks);
+
+    // same results as the row by row comparison, which is forced by the user-defined word
+    const rpn_float special[] {
+        0.0, -0.0, 1.0, 1.0 + std::numeric_limits<rpn_float>::epsilon(), 2.0, -7.5,
+        std::numeric_limits<rpn_float>::infinity(),
+        -std::numeric_limits<rpn_float>::infinity(),
+        std::numeric_limits<rpn_float>::quiet_NaN()
+    };
+
+    rpn_float lhs[Rows];
+    rpn_float rhs[Rows];
+    for (size_t row = 0; row < Rows; ++row) {
+        lhs[row] = special[row % 9];
+        rhs[row] = special[(row / 9) % 9];
+    }
+
+    const rpn_batch_column sides[] {
+        {"lhs", lhs},
+        {"rhs", rhs}
+    };
+
+    for (auto* op : {"eq", "ne", "gt", "ge", "lt", "le"}) {
+        TEST_ASSERT_TRUE(rpn_word_set(ctxt, "cmp_word", op));
+
+        String expression("$lhs $rhs ");
+        expression += op;
+
+        rpn_float expected[Rows];
+        TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$lhs $rhs cmp_word", sides, 2, Rows, expected, errors));
+        TEST_ASSERT_TRUE(rpn_process_batch(ctxt, expression.c_str(), sides, 2, Rows, out));
+        TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(out));
+        for (size_t row = 0; row < Rows; ++row) {
+            TEST_ASSERT_EQUAL(0, errors[row].code);
+        }
+    }
+
+    // errors are reported per row
+    TEST_ASSERT_TRUE(rpn_process_batch(ctxt, "$unknown 1 +", columns, 2, 3, out, errors));
+    for (size_t row = 0; row < 3; ++row) {
+        TEST_ASSERT_TRUE(std::isnan(out[row]));
+        TEST_ASSERT_EQUAL(rpn_error_category::Processing, errors[row].category);
+        TEST_ASSERT_EQUAL(static_cast<int>(rpn_processing_error::VariableDoesNotExist), errors[row].code);
+    }
+
+    TEST_ASSERT_FALSE(rpn_process_batch(ctxt, "$temp 0 gt if 1", columns, 2, Rows, out));
+    TEST_ASSERT_EQUAL(static_cast<int>(rpn_processing_error::UnbalancedBlock), ctxt.error.code);
+
+    const rpn_batch_column duplicate[] {
+        {"temp", temp},
+        {"temp", hum}
+    };
+    TEST_ASSERT_FALSE(rpn_process_batch(ctxt, "$temp", duplicate, 2, Rows, out));
+}
+
+void test_simd() {
+    constexpr size_t Size = 67;
+
+    const rpn_float special[] {
+        0.0, -0.0, 1.0, -1.0, 0.1, -7.5, 1e-310, -1e308, 3.0,
+        std::numeric_limits<rpn_float>::infinity(),
+        -std::numeric_limits<rpn_float>::infinity(),
+        std::numeric_limits<rpn_float>::quiet_NaN()
+    };
+
+    rpn_float lhs[Size];
+    rpn_float rhs[Size];
+    for (size_t index = 0; index < Size; ++index) {
+        lhs[index] = special[index % 12] * static_cast<rpn_float>(index + 1) / 3.0;
+        rhs[index] = special[(index * 7) % 12];
+    }
+
+    using kernel_type = void(*)(rpn_float*, const rpn_float*, size_t);
+    const kernel_type kernels[] {
+        rpn_simd_add, rpn_simd_sub, rpn_simd_mul, rpn_simd_div, rpn_simd_mod
+    };
+
+    const rpn_simd_isa default_isa = rpn_simd_current();
+
+    // every instruction set gives the same bits as the scalar loops
+    rpn_float expected[6][Size];
+    rpn_value_error expected_errors[Size];
+
+    TEST_ASSERT_TRUE(rpn_simd_select(rpn_simd_isa::Scalar));
+    for (size_t kernel = 0; kernel < 5; ++kernel) {
+        std::copy(std::begin(lhs), std::end(lhs), expected[kernel]);
+        kernels[kernel](expected[kernel], rhs, Size);
+    }
+    std::copy(std::begin(lhs), std::end(lhs), expected[5]);
+    rpn_simd_abs(expected[5], Size);
+    std::fill(std::begin(expected_errors), std::end(expected_errors), rpn_value_error::Ok);
+    expected_errors[0] = rpn_value_error::TypeMismatch;
+    rpn_simd_divisor(rhs, Size, expected_errors);
+
+    TEST_ASSERT_EQUAL(rpn_value_error::TypeMismatch, expected_errors[0]);
+    TEST_ASSERT_EQUAL(rpn_value_error::Ok, expected_errors[1]);
+    TEST_ASSERT_EQUAL(rpn_value_error::IEEE754, expected_errors[3]);
+    TEST_ASSERT_EQUAL(rpn_value_error::IEEE754, expected_errors[5]);
+    TEST_ASSERT_EQUAL(rpn_value_error::DivideByZero, expected_errors[12]);
+
+    for (auto isa : {rpn_simd_isa::SSE2, rpn_simd_isa::AVX2}) {
+        if (!rpn_simd_select(isa)) {
+            continue;
+        }
+        TEST_ASSERT_EQUAL(isa, rpn_simd_current());
+
+        rpn_float out[Size];
+        for (size_t kernel = 0; kernel < 5; ++kernel) {
+            std::copy(std::begin(lhs), std::end(lhs), out);
+            kernels[kernel](out, rhs, Size);
+            TEST_ASSERT_EQUAL_MEMORY(expected[kernel], out, sizeof(out));
+        }
+
+        std::copy(std::begin(lhs), std::end(lhs), out);
+        rpn_simd_abs(out, Size);
+        TEST_ASSERT_EQUAL_MEMORY(expected[5], out, sizeof(out));
+
+        rpn_value_error errors[Size];
+        std::fill(std::begin(errors), std::end(errors), rpn_value_error::Ok);
+        errors[0] = rpn_value_error::TypeMismatch;
+        rpn_simd_divisor(rhs, Size, errors);
+        TEST_ASSERT_EQUAL_MEMORY(expected_errors, errors, sizeof(errors));
+    }
+
+    // comparisons and reductions
+    const rpn_simd_comparison comparisons[] {
+        rpn_simd_comparison::Eq, rpn_simd_comparison::Ne,
+        rpn_simd_comparison::Gt, rpn_simd_comparison::Ge,
+        rpn_simd_comparison::Lt, rpn_simd_comparison::Le
+    };
+
+    // NaN is never passed to min and max, the array operators check it beforehand
+    rpn_float numbers[Size];
+    rpn_int integers[Size];
+    rpn_uint unsigned_integers[Size];
+    for (size_t index = 0; index < Size; ++index) {
+        numbers[index] = std::isnan(lhs[index]) ? 5.0 : lhs[index];
+        integers[index] = static_cast<rpn_int>((index * 2654435761u) % 1000) - 500;
+        unsigned_integers[index] = static_cast<rpn_uint>(index * 2654435761u);
+    }
+    integers[40] = std::numeric_limits<rpn_int>::max();
+    integers[41] = std::numeric_limits<rpn_int>::max();
+    integers[42] = std::numeric_limits<rpn_int>::min();
+    unsigned_integers[50] = std::numeric_limits<rpn_uint>::max();
+
+    rpn_float zeros[Size];
+    std::fill(std::begin(zeros), std::end(zeros), 1.0);
+    zeros[20] = -0.0;
+    zeros[30] = 0.0;
+    zeros[40] = -0.0;
+
+    struct reductions {
+        rpn_float compared[6][Size];
+        rpn_float acc[4];
+        rpn_float min;
+        rpn_float max;
+        rpn_float zeros_min;
+        rpn_float zeros_max;
+        rpn_int integer_min;
+        rpn_int integer_max;
+        rpn_int integer_sum;
+        rpn_uint unsigned_min;
+        rpn_uint unsigned_max;
+        rpn_uint unsigned_sum;
+    };
+
+    auto reduce = [&](reductions& out) {
+        for (size_t comparison = 0; comparison < 6; ++comparison) {
+            std::copy(std::begin(lhs), std::end(lhs), out.compared[comparison]);
+            rpn_simd_compare(out.compared[comparison], rhs, Size, comparisons[comparison]);
+        }
+
+        std::fill(std::begin(out.acc), std::end(out.acc), 0.5);
+        rpn_simd_accumulate(numbers, Size - 3, out.acc);
+
+        out.min = rpn_simd_min(numbers, Size);
+        out.max = rpn_simd_max(numbers, Size);
+        out.zeros_min = rpn_simd_min(zeros, Size);
+        out.zeros_max = rpn_simd_max(zeros + 21, Size - 21);
+
+        out.integer_min = rpn_simd_min(integers, Size);
+        out.integer_max = rpn_simd_max(integers, Size);
+        out.integer_sum = rpn_simd_sum(integers, Size);
+        out.unsigned_min = rpn_simd_min(unsigned_integers, Size);
+        out.unsigned_max = rpn_simd_max(unsigned_integers, Size);
+        out.unsigned_sum = rpn_simd_sum(unsigned_integers, Size);
+    };
+
+    TEST_ASSERT_TRUE(rpn_simd_select(rpn_simd_isa::Scalar));
+
+    reductions expected_reductions;
+    reduce(expected_reductions);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.0, expected_reductions.compared[0][0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, expected_reductions.compared[0][9]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0, expected_reductions.compared[1][11]);
+    TEST_ASSERT_TRUE(std::signbit(expected_reductions.zeros_min));
+    TEST_ASSERT_FALSE(std::signbit(expected_reductions.zeros_max));
+    TEST_ASSERT_EQUAL(std::numeric_limits<rpn_int>::min(), expected_reductions.integer_min);
+    TEST_ASSERT_EQUAL(std::numeric_limits<rpn_int>::max(), expected_reductions.integer_max);
+    TEST_ASSERT_EQUAL(std::numeric_limits<rpn_uint>::max(), expected_reductions.unsigned_max);
+
+    for (auto isa : {rpn_simd_isa::SSE2, rpn_simd_isa::AVX2}) {
+        if (!rpn_simd_select(isa)) {
+            continue;
+        }
+
+        reductions out;
+        reduce(out);
+
+        TEST_ASSERT_EQUAL_MEMORY(expected_reductions.compared, out.compared, sizeof(out.compared));
+        TEST_ASSERT_EQUAL_MEMORY(expected_reductions.acc, out.acc, sizeof(out.acc));
+        TEST_ASSERT_EQUAL_MEMORY(&expected_reductions.min, &out.min, sizeof(out.min));
+        TEST_ASSERT_EQUAL_MEMORY(&expected_reductions.max, &out.max, sizeof(out.max));
+        TEST_ASSERT_EQUAL_MEMORY(&expected_reductions.zeros_min, &out.zeros_min, sizeof(out.zeros_min));
+        TEST_ASSERT_EQUAL_MEMORY(&expected_reductions.zeros_max, &out.zeros_max, sizeof(out.zeros_max));
+        TEST_ASSERT_TRUE(expected_reductions.integer_min == out.integer_min);
+        TEST_ASSERT_TRUE(expected_reductions.integer_max == out.integer_max);
+        TEST_ASSERT_TRUE(expected_reductions.integer_sum == out.integer_sum);
+        TEST_ASSERT_TRUE(expected_reductions.unsigned_min == out.unsigned_min);
+        TEST_ASSERT_TRUE(expected_reductions.unsigned_max == out.unsigned_max);
+        TEST_ASSERT_TRUE(expected_reductions.unsigned_sum == out.unsigned_sum);
+
+        // array operators pick the same member as the plain loop
+        rpn_context ctxt;
+        TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+        rpn_value result;
+        for (auto* op : {"min", "max", "sum"}) {
+            rpn_int expected { ('u' == op[1]) ? 0 : integers[0] };
+            for (size_t index = 0; index < 40; ++index) {
+                TEST_ASSERT_TRUE(rpn_stack_push(ctxt, rpn_value(integers[index])));
+                if ('u' == op[1]) {
+                    expected += integers[index];
+                } else if (('i' == op[1]) ? (integers[index] < expected) : (integers[index] > expected)) {
+                    expected = integers[index];
+                }
+            }
+
+            String array("40 ");
+            array += op;
+
+            TEST_ASSERT_TRUE(rpn_process(ctxt, array.c_str()));
+            TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, result));
+            TEST_ASSERT_TRUE(result.isInt());
+            TEST_ASSERT_TRUE(expected == result.toInt());
+        }
+    }
+
+    TEST_ASSERT_TRUE(rpn_simd_select(default_isa));
+}
+
+void test_parent() {
+    rpn_context shared;
+    TEST_ASSERT_TRUE(rpn_init(shared));
+    TEST_ASSERT_TRUE(rpn_variable_set(shared, "limit", rpn_value(static_cast<rpn_float>(100.0))));
+    TEST_ASSERT_TRUE(rpn_word_set(shared, "f", "1.8 * 32 +"));
+
+    const rpn_float x[] { 0.0, 10.0 };
+    const rpn_float y[] { 0.0, 100.0 };
+    TEST_ASSERT_TRUE(rpn_table_set(shared, "percent", x, y, 2));
+
+    // words, operators, variables and tables are not copied
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_parent(ctxt, &shared));
+    TEST_ASSERT_FALSE(rpn_parent(shared, &ctxt));
+
+    run_and_compare_ctx(ctxt, "100 f $limit gt", rpn_values(true));
+    run_and_compare_ctx(ctxt, "5 \"percent\" interp", rpn_values(50.0));
+
+    // variables of the context are found first, parent variables are never modified
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "limit", rpn_value(static_cast<rpn_float>(500.0))));
+    run_and_compare_ctx(ctxt, "100 f $limit gt", rpn_values(false));
+    TEST_ASSERT_TRUE(rpn_variable_del(ctxt, "limit"));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1 &limit ="));
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    TEST_ASSERT_EQUAL_FLOAT(1.0, rpn_variable_get(ctxt, "limit").toFloat());
+    TEST_ASSERT_EQUAL_FLOAT(100.0, rpn_variable_get(shared, "limit").toFloat());
+    TEST_ASSERT_TRUE(ctxt.operators.empty());
+
+    TEST_ASSERT_TRUE(rpn_parent(ctxt, nullptr));
+    run_and_error_ctx(ctxt, "1 f", rpn_processing_error::UnknownOperator);
+}
+
+#if RPNLIB_ENGINE
+
+void test_engine() {
+    rpn_context shared;
+    TEST_ASSERT_TRUE(rpn_init(shared));
+    TEST_ASSERT_TRUE(rpn_variable_set(shared, "limit", rpn_value(static_cast<rpn_float>(100.0))));
+    TEST_ASSERT_TRUE(rpn_word_set(shared, "rule", "$temp 1.8 * 32 + dup $limit gt if 1 + then"));
+
+    rpn_engine engine;
+    TEST_ASSERT_FALSE(rpn_engine_run(engine, nullptr, 0));
+    TEST_ASSERT_TRUE(rpn_engine_start(engine, shared, 4));
+    TEST_ASSERT_EQUAL(4, rpn_engine_threads(engine));
+
+    constexpr size_t Size = 1000;
+    std::vector<rpn_engine_job> jobs(Size);
+    for (size_t index = 0; index < Size; ++index) {
+        jobs[index].expression = "rule";
+        jobs[index].variables.emplace_back("temp", static_cast<rpn_float>(index));
+    }
+    jobs[7].variables.clear();
+
+    // same jobs can be re-used for the next run
+    for (int run = 0; run < 3; ++run) {
+        TEST_ASSERT_TRUE(rpn_engine_run(engine, jobs.data(), jobs.size()));
+        for (size_t index = 0; index < Size; ++index) {
+            if (7 == index) {
+                TEST_ASSERT_EQUAL(static_cast<int>(rpn_processing_error::VariableDoesNotExist), jobs[index].error.code);
+                continue;
+            }
+
+            TEST_ASSERT_EQUAL(0, jobs[index].error.code);
+            rpn_float expected = (static_cast<rpn_float>(index) * 1.8) + 32.0;
+            if (expected > 100.0) {
+                expected += 1.0;
+            }
+            TEST_ASSERT_EQUAL_FLOAT(expected, jobs[index].result.toFloat());
+        }
+    }
+
+    TEST_ASSERT_TRUE(rpn_engine_stop(engine));
+    TEST_ASSERT_FALSE(rpn_engine_stop(engine));
+    TEST_ASSERT_EQUAL(0, rpn_engine_threads(engine));
+}
+
+#endif
+
+void test_process_const() {
+    rpn_context shared;
+    TEST_ASSERT_TRUE(rpn_init(shared));
+    TEST_ASSERT_TRUE(rpn_variable_set(shared, "offset", rpn_value(static_cast<rpn_float>(0.5))));
+    TEST_ASSERT_TRUE(rpn_word_set(shared, "twice", "2 *"));
+
+    const rpn_context& ctxt = shared;
+
+    // results and errors are only placed in the scratch context
+    rpn_context scratch;
+    TEST_ASSERT_TRUE(rpn_process(ctxt, scratch, "3 twice $offset + 1 &tmp ="));
+    TEST_ASSERT_EQUAL(2, rpn_stack_size(scratch));
+    TEST_ASSERT_EQUAL(0, rpn_stack_size(shared));
+    TEST_ASSERT_EQUAL(1, rpn_variables_size(shared));
+    TEST_ASSERT_EQUAL(1, rpn_variables_size(scratch));
+    TEST_ASSERT(scratch.parent == nullptr);
+
+    rpn_value value;
+    TEST_ASSERT_TRUE(rpn_stack_clear(scratch));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, scratch, "3 twice $offset +"));
+    TEST_ASSERT_TRUE(rpn_stack_pop(scratch, value));
+    TEST_ASSERT_EQUAL_FLOAT(6.5, value.toFloat());
+
+    TEST_ASSERT_FALSE(rpn_process(ctxt, scratch, "1 0i /"));
+    TEST_ASSERT_EQUAL(static_cast<int>(rpn_value_error::DivideByZero), scratch.error.code);
+    TEST_ASSERT_EQUAL(0, shared.error.code);
+
+    TEST_ASSERT_FALSE(rpn_process(ctxt, shared, "1"));
+
+#if RPNLIB_ENGINE
+    // concurrent readers of the same context
+    std::vector<std::thread> threads;
+    std::vector<rpn_float> results(4);
+    for (size_t index = 0; index < results.size(); ++index) {
+        threads.emplace_back([&ctxt, &results, index]() {
+            rpn_context scratch;
+            rpn_float sum = 0.0;
+            for (int step = 0; step < 1000; ++step) {
+                rpn_value value;
+                if (rpn_process(ctxt, scratch, "1 twice $offset +") && rpn_stack_pop(scratch, value)) {
+                    sum += value.toFloat();
+                }
+            }
+            results[index] = sum;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto result : results) {
+        TEST_ASSERT_EQUAL_FLOAT(2500.0, result);
+    }
+#endif
+}
+
+void test_variable_store() {
+    rpn_variable_store store;
+
+    rpn_context first;
+    rpn_context second;
+    TEST_ASSERT_TRUE(rpn_init(first));
+    TEST_ASSERT_TRUE(rpn_init(second));
+    TEST_ASSERT_TRUE(rpn_variable_store_attach(first, store));
+    TEST_ASSERT_TRUE(rpn_variable_store_attach(second, store));
+    TEST_ASSERT_FALSE(rpn_variable_store_attach(first, store));
+
+    // single update is visible in every context
+    TEST_ASSERT_TRUE(rpn_variable_store_set(store, "temp", rpn_value(static_cast<rpn_float>(21.5))));
+    run_and_compare_ctx(first, "$temp 1 +", rpn_values(22.5));
+    run_and_compare_ctx(second, "$temp", rpn_values(21.5));
+
+    TEST_ASSERT_TRUE(rpn_variable_store_set(store, "temp", rpn_value(static_cast<rpn_float>(23.0))));
+    run_and_compare_ctx(second, "$temp", rpn_values(23.0));
+    TEST_ASSERT_EQUAL(1, rpn_variable_store_size(store));
+    TEST_ASSERT_EQUAL(0, rpn_variables_size(first));
+
+    // own variables are found first
+    TEST_ASSERT_TRUE(rpn_variable_set(first, "temp", rpn_value(static_cast<rpn_float>(0.0))));
+    run_and_compare_ctx(first, "$temp", rpn_values(0.0));
+    TEST_ASSERT_TRUE(rpn_variable_del(first, "temp"));
+
+    // old snapshot is kept while someone could still be reading it
+    second.store->epoch = store.epoch.load();
+    TEST_ASSERT_TRUE(rpn_variable_store_set(store, "hum", rpn_value(static_cast<rpn_float>(40.0))));
+    TEST_ASSERT_EQUAL(1, rpn_variable_store_retired(store));
+    second.store->epoch = 0;
+    TEST_ASSERT_TRUE(rpn_variable_store_del(store, "hum"));
+    TEST_ASSERT_EQUAL(0, rpn_variable_store_retired(store));
+    TEST_ASSERT_FALSE(rpn_variable_store_del(store, "hum"));
+
+    // epoch wraps around to 1, since 0 means that the slot is not reading
+    store.epoch = std::numeric_limits<uint32_t>::max();
+    TEST_ASSERT_TRUE(rpn_variable_store_set(store, "temp", rpn_value(static_cast<rpn_float>(24.0))));
+    TEST_ASSERT_EQUAL(1, store.epoch.load());
+    run_and_compare_ctx(second, "$temp", rpn_values(24.0));
+    TEST_ASSERT_EQUAL(0, rpn_variable_store_retired(store));
+
+    TEST_ASSERT_TRUE(rpn_variable_store_detach(second));
+    run_and_error_ctx(second, "$temp", rpn_processing_error::VariableDoesNotExist);
+
+#if RPNLIB_ENGINE
+    // readers only ever see the published values, and they never go back
+    std::atomic<bool> running { true };
+    std::thread writer([&]() {
+        for (int value = 0; value < 2000; ++value) {
+            rpn_variable_store_set(store, "temp", rpn_value(static_cast<rpn_float>(value)));
+        }
+        running = false;
+    });
+
+    rpn_float last = -1.0;
+    bool ordered = true;
+    while (running) {
+        rpn_value value;
+        if (rpn_process(first, "$temp") && rpn_stack_pop(first, value)) {
+            ordered = ordered && (value.toFloat() >= last);
+            last = value.toFloat();
+        }
+    }
+    writer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+
+    // last snapshot may still be retired, when the reader was in the middle of the expression
+    TEST_ASSERT_TRUE(rpn_variable_store_set(store, "temp", rpn_value(static_cast<rpn_float>(0.0))));
+    TEST_ASSERT_EQUAL(0, rpn_variable_store_retired(store));
+#endif
+
+    TEST_ASSERT_TRUE(rpn_variable_store_detach(first));
+}
+
+void test_value_ptr() {
+    rpn_value_ptr empty;
+    TEST_ASSERT_FALSE(static_cast<bool>(empty));
+    TEST_ASSERT_EQUAL(0, empty.use_count());
+
+    auto ptr = rpn_make_value(rpn_int(12345));
+    TEST_ASSERT_TRUE(static_cast<bool>(ptr));
+    TEST_ASSERT_EQUAL(1, ptr.use_count());
+    TEST_ASSERT_EQUAL(12345, ptr->toInt());
+
+    rpn_value_weak_ptr weak(ptr);
+    TEST_ASSERT_FALSE(weak.expired());
+
+    {
+        auto copy = ptr;
+        TEST_ASSERT_EQUAL(2, ptr.use_count());
+        TEST_ASSERT_TRUE(copy == ptr);
+
+        auto moved = std::move(copy);
+        TEST_ASSERT_FALSE(static_cast<bool>(copy));
+        TEST_ASSERT_EQUAL(2, moved.use_count());
+    }
+
+    TEST_ASSERT_EQUAL(1, ptr.use_count());
+    TEST_ASSERT_FALSE(ptr.owner_before(weak) || weak.owner_before(ptr));
+
+    ptr.reset();
+    TEST_ASSERT_TRUE(weak.expired());
+
+    // references on the stack keep the value alive after the variable is gone
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "value", rpn_value(5.0)));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "&value &value"));
+    TEST_ASSERT_TRUE(rpn_variable_del(ctxt, "value"));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "+"));
+
+    rpn_value result;
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, result));
+    TEST_ASSERT_EQUAL_FLOAT(10.0, result.toFloat());
+
+    TEST_ASSERT_TRUE(rpn_clear(ctxt));
+}
+
 void test_custom_operator() {
 
     rpn_context ctxt;
@@ -696,6 +1745,178 @@ void test_custom_operator() {
 
 }
 
+void test_custom_operator_args() {
+
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    static int offset = 5;
+
+    TEST_ASSERT_TRUE(rpn_operator_set(ctxt, "offset", 2,
+        [](void* data, const rpn_operator_args& args, rpn_value& out) -> rpn_error {
+            TEST_ASSERT_EQUAL(2, args.size());
+            if (!args[0].isNumber() || !args[1].isNumber()) {
+                return rpn_operator_error::InvalidType;
+            }
+            out = rpn_value(args[0].toFloat() - args[1].toFloat()
+                + static_cast<rpn_float>(*reinterpret_cast<int*>(data)));
+            return 0;
+        }, &offset));
+
+    run_and_compare_ctx(ctxt, "1 10 2 offset", rpn_values(1.0, 13.0));
+    run_and_error_ctx(ctxt, "\"a\" 2 offset", rpn_operator_error::InvalidType);
+    TEST_ASSERT_EQUAL(2, rpn_stack_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "1 offset", rpn_operator_error::ArgumentCountMismatch);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // result never overwrites the referenced variable value
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "var", rpn_value { 2.0 }));
+    run_and_compare_ctx(ctxt, "&var 1 offset", rpn_values(6.0));
+    TEST_ASSERT_EQUAL_FLOAT(2.0, rpn_variable_get(ctxt, "var").toFloat());
+
+    // value errors are returned instead of being placed on the stack
+    TEST_ASSERT_TRUE(rpn_operator_set(ctxt, "broken", 0,
+        [](void*, const rpn_operator_args&, rpn_value& out) -> rpn_error {
+            out = rpn_value(rpn_value_error::DivideByZero);
+            return 0;
+        }));
+    run_and_error_ctx(ctxt, "broken", rpn_value_error::DivideByZero);
+
+    TEST_ASSERT_TRUE(rpn_operator_set(ctxt, "answer", 0,
+        [](void*, const rpn_operator_args& args, rpn_value& out) -> rpn_error {
+            TEST_ASSERT_EQUAL(0, args.size());
+            out = rpn_value(static_cast<rpn_int>(42));
+            return 0;
+        }));
+    run_and_compare_ctx(ctxt, "answer", rpn_values<rpn_int>(42));
+
+}
+
+void test_pure_operator() {
+
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    static int calls = 0;
+
+    TEST_ASSERT_TRUE(rpn_operator_set_pure(ctxt, "square", 1,
+        [](void* data, const rpn_operator_args& args, rpn_value& out) -> rpn_error {
+            ++(*reinterpret_cast<int*>(data));
+            if (args[0].isString()) {
+                return rpn_operator_error::InvalidType;
+            }
+            out = rpn_value(args[0].toFloat() * args[0].toFloat());
+            return 0;
+        }, &calls, 2));
+
+    size_t hits = 0;
+    size_t misses = 0;
+
+    run_and_compare_ctx(ctxt, "2 square 2 square 3 square", rpn_values(4.0, 4.0, 9.0));
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_TRUE(rpn_operator_memo_stats(ctxt, "square", hits, misses));
+    TEST_ASSERT_EQUAL(1, hits);
+    TEST_ASSERT_EQUAL(2, misses);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // arguments of a different type are not the same key
+    run_and_compare_ctx(ctxt, "2i square", rpn_values(4.0));
+    TEST_ASSERT_EQUAL(3, calls);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // least recently used entry (2.0) was evicted, while 3.0 is still there
+    run_and_compare_ctx(ctxt, "3 square 2 square", rpn_values(9.0, 4.0));
+    TEST_ASSERT_EQUAL(4, calls);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // errors are not cached
+    run_and_error_ctx(ctxt, "\"s\" square", rpn_operator_error::InvalidType);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+    run_and_error_ctx(ctxt, "\"s\" square", rpn_operator_error::InvalidType);
+    TEST_ASSERT_EQUAL(6, calls);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_operator_memo_clear(ctxt, "square"));
+    TEST_ASSERT_TRUE(rpn_operator_memo_stats(ctxt, "square", hits, misses));
+    TEST_ASSERT_EQUAL(0, hits);
+    TEST_ASSERT_EQUAL(0, misses);
+
+    TEST_ASSERT_FALSE(rpn_operator_memo_stats(ctxt, "+", hits, misses));
+
+    // floats within the operator== epsilon are still different keys
+    calls = 0;
+    TEST_ASSERT_TRUE(rpn_stack_push(ctxt, rpn_value(static_cast<rpn_float>(1e-20))));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "square"));
+    TEST_ASSERT_TRUE(rpn_stack_push(ctxt, rpn_value(static_cast<rpn_float>(3e-20))));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "square"));
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_stack_push(ctxt, rpn_value(static_cast<rpn_float>(0.0))));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "square"));
+    TEST_ASSERT_TRUE(rpn_stack_push(ctxt, rpn_value(static_cast<rpn_float>(-0.0))));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "square"));
+    TEST_ASSERT_EQUAL(4, calls);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    // copy of the operator does not share the memo
+    rpn_operator copy(ctxt.operators.front());
+    TEST_ASSERT_TRUE(copy.memo != nullptr);
+    TEST_ASSERT_TRUE(copy.memo.get() != ctxt.operators.front().memo.get());
+    TEST_ASSERT_EQUAL(0, copy.memo->entries.size());
+    TEST_ASSERT_EQUAL(ctxt.operators.front().memo->capacity, copy.memo->capacity);
+
+}
+
+void test_words() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    // definition itself does not change the stack
+    run_and_compare_ctx(ctxt, ": calib 0.98 * 1.5 + ;", rpn_values());
+    TEST_ASSERT_EQUAL(1, rpn_words_size(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "raw", rpn_value { 100.0 }));
+    run_and_compare_ctx(ctxt, "$raw calib", rpn_values(99.5));
+    run_and_compare_ctx(ctxt, "10 calib calib", rpn_values(12.574));
+
+    // words can use other words, conditional blocks, variables and nested stacks
+    run_and_compare_ctx(ctxt, ": clamp dup 0 lt if drop 0 then ; -5 clamp 5 clamp", rpn_values(0.0, 5.0));
+    run_and_compare_ctx(ctxt, ": store calib &stored = ; 10 store drop $stored", rpn_values(11.3));
+    run_and_compare_ctx(ctxt, ": pick3 [ 10 20 30 ] index ; 1 pick3", rpn_values(20.0));
+
+    // redefinition replaces the existing word
+    run_and_compare_ctx(ctxt, ": calib 2 * ; 10 calib", rpn_values(20.0));
+    TEST_ASSERT_TRUE(rpn_word_set(ctxt, "calib", "3 *"));
+    run_and_compare_ctx(ctxt, "10 calib", rpn_values(30.0));
+
+    // words shadow operators
+    TEST_ASSERT_TRUE(rpn_word_set(ctxt, "abs", "drop 42"));
+    run_and_compare_ctx(ctxt, "-1 abs", rpn_values(42.0));
+    TEST_ASSERT_TRUE(rpn_word_del(ctxt, "abs"));
+    TEST_ASSERT_FALSE(rpn_word_del(ctxt, "abs"));
+    run_and_compare_ctx(ctxt, "-1 abs", rpn_values(1.0));
+
+    TEST_ASSERT_FALSE(rpn_word_set(ctxt, "if", "1"));
+    TEST_ASSERT_FALSE(rpn_word_set(ctxt, "two words", "1"));
+    TEST_ASSERT_FALSE(rpn_word_set(ctxt, "broken", "1 if 2"));
+    TEST_ASSERT_FALSE(rpn_word_set(ctxt, "broken", "1 ; 2"));
+
+    run_and_error_ctx(ctxt, ": broken 1", rpn_processing_error::InvalidDefinition);
+    run_and_error_ctx(ctxt, ": 1 2 ;", rpn_processing_error::InvalidDefinition);
+    run_and_error_ctx(ctxt, ": then 2 ;", rpn_processing_error::InvalidDefinition);
+    run_and_error_ctx(ctxt, ": outer : inner 1 ; ;", rpn_processing_error::InvalidDefinition);
+    run_and_error_ctx(ctxt, "1 2 ;", rpn_processing_error::InvalidDefinition);
+    run_and_error_ctx(ctxt, ": broken if 1 ;", rpn_processing_error::UnbalancedBlock);
+    run_and_error_ctx(ctxt, ": forever forever ; forever", rpn_processing_error::WordDepthExceeded);
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_words_clear(ctxt));
+    TEST_ASSERT_EQUAL(0, rpn_words_size(ctxt));
+    run_and_error_ctx(ctxt, "1 calib", rpn_processing_error::UnknownOperator);
+}
+
 void test_error_divide_by_zero() {
     run_and_error("5 0 /", rpn_value_error::DivideByZero);
     run_and_error("0 0 /", rpn_value_error::DivideByZero);
@@ -706,6 +1927,9 @@ void test_error_divide_by_zero() {
 
     run_and_error("56789u 0u /", rpn_value_error::DivideByZero);
     run_and_error("19283u 0u mod", rpn_value_error::DivideByZero);
+
+    run_and_error("1.5q 0q /", rpn_value_error::DivideByZero);
+    run_and_error("1.5q 0.0000000001 mod", rpn_value_error::DivideByZero);
 }
 
 void test_error_argument_count_mismatch() {
@@ -870,6 +2094,95 @@ void test_parse_integer() {
     run_and_compare("1i 2i 3i 4i 5i + + + +", rpn_values<rpn_int>(15));
 }
 
+rpn_fixed fixed(rpn_float value) {
+    return rpn_value(value).toFixed();
+}
+
+void test_fixed_point() {
+    run_and_compare("1.5q 2.25q + 1.5q 2.25q -", rpn_values(fixed(3.75), fixed(-0.75)));
+    run_and_compare("1.5q -2q * 5.5q 2q mod -5.5q 2q mod", rpn_values(fixed(-3.0), fixed(1.5), fixed(0.5)));
+    run_and_compare("1q 3q /", rpn_values(rpn_fixed::fromRaw(rpn_fixed::One / 3)));
+
+    run_and_compare("-1.5q floor -1.5q ceil -1.5q abs", rpn_values(fixed(-2.0), fixed(-1.0), fixed(1.5)));
+    run_and_compare("2.675q 2 round 2.5q 0 round", rpn_values(fixed(2.68), fixed(3.0)));
+
+    // left-hand side type is preserved, same as with the other numbers
+    run_and_compare("1.5q 2 + 2i 1.5q +", (rpn_values<rpn_fixed, rpn_int>(fixed(3.5), 4)));
+    run_and_compare("1.5q 1.5 eq 1.5q 2q lt", rpn_values(true, true));
+
+    // out of range results saturate
+    run_and_compare("32767q 1q +", rpn_values(rpn_fixed::fromRaw(rpn_fixed::Max)));
+    run_and_error("32769q", rpn_processing_error::TokenNotHandled);
+    run_and_error("1.5eq", rpn_processing_error::UnknownOperator);
+
+    TEST_ASSERT_EQUAL_STRING("-0.5", rpn_value(fixed(-0.5)).toString().c_str());
+    TEST_ASSERT_EQUAL_STRING("3.0", rpn_value(fixed(3.0)).toString().c_str());
+    TEST_ASSERT_EQUAL_STRING("0.33333", rpn_value(rpn_fixed::fromRaw(21845)).toString().c_str());
+
+    // interpolated quarter-wave table is within 2 LSB of the exact result
+    for (int step = -400; step <= 400; ++step) {
+        rpn_float angle = step * 0.0173;
+        auto value = fixed(angle);
+        TEST_ASSERT_INT_WITHIN(2, rpn_value(std::sin(rpn_value(value).toFloat())).toFixed().raw, value.sin().raw);
+        TEST_ASSERT_INT_WITHIN(2, rpn_value(std::cos(rpn_value(value).toFloat())).toFixed().raw, value.cos().raw);
+    }
+
+    TEST_ASSERT_EQUAL(92681, fixed(2.0).sqrt().raw);
+
+#ifdef RPNLIB_ADVANCED_MATH
+    run_and_compare("16q sqrt 0q cos 0q sin", rpn_values(fixed(4.0), fixed(1.0), fixed(0.0)));
+    run_and_error("-1q sqrt", rpn_operator_error::InvalidArgument);
+#endif
+}
+
+void test_single_precision() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+    TEST_ASSERT_TRUE(rpn_precision(ctxt, rpn_float_precision::Single));
+
+    const rpn_float third = 1.0f / 3.0f;
+    const rpn_float sum = 0.1f + 0.2f;
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1 3 / 0.1 0.2 + 1 3i /"));
+    TEST_ASSERT_TRUE(third == rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_TRUE(sum == rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_TRUE(third == rpn_stack_pop(ctxt).toFloat());
+
+    // literals are rounded when compiled into the word as well
+    TEST_ASSERT_TRUE(rpn_process(ctxt, ": tenth 0.1 ; tenth"));
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(0.1f) == rpn_stack_pop(ctxt).toFloat());
+
+    run_and_error_ctx(ctxt, "1 0 /", rpn_value_error::DivideByZero);
+    run_and_error_ctx(ctxt, "1 0i mod", rpn_value_error::DivideByZero);
+    run_and_compare_ctx(ctxt, "5.5 2 mod 2i 1.5 +", (rpn_values<rpn_float, rpn_int>(1.5, 4)));
+
+    // results of every other operator are rounded as well
+    rpn_context reference;
+    TEST_ASSERT_TRUE(rpn_init(reference));
+    TEST_ASSERT_TRUE(rpn_process(reference, "2 sqrt 1 exp"));
+    const rpn_float exp = rpn_stack_pop(reference).toFloat();
+    const rpn_float sqrt = rpn_stack_pop(reference).toFloat();
+    TEST_ASSERT_TRUE(rpn_clear(reference));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "2 sqrt 1 exp [ 0.1 0.2 0.3 ] avg"));
+    const rpn_float avg = (static_cast<rpn_float>(0.1f) + static_cast<rpn_float>(0.2f) + static_cast<rpn_float>(0.3f)) / 3.0;
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(static_cast<float>(avg)) == rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(static_cast<float>(exp)) == rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(static_cast<float>(sqrt)) == rpn_stack_pop(ctxt).toFloat());
+    run_and_compare_ctx(ctxt, "0.1 0.2 + 0.3 eq", rpn_values(true));
+
+    // while the values set from the outside are not
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "tenth", rpn_value(static_cast<rpn_float>(0.1))));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "$tenth $tenth 1 *"));
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(0.1f) == rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(0.1) == rpn_stack_pop(ctxt).toFloat());
+    TEST_ASSERT_TRUE(static_cast<rpn_float>(0.1) == rpn_variable_get(ctxt, "tenth").toFloat());
+
+    TEST_ASSERT_TRUE(rpn_precision(ctxt, rpn_float_precision::Default));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1 3 /"));
+    TEST_ASSERT_TRUE((1.0 / 3.0) == rpn_stack_pop(ctxt).toFloat());
+}
+
 void test_parse_variable() {
     run_and_error("$ $ $", rpn_processing_error::UnknownToken);
     run_and_error("$", rpn_processing_error::UnknownToken);
@@ -917,6 +2230,270 @@ void test_nested_stack_operator() {
     rpn_value value;
     TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, value));
     TEST_ASSERT_EQUAL_FLOAT(2.0, value.toFloat());
+
+    // only the current stack is visible, until it is closed
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "10 20 [ 1 [ 2 3"));
+    TEST_ASSERT_EQUAL(2, rpn_stack_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_get(ctxt, 1, value));
+    TEST_ASSERT_EQUAL_FLOAT(2.0, value.toFloat());
+    TEST_ASSERT_FALSE(rpn_stack_get(ctxt, 2, value));
+
+    size_t visited { 0 };
+    rpn_stack_foreach(ctxt, [&](rpn_stack_value::Type, const rpn_value&) {
+        ++visited;
+    });
+    TEST_ASSERT_EQUAL(2, visited);
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "drop ]"));
+    TEST_ASSERT_EQUAL(3, rpn_stack_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_get(ctxt, 0, value));
+    TEST_ASSERT_EQUAL(1u, value.toUint());
+    TEST_ASSERT_TRUE(rpn_stack_get(ctxt, 1, value));
+    TEST_ASSERT_EQUAL_FLOAT(2.0, value.toFloat());
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "]"));
+    TEST_ASSERT_EQUAL(6, rpn_stack_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_get(ctxt, 0, value));
+    TEST_ASSERT_EQUAL(3u, value.toUint());
+    TEST_ASSERT_TRUE(rpn_stack_get(ctxt, 5, value));
+    TEST_ASSERT_EQUAL_FLOAT(10.0, value.toFloat());
+}
+
+void test_stack_checkpoint() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+
+    // note that comparison pops everything from the stack
+    auto values = rpn_values<rpn_float, rpn_float, rpn_float>(1.0, 2.0, 3.0);
+
+    // operators re-using their arguments and re-ordering the stack do not change the saved values
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1.0 2.0 3.0"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    auto squared = rpn_values<rpn_float, rpn_float>(1.0, 25.0);
+    run_and_compare_ctx(ctxt, "+ dup *", squared);
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    stack_compare(ctxt, values);
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1.0 2.0 3.0"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "rot swap 4.0"));
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    stack_compare(ctxt, values);
+
+    TEST_ASSERT_EQUAL(0, rpn_stack_checkpoints(ctxt));
+    TEST_ASSERT_FALSE(rpn_stack_rollback(ctxt));
+    TEST_ASSERT_FALSE(rpn_stack_release(ctxt));
+
+    // nested checkpoints, inner one is released and outer one still restores everything
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1.0 2.0 3.0"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "drop 5.0"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "drop drop drop"));
+    TEST_ASSERT_EQUAL(0, rpn_stack_size(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_release(ctxt));
+    TEST_ASSERT_EQUAL(1, rpn_stack_checkpoints(ctxt));
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    stack_compare(ctxt, values);
+
+    // nested stacks closed after the checkpoint are restored too
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "10.0 [ 1.0 2.0"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "] drop drop"));
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    TEST_ASSERT_EQUAL(2, rpn_stack_size(ctxt));
+    auto merged = rpn_values<rpn_float, rpn_float, rpn_float, rpn_uint>(10.0, 1.0, 2.0, 2u);
+    run_and_compare_ctx(ctxt, "]", merged);
+
+    // failed expression does not leave anything on the stack
+    rpn_process_options options;
+    options.rollback = true;
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1.0 2.0 3.0"));
+    TEST_ASSERT_FALSE(rpn_process(ctxt, "&tmp + * unknown", options));
+    TEST_ASSERT_EQUAL(0, rpn_variables_size(ctxt));
+    stack_compare(ctxt, values);
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1.0 2.0 3.0"));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "+ +", options));
+    TEST_ASSERT_EQUAL(0, rpn_stack_checkpoints(ctxt));
+    stack_compare(ctxt, rpn_values<rpn_float>(6.0));
+
+    // series and sketches modified in place get their previous contents back
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "4 series"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_FALSE(rpn_process(ctxt, "5 swap push 1 2 unknownop"));
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    TEST_ASSERT_EQUAL(1, rpn_stack_size(ctxt));
+    TEST_ASSERT_EQUAL_STRING("<rpn_series:0/4>", rpn_stack_get(ctxt, 0).toString().c_str());
+    TEST_ASSERT_TRUE(rpn_stack_clear(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "16 sketch &low = drop 16 sketch &high = drop 1 &low push 2 &high push drop drop"));
+    TEST_ASSERT_FALSE(rpn_process(ctxt, "3 &low push &high 4 swap push merge unknown", options));
+    TEST_ASSERT_EQUAL(0, rpn_stack_size(ctxt));
+    TEST_ASSERT_EQUAL(1, rpn_variable_get(ctxt, "low").toSketch().count());
+    TEST_ASSERT_EQUAL(1, rpn_variable_get(ctxt, "high").toSketch().count());
+
+    // nested checkpoints, the outer one restores the contents saved before the inner one
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "3 &low push drop"));
+    TEST_ASSERT_TRUE(rpn_stack_checkpoint(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "4 &low push drop"));
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    TEST_ASSERT_EQUAL(2, rpn_variable_get(ctxt, "low").toSketch().count());
+    TEST_ASSERT_TRUE(rpn_stack_rollback(ctxt));
+    TEST_ASSERT_EQUAL(1, rpn_variable_get(ctxt, "low").toSketch().count());
+}
+
+void test_stack_view() {
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "1.0 \"a long enough string to be allocated\" true"));
+
+    // view refers to the same values as the stack
+    auto view = rpn_stack_values(ctxt);
+    TEST_ASSERT_EQUAL(3, view.size());
+    TEST_ASSERT_TRUE(view[0].toBoolean());
+    TEST_ASSERT_EQUAL_STRING("a long enough string to be allocated", view[1].toString().c_str());
+    TEST_ASSERT_EQUAL_FLOAT(1.0, view[2].toFloat());
+    TEST_ASSERT_TRUE(&view[1] == &rpn_stack_values(ctxt)[1]);
+
+    size_t index { 0 };
+    for (auto& value : view) {
+        TEST_ASSERT_TRUE(&value == &view[index++]);
+    }
+    TEST_ASSERT_EQUAL(3, index);
+    TEST_ASSERT_EQUAL(3, view.end() - view.begin());
+
+    // bulk pop moves values out, bottom first
+    std::vector<rpn_value> values;
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, values));
+    TEST_ASSERT_EQUAL(0, rpn_stack_size(ctxt));
+    TEST_ASSERT_EQUAL(3, values.size());
+    TEST_ASSERT_EQUAL_FLOAT(1.0, values[0].toFloat());
+    TEST_ASSERT_EQUAL_STRING("a long enough string to be allocated", values[1].toString().c_str());
+    TEST_ASSERT_TRUE(values[2].toBoolean());
+
+    // variable keeps its value, stack value is copied
+    TEST_ASSERT_TRUE(rpn_variable_set(ctxt, "var", rpn_value(5.0)));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "&var"));
+    values.clear();
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, values));
+    TEST_ASSERT_EQUAL(1, values.size());
+
+    rpn_value value;
+    TEST_ASSERT_TRUE(rpn_variable_get(ctxt, "var", value));
+    TEST_ASSERT_EQUAL_FLOAT(5.0, value.toFloat());
+
+    // indexes are no longer limited by the unsigned char
+    for (size_t number = 0; number < 300; ++number) {
+        TEST_ASSERT_TRUE(rpn_stack_push(ctxt, rpn_value(static_cast<rpn_uint>(number))));
+    }
+
+    TEST_ASSERT_TRUE(rpn_stack_get(ctxt, 299, value));
+    TEST_ASSERT_EQUAL(0u, value.toUint());
+    TEST_ASSERT_EQUAL(299u, rpn_stack_get(ctxt, 0).toUint());
+    TEST_ASSERT_FALSE(rpn_stack_get(ctxt, 300, value));
+    TEST_ASSERT_EQUAL(0u, rpn_stack_values(ctxt)[299].toUint());
+
+    TEST_ASSERT_TRUE(rpn_clear(ctxt));
+}
+
+void test_string_storage() {
+    using Storage = rpn_value::StringStorage;
+
+    // values own their strings, unless they come from the pool
+    const String long_string(
+        "a string that is long enough to need an allocation, "
+        "no matter how large the String object is");
+
+    rpn_value short_value("idle");
+    rpn_value long_value(long_string);
+    TEST_ASSERT(short_value.stringStorage() == Storage::Heap);
+    TEST_ASSERT(long_value.stringStorage() == Storage::Heap);
+    TEST_ASSERT_EQUAL_STRING("idle", short_value.toString().c_str());
+    TEST_ASSERT_TRUE(long_string == long_value.toString());
+
+    rpn_value copy(short_value);
+    rpn_value moved(std::move(copy));
+    TEST_ASSERT_TRUE(moved == short_value);
+    TEST_ASSERT_TRUE(copy.isNull());
+
+    copy = long_value;
+    TEST_ASSERT_TRUE(copy == long_value);
+    copy = short_value;
+    TEST_ASSERT_TRUE(copy == short_value);
+    TEST_ASSERT_FALSE(copy == long_value);
+    TEST_ASSERT_FALSE(rpn_value("").toBoolean());
+
+    auto concat = short_value + rpn_value("-on");
+    TEST_ASSERT_EQUAL_STRING("idle-on", concat.toString().c_str());
+
+    concat = concat + long_value;
+    TEST_ASSERT_TRUE((String("idle-on") + long_string) == concat.toString());
+
+    // length is kept as-is, strings with NUL in the middle are not truncated
+    String nul_string;
+    nul_string.concat("a\0b", 3);
+
+    rpn_value nul_value(nul_string);
+    TEST_ASSERT_EQUAL(3, nul_value.toString().length());
+
+    rpn_value nul_copy(nul_value);
+    TEST_ASSERT_EQUAL(3, nul_copy.toString().length());
+    TEST_ASSERT_TRUE(nul_copy == nul_value);
+    TEST_ASSERT_FALSE(nul_copy == rpn_value("a"));
+
+    auto nul_concat = nul_value + nul_value;
+    const auto nul_result = nul_concat.toString();
+    TEST_ASSERT_EQUAL(6, nul_result.length());
+    TEST_ASSERT_EQUAL(0, std::memcmp("a\0ba\0b", nul_result.c_str(), 6));
+
+    // with the pool enabled, every literal with the same contents refers to the same entry
+    rpn_context ctxt;
+    TEST_ASSERT_TRUE(rpn_init(ctxt));
+    TEST_ASSERT_TRUE(rpn_strings_intern(ctxt, true));
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "\"idle\" \"idle\" eq \"off\" \"idle\" eq"));
+    TEST_ASSERT_EQUAL(2, rpn_strings_size(ctxt));
+
+    rpn_value value;
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, value));
+    TEST_ASSERT_FALSE(value.toBoolean());
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, value));
+    TEST_ASSERT_TRUE(value.toBoolean());
+
+    TEST_ASSERT_TRUE(rpn_word_set(ctxt, "state", "\"idle\""));
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "state"));
+    TEST_ASSERT_EQUAL(2, rpn_strings_size(ctxt));
+
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, value));
+    TEST_ASSERT(value.stringStorage() == Storage::Interned);
+    TEST_ASSERT_TRUE(value == short_value);
+
+    // values keep their strings after the pool is cleared, new literals are compared by contents
+    TEST_ASSERT_TRUE(rpn_strings_clear(ctxt));
+    TEST_ASSERT_EQUAL(0, rpn_strings_size(ctxt));
+    TEST_ASSERT_EQUAL_STRING("idle", value.toString().c_str());
+
+    TEST_ASSERT_TRUE(rpn_process(ctxt, "\"idle\""));
+    TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, copy));
+    TEST_ASSERT(copy.stringStorage() == Storage::Interned);
+    TEST_ASSERT_TRUE(copy == value);
+
+    // literals with NUL in the middle keep their length, with or without the pool
+    for (bool intern : {false, true}) {
+        TEST_ASSERT_TRUE(rpn_strings_intern(ctxt, intern));
+        TEST_ASSERT_TRUE(rpn_process(ctxt, "\"a\\x00b\""));
+        TEST_ASSERT_TRUE(rpn_stack_pop(ctxt, value));
+        TEST_ASSERT(value.stringStorage() == (intern ? Storage::Interned : Storage::Heap));
+
+        const auto result = value.toString();
+        TEST_ASSERT_EQUAL(3, result.length());
+        TEST_ASSERT_EQUAL(0, std::memcmp("a\0b", result.c_str(), 3));
+    }
+
+    TEST_ASSERT_TRUE(rpn_clear(ctxt));
 }
 
 void test_memory() {
@@ -985,20 +2562,42 @@ int run_tests() {
     RUN_TEST(test_math_int);
     RUN_TEST(test_math_uint);
     RUN_TEST(test_trig);
+    RUN_TEST(test_fmath_fast);
     RUN_TEST(test_cast);
     RUN_TEST(test_cmp);
     RUN_TEST(test_index);
+    RUN_TEST(test_array_aggregates);
+    RUN_TEST(test_array_selection);
+    RUN_TEST(test_series);
+    RUN_TEST(test_sketch);
     RUN_TEST(test_nth);
     RUN_TEST(test_map);
     RUN_TEST(test_constrain);
     RUN_TEST(test_conditionals);
+    RUN_TEST(test_conditional_blocks);
     RUN_TEST(test_stack);
     RUN_TEST(test_logic);
     RUN_TEST(test_boolean);
     RUN_TEST(test_variable);
     RUN_TEST(test_variable_operator);
     RUN_TEST(test_variable_cleanup);
+    RUN_TEST(test_stream_operators);
+    RUN_TEST(test_filters);
+    RUN_TEST(test_tables);
+    RUN_TEST(test_polynomials);
+    RUN_TEST(test_batch);
+    RUN_TEST(test_simd);
+    RUN_TEST(test_parent);
+    RUN_TEST(test_process_const);
+    RUN_TEST(test_variable_store);
+    RUN_TEST(test_value_ptr);
+#if RPNLIB_ENGINE
+    RUN_TEST(test_engine);
+#endif
     RUN_TEST(test_custom_operator);
+    RUN_TEST(test_custom_operator_args);
+    RUN_TEST(test_pure_operator);
+    RUN_TEST(test_words);
     RUN_TEST(test_error_divide_by_zero);
     RUN_TEST(test_error_argument_count_mismatch);
     RUN_TEST(test_error_unknown_token);
@@ -1010,10 +2609,15 @@ int run_tests() {
     RUN_TEST(test_parse_null);
     RUN_TEST(test_parse_number);
     RUN_TEST(test_parse_integer);
+    RUN_TEST(test_fixed_point);
+    RUN_TEST(test_single_precision);
     RUN_TEST(test_parse_variable);
     RUN_TEST(test_parse_multiline);
     RUN_TEST(test_nested_stack_parse);
     RUN_TEST(test_nested_stack_operator);
+    RUN_TEST(test_stack_checkpoint);
+    RUN_TEST(test_stack_view);
+    RUN_TEST(test_string_storage);
     RUN_TEST(test_overflow);
     return UNITY_END();
 }